@@ -0,0 +1,213 @@
+#include "batch.h"
+#include "dual_contour.h"
+#include "implicit.h"
+#include "mesh_io.h"
+#include "mesh_sdf.h"
+#include "parallel.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <tuple>
+#include <utility>
+
+bool parseInteger(const std::string& text, int minValue, int& value, int maxValue) {
+    int parsed = 0;
+    const char* end = text.data() + text.size();
+    const std::from_chars_result r = std::from_chars(text.data(), end, parsed);
+    if (r.ec != std::errc() || r.ptr != end || parsed < minValue || parsed > maxValue) return false;
+    value = parsed;
+    return true;
+}
+
+bool parseBatchJob(const std::vector<std::string>& args, BatchJob& job, std::string& error) {
+    job = BatchJob();
+    auto number = [&](size_t& i, const char* option, auto& value) {
+        if (i + 1 >= args.size()) {
+            error = std::string(option) + " needs a value";
+            return false;
+        }
+        std::istringstream in(args[++i]);
+        if (!(in >> value) || !in.eof()) {
+            error = std::string("bad value for ") + option + ": " + args[i];
+            return false;
+        }
+        return true;
+    };
+    auto integer = [&](size_t& i, const char* option, int minValue, int& value,
+                       int maxValue = std::numeric_limits<int>::max()) {
+        if (i + 1 >= args.size()) {
+            error = std::string(option) + " needs a value";
+            return false;
+        }
+        if (!parseInteger(args[++i], minValue, value, maxValue)) {
+            error = std::string("bad value for ") + option + ": " + args[i] + " (a whole number " +
+                    (maxValue == std::numeric_limits<int>::max()
+                         ? ">= " + std::to_string(minValue)
+                         : "from " + std::to_string(minValue) + " to " + std::to_string(maxValue)) +
+                    ")";
+            return false;
+        }
+        return true;
+    };
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        if (arg == "-o") {
+            if (i + 1 >= args.size()) {
+                error = "-o needs a path";
+                return false;
+            }
+            job.output = args[++i];
+        } else if (arg == "-n") {
+            // Larger grids overflow the int corner indices
+            if (!integer(i, "-n", 1, job.N, MAX_GRID_N)) return false;
+        } else if (arg == "--bounds") {
+            if (!number(i, "--bounds", job.minBound) || !number(i, "--bounds", job.maxBound)) return false;
+        } else if (arg == "--threads") {
+            if (!integer(i, "--threads", 0, job.threads)) return false;
+        } else if (arg == "--winding") {
+            job.windingSign = true;
+        } else if (arg == "--cache-dir") {
+            if (i + 1 >= args.size()) {
+                error = "--cache-dir needs a path";
+                return false;
+            }
+            job.cacheDir = args[++i];
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            error = "unknown option " + arg;
+            return false;
+        } else if (job.shape.empty()) {
+            job.shape = arg;
+        } else {
+            error = "more than one shape: " + job.shape + ", " + arg;
+            return false;
+        }
+    }
+
+    if (job.shape.empty()) error = "no shape given";
+    else if (job.output.empty()) error = "no output given (-o)";
+    else if (!isMeshPath(job.output)) error = "output must be .ply, .stl or .obj: " + job.output;
+    else if (!(job.minBound < job.maxBound)) error = "--bounds needs MIN < MAX";
+    else return true;
+    return false;
+}
+
+bool loadBatchManifest(const std::string& path, std::vector<BatchJob>& jobs, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    jobs.clear();
+    std::string line;
+    for (int lineNumber = 1; std::getline(in, line); ++lineNumber) {
+        std::istringstream tokens(line.substr(0, line.find('#')));
+        std::vector<std::string> args;
+        for (std::string token; tokens >> token;) args.push_back(token);
+        if (args.empty()) continue;
+
+        BatchJob job;
+        std::string lineError;
+        if (!parseBatchJob(args, job, lineError)) {
+            error = path + ":" + std::to_string(lineNumber) + ": " + lineError;
+            return false;
+        }
+        jobs.push_back(job);
+    }
+    return true;
+}
+
+// OBJs shared by the jobs of one run, one cache per cache directory (and
+// thread-safe, as jobs run concurrently)
+static std::mutex g_batchMeshesMutex;
+static std::map<std::string, MeshSDFCache> g_batchMeshes;
+
+static MeshSDFCache& batchMeshes(const std::string& cacheDir) {
+    std::lock_guard<std::mutex> lock(g_batchMeshesMutex);
+    return g_batchMeshes.emplace(std::piecewise_construct, std::forward_as_tuple(cacheDir),
+                                 std::forward_as_tuple(4, cacheDir)).first->second;
+}
+
+BatchResult runBatchJob(const BatchJob& job) {
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point t0) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    };
+    BatchResult result;
+
+    auto t0 = Clock::now();
+    ImplicitField f;
+    if (job.shape == "sphere") {
+        f = ImplicitField(implicitSphere, implicitSphereBatch, implicitSphereGrad);
+    } else if (job.shape == "box") {
+        f = ImplicitField(implicitBox, implicitBoxBatch, implicitBoxGrad);
+    } else if (job.shape == "torus") {
+        f = ImplicitField(implicitTorus, implicitTorusBatch, implicitTorusGrad);
+    } else {
+        const MeshSign sign = job.windingSign ? MeshSign::WindingNumber : MeshSign::Pseudonormal;
+        std::shared_ptr<const MeshSDF> mesh = batchMeshes(job.cacheDir).get(job.shape, sign);
+        if (!mesh) {
+            result.error = "cannot load " + job.shape;
+            return result;
+        }
+        f = meshSDFField(mesh, job.threads);
+    }
+    result.loadMs = ms(t0);
+
+    t0 = Clock::now();
+    DCGrid grid = buildGrid(f, job.N, job.minBound, job.maxBound, job.threads);
+    result.sampleMs = ms(t0);
+    result.samples = static_cast<long long>(grid.values.size());
+
+    t0 = Clock::now();
+    const DCMesh mesh = dualContour(f, grid, job.threads);
+    result.contourMs = ms(t0);
+    result.vertices = mesh.vertices.size();
+    result.triangles = mesh.triangles.size();
+
+    t0 = Clock::now();
+    if (!writeMesh(job.output, mesh)) {
+        result.error = "cannot write " + job.output;
+        return result;
+    }
+    result.writeMs = ms(t0);
+    struct stat info;
+    if (stat(job.output.c_str(), &info) == 0) result.bytes = static_cast<size_t>(info.st_size);
+
+    result.ok = true;
+    return result;
+}
+
+std::vector<BatchResult> runBatchJobs(const std::vector<BatchJob>& jobs, int concurrency,
+                                      const std::function<void(size_t, const BatchResult&)>& done) {
+    std::vector<BatchResult> results(jobs.size());
+    if (jobs.empty()) return results;
+    const int running = std::max(1, std::min(concurrency, static_cast<int>(jobs.size())));
+    const int share = std::max(1, resolveThreadCount(0) / running);
+
+    std::mutex doneMutex;
+    parallelFor(0, static_cast<int>(jobs.size()), running, [&](int i) {
+        BatchJob job = jobs[i];
+        if (job.threads <= 0) job.threads = share;
+        try {
+            results[i] = runBatchJob(job);
+        } catch (const std::exception& e) {
+            results[i] = BatchResult();
+            results[i].error = e.what();
+        } catch (...) {
+            results[i] = BatchResult();
+            results[i].error = "unknown exception";
+        }
+        if (done) {
+            std::lock_guard<std::mutex> lock(doneMutex);
+            done(i, results[i]);
+        }
+    });
+    return results;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "mapped_file.h"
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+// One meshing job of the headless batch tool: sample, contour, write.
+struct BatchJob {
+    std::string shape;          // sphere, box, torus, or the path of an OBJ
+    std::string output;         // .ply, .stl or .obj
+    int N = 64;
+    float minBound = -1.f, maxBound = 1.f;
+    int threads = 0;            // <= 0: all cores, or an even share in runBatchJobs
+    bool windingSign = false;   // OBJ inside/outside by winding number
+    std::string cacheDir = userCacheDirectory();  // .meshbin cache of an OBJ; empty: none
+};
+
+// What a job did, phase by phase.
+struct BatchResult {
+    bool ok = false;
+    std::string error;
+    double loadMs = 0, sampleMs = 0, contourMs = 0, writeMs = 0;
+    long long samples = 0;      // grid corners
+    size_t vertices = 0, triangles = 0;
+    size_t bytes = 0;           // size of the written file
+};
+
+// A whole-string decimal integer in [minValue, maxValue]. Returns false,
+// leaving value alone, for anything else ("", "8x", "1e3", out of range).
+bool parseInteger(const std::string& text, int minValue, int& value,
+                  int maxValue = std::numeric_limits<int>::max());
+
+// Command-line arguments of one job, also the syntax of a manifest line:
+//   <sphere|box|torus|mesh.obj> -o <out.ply|out.stl|out.obj>
+//       [-n N] [--bounds MIN MAX] [--threads T] [--winding] [--cache-dir DIR]
+// N runs from 1 to MAX_GRID_N. DIR defaults to userCacheDirectory().
+// Returns false with error set if they do not describe a job.
+bool parseBatchJob(const std::vector<std::string>& args, BatchJob& job, std::string& error);
+
+// One job per line; blank lines and text after '#' are ignored. Returns
+// false with error naming the line if the file cannot be read or a line
+// does not parse.
+bool loadBatchManifest(const std::string& path, std::vector<BatchJob>& jobs, std::string& error);
+
+// Run one job on job.threads threads (<= 0: all cores).
+BatchResult runBatchJob(const BatchJob& job);
+
+// Run jobs with up to concurrency of them at once; jobs without a thread
+// count split the cores evenly between the concurrent jobs. done(i, result)
+// is called as each job finishes, one call at a time. Results are in job
+// order. A job that throws fails on its own, with the exception's message as
+// its error; the other jobs still run.
+std::vector<BatchResult> runBatchJobs(const std::vector<BatchJob>& jobs, int concurrency,
+                                      const std::function<void(size_t, const BatchResult&)>& done = nullptr);
@@ -0,0 +1,101 @@
+// dc_batch: headless meshing, one job from the command line or many from a
+// manifest. No window, no Polyscope.
+#include "batch.h"
+#include "dual_contour.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static void printUsage() {
+    const std::string cacheDir = userCacheDirectory();
+    std::cerr <<
+        "Usage:\n"
+        "  dc_batch <sphere|box|torus|mesh.obj> -o <out.ply|out.stl|out.obj>\n"
+        "           [-n N] [--bounds MIN MAX] [--threads T] [--winding] [--cache-dir DIR]\n"
+        "  dc_batch --manifest <jobs.txt> [--jobs J]\n"
+        "\n"
+        "N defaults to 64 and runs from 1 to " << MAX_GRID_N << ".\n"
+        "Loaded OBJs are cached in DIR, default " << (cacheDir.empty() ? "none" : cacheDir) << ".\n"
+        "A manifest holds one job per line, in the first form without 'dc_batch';\n"
+        "'#' starts a comment. Up to J jobs (default 1) run at once.\n";
+}
+
+// Per-phase timings and throughput of one finished job
+static void printResult(const BatchJob& job, const BatchResult& r, size_t index, size_t count) {
+    std::printf("[%zu/%zu] %s N=%d -> %s\n", index + 1, count, job.shape.c_str(), job.N, job.output.c_str());
+    if (!r.ok) {
+        std::printf("  FAILED: %s\n", r.error.c_str());
+        return;
+    }
+    auto perSecond = [](double n, double ms) { return ms > 0.0 ? n / ms * 1e-3 : 0.0; };  // millions/s
+    std::printf("  load %.1f ms | sample %.1f ms (%.2f M samples/s) | contour %.1f ms (%.2f M vertices/s)"
+                " | write %.1f ms (%.1f MB, %.0f MB/s)\n",
+                r.loadMs, r.sampleMs, perSecond(double(r.samples), r.sampleMs),
+                r.contourMs, perSecond(double(r.vertices), r.contourMs),
+                r.writeMs, r.bytes / 1e6, perSecond(double(r.bytes), r.writeMs));
+    std::printf("  %zu vertices, %zu triangles\n", r.vertices, r.triangles);
+    std::fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (args.empty() || args[0] == "-h" || args[0] == "--help") {
+        printUsage();
+        return args.empty() ? 1 : 0;
+    }
+
+    std::vector<BatchJob> jobs;
+    int concurrency = 1;
+    std::string error;
+    if (args[0] == "--manifest") {
+        if (args.size() < 2) {
+            printUsage();
+            return 1;
+        }
+        for (size_t i = 2; i < args.size(); ++i) {
+            if (args[i] == "--jobs" && i + 1 < args.size()) {
+                if (!parseInteger(args[++i], 1, concurrency)) {
+                    std::cerr << "Error: bad value for --jobs: " << args[i] << " (a whole number >= 1)\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: unknown argument " << args[i] << "\n";
+                printUsage();
+                return 1;
+            }
+        }
+        if (!loadBatchManifest(args[1], jobs, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+    } else {
+        BatchJob job;
+        if (!parseBatchJob(args, job, error)) {
+            std::cerr << "Error: " << error << "\n";
+            printUsage();
+            return 1;
+        }
+        jobs.push_back(job);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const auto t0 = Clock::now();
+    size_t finished = 0;
+    const std::vector<BatchResult> results = runBatchJobs(jobs, concurrency,
+        [&](size_t i, const BatchResult& r) { printResult(jobs[i], r, finished++, jobs.size()); });
+    const double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    size_t failed = 0;
+    long long samples = 0;
+    for (const BatchResult& r : results) {
+        failed += !r.ok;
+        samples += r.samples;
+    }
+    if (jobs.size() > 1) {
+        std::printf("%zu jobs, %zu failed, %.2f s wall, %.2f M samples/s overall\n",
+                    jobs.size(), failed, seconds, seconds > 0.0 ? samples / seconds * 1e-6 : 0.0);
+    }
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,156 @@
+#include "build_worker.h"
+#include <algorithm>
+
+void BuildProgress::beginStage(long long evaluations) {
+    checkpoint();
+    expected = std::max(evaluations, 1LL);
+    done = 0;
+    ++stages;
+}
+
+void BuildProgress::advance(long long n) {
+    // Relaxed: the count only feeds the progress bar
+    done.fetch_add(n, std::memory_order_relaxed);
+    checkpoint();
+}
+
+void BuildProgress::checkpoint() const {
+    if (cancelled.load(std::memory_order_relaxed)) throw BuildCancelled();
+}
+
+float BuildProgress::fraction() const {
+    const long long total = expected;
+    if (total <= 0) return 0.0f;
+    return std::min(float(double(done) / double(total)), 1.0f);
+}
+
+void BuildProgress::fail(const std::string& what) {
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        message = what;
+    }
+    hasFailed = true;
+}
+
+std::string BuildProgress::error() const {
+    std::lock_guard<std::mutex> lock(errorMutex);
+    return message;
+}
+
+// Scalar evaluations a thread counts locally before adding them to progress,
+// so threads sampling in parallel don't all bump one shared cache line per call
+static const long long COUNT_FLUSH = 4096;
+
+static void countEvaluation(BuildProgress* p) {
+    thread_local const BuildProgress* owner = nullptr;
+    thread_local long long pending = 0;
+    if (owner != p) {
+        // A tally left over from another build's progress is dropped: that
+        // progress may be gone
+        owner = p;
+        pending = 0;
+    }
+    if (++pending == COUNT_FLUSH) {
+        pending = 0;
+        p->advance(COUNT_FLUSH);
+    } else {
+        p->checkpoint();
+    }
+}
+
+ImplicitField monitoredField(const ImplicitField& f, BuildProgress& progress) {
+    auto field = std::make_shared<const ImplicitField>(f);
+    BuildProgress* p = &progress;
+    ImplicitField monitored;
+    monitored.eval = [field, p](float x, float y, float z) {
+        countEvaluation(p);
+        return field->eval(x, y, z);
+    };
+    // Always a batch kernel, so sampling is counted once per row even for a
+    // field without one
+    monitored.evalBatch = [field, p](const float* x, const float* y, const float* z, float* out, int n) {
+        p->advance(n);
+        field->evaluate(x, y, z, out, n);
+    };
+    if (f.evalGrad) {
+        monitored.evalGrad = [field, p](float x, float y, float z, Eigen::Vector3f& grad) {
+            countEvaluation(p);
+            return field->evalGrad(x, y, z, grad);
+        };
+    }
+    return monitored;
+}
+
+BuildWorker::BuildWorker() : thread([this] { run(); }) {}
+
+BuildWorker::~BuildWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        if (runningProgress) runningProgress->cancel();
+        if (queuedProgress) queuedProgress->cancel();
+    }
+    wake.notify_all();
+    thread.join();
+}
+
+std::shared_ptr<const BuildProgress> BuildWorker::submit(Job job) {
+    auto progress = std::make_shared<BuildProgress>();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (runningProgress) runningProgress->cancel();
+        if (queuedProgress) queuedProgress->cancel();
+        queued = std::move(job);
+        queuedProgress = progress;
+    }
+    wake.notify_all();
+    return progress;
+}
+
+void BuildWorker::cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (runningProgress) runningProgress->cancel();
+    if (queuedProgress) queuedProgress->cancel();
+    queued = nullptr;
+    queuedProgress.reset();
+    finished.notify_all();
+}
+
+void BuildWorker::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return !queued && !runningProgress; });
+}
+
+bool BuildWorker::idle() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !queued && !runningProgress;
+}
+
+void BuildWorker::run() {
+    for (;;) {
+        Job job;
+        std::shared_ptr<BuildProgress> progress;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || queued; });
+            if (stopping) return;
+            job = std::move(queued);
+            queued = nullptr;
+            progress = std::move(queuedProgress);
+            runningProgress = progress;
+        }
+        try {
+            job(*progress);
+        } catch (const BuildCancelled&) {
+        } catch (const std::exception& e) {
+            progress->fail(e.what());
+        } catch (...) {
+            progress->fail("unknown error");
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            runningProgress.reset();
+        }
+        finished.notify_all();
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include "implicit.h"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Thrown out of a build whose BuildProgress was cancelled.
+struct BuildCancelled : std::exception {
+    const char* what() const noexcept override { return "build cancelled"; }
+};
+
+// Progress of a build on another thread, its cancellation flag, and why it
+// failed, if it did. A build is one or more stages (e.g. a preview, then the
+// full resolution), each measured in field evaluations; the count is an
+// estimate, so fraction() is clamped to 1.
+class BuildProgress {
+public:
+    // Start the next stage, expected to take about `evaluations` evaluations.
+    void beginStage(long long evaluations);
+    // Count n evaluations; throws BuildCancelled once cancel() was called.
+    void advance(long long n);
+    // Throws BuildCancelled once cancel() was called.
+    void checkpoint() const;
+
+    void cancel() { cancelled = true; }
+    bool isCancelled() const { return cancelled; }
+    // Stages begun so far.
+    int stage() const { return stages; }
+    // Share of the current stage done, in [0, 1].
+    float fraction() const;
+
+    // Record that the build stopped on an error other than cancellation.
+    void fail(const std::string& message);
+    bool failed() const { return hasFailed; }
+    // The message passed to fail(), or empty.
+    std::string error() const;
+
+private:
+    std::atomic<bool> cancelled{false}, hasFailed{false};
+    mutable std::mutex errorMutex;
+    std::string message;
+    std::atomic<int> stages{0};
+    std::atomic<long long> done{0}, expected{0};
+};
+
+// f with every evaluation (scalar, batch or gradient) counted in progress,
+// and throwing BuildCancelled once it is cancelled, so any build over the
+// field stops within one batch or sample of the request. The returned field
+// always has a batch kernel (f's, or a loop over f.eval), counted once per
+// batch; scalar and gradient calls are tallied per thread and added a few
+// thousand at a time, so up to that many per thread may go uncounted.
+// Values and gradients are f's. progress must outlive the returned field.
+ImplicitField monitoredField(const ImplicitField& f, BuildProgress& progress);
+
+// A background thread running one build job at a time. Submitting a job
+// cancels the one in flight and replaces any job still waiting, so rapid
+// requests (a dragged slider) never queue up: only the newest one runs to
+// completion. Jobs stop by throwing BuildCancelled (monitoredField does),
+// and publish their results themselves. Any other exception (a failed
+// allocation at a large N, an error rethrown by parallelFor) ends only that
+// job: it is recorded in the job's BuildProgress, and the worker goes on
+// with the next one.
+class BuildWorker {
+public:
+    using Job = std::function<void(BuildProgress&)>;
+
+    BuildWorker();
+    // Cancels the running job and waits for it.
+    ~BuildWorker();
+    BuildWorker(const BuildWorker&) = delete;
+    BuildWorker& operator=(const BuildWorker&) = delete;
+
+    // Queue job, cancelling the previous one. Returns the job's progress.
+    std::shared_ptr<const BuildProgress> submit(Job job);
+    // Cancel the running job and drop a waiting one.
+    void cancel();
+    // Block until no job is running or waiting.
+    void wait();
+    bool idle() const;
+
+private:
+    void run();
+
+    mutable std::mutex mutex;
+    std::condition_variable wake, finished;
+    Job queued;
+    std::shared_ptr<BuildProgress> queuedProgress, runningProgress;
+    bool stopping = false;
+    std::thread thread;  // last, so it starts after the members it uses
+};
@@ -0,0 +1,225 @@
+#include "chunked.h"
+#include "qef.h"
+#include "parallel.h"
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <numeric>
+
+// Work granularity for the merge (vertices / triangles per task)
+static const size_t ITEMS_PER_TASK = 4096;
+
+ChunkLayout cubicChunkLayout(int N, float minBound, float maxBound, int chunkSize) {
+    ChunkLayout layout;
+    layout.origin = Eigen::Vector3f::Constant(minBound);
+    layout.cellSize = (maxBound - minBound) / N;
+    layout.cells[0] = layout.cells[1] = layout.cells[2] = N;
+    layout.chunkSize = chunkSize;
+    return layout;
+}
+
+DCChunk meshChunk(const ImplicitField& f, const ChunkLayout& layout, int ci, int cj, int ck) {
+    DCChunk chunk;
+    const int chunkIdx[3] = {ci, cj, ck};
+    const float cellSize = layout.cellSize;
+
+    // Owned cells [own0, own1) and sampled corners [lo, hi] per axis; the
+    // apron is the one cell below own0.
+    int own0[3], own1[3], lo[3], n[3];
+    for (int a = 0; a < 3; ++a) {
+        own0[a] = chunkIdx[a] * layout.chunkSize;
+        own1[a] = std::min(own0[a] + layout.chunkSize, layout.cells[a]);
+        lo[a] = std::max(own0[a] - 1, 0);
+        n[a] = own1[a] - lo[a] + 1;  // corners
+    }
+    auto cornerIdx = [&](int i, int j, int k) {
+        return (i - lo[0]) + n[0] * ((j - lo[1]) + n[1] * (k - lo[2]));
+    };
+    auto cellIdx = [&](int i, int j, int k) {
+        return (i - lo[0]) + (n[0] - 1) * ((j - lo[1]) + (n[1] - 1) * (k - lo[2]));
+    };
+
+    // Sample the corners, one row per batch
+    std::vector<float> values(size_t(n[0]) * n[1] * n[2]);
+    std::vector<float> xs(n[0]), ys(n[0]), zs(n[0]);
+    for (int i = 0; i < n[0]; ++i) xs[i] = layout.origin.x() + (lo[0] + i) * cellSize;
+    for (int k = lo[2]; k < lo[2] + n[2]; ++k) {
+        std::fill(zs.begin(), zs.end(), layout.origin.z() + k * cellSize);
+        for (int j = lo[1]; j < lo[1] + n[1]; ++j) {
+            std::fill(ys.begin(), ys.end(), layout.origin.y() + j * cellSize);
+            f.evaluate(xs.data(), ys.data(), zs.data(), &values[cornerIdx(lo[0], j, k)], n[0]);
+        }
+    }
+
+    // Hermite data of the sign-changing edges inside the sampled box, in scan
+    // order, found through their row of corners as in DCEdges
+    std::vector<HermiteEdge> edges[3];
+    std::vector<int> rowStart[3];
+    const int step[3] = {1, n[0], n[0] * n[1]};
+    auto rowIdx = [&](int j, int k) {
+        return (j - lo[1]) + n[1] * (k - lo[2]);
+    };
+    for (int axis = 0; axis < 3; ++axis) {
+        rowStart[axis].assign(size_t(n[1]) * n[2] + 1, 0);
+        int end[3] = {lo[0] + n[0], lo[1] + n[1], lo[2] + n[2]};
+        end[axis] -= 1;
+        for (int k = lo[2]; k < end[2]; ++k)
+            for (int j = lo[1]; j < end[1]; ++j)
+                for (int i = lo[0]; i < end[0]; ++i) {
+                    const int idx = cornerIdx(i, j, k);
+                    const float f0 = values[idx];
+                    const float f1 = values[idx + step[axis]];
+                    if ((f0 < 0) == (f1 < 0)) continue;
+
+                    // Same arithmetic as buildHermiteEdges
+                    Eigen::Vector3f p0(layout.origin.x() + i * cellSize,
+                                       layout.origin.y() + j * cellSize,
+                                       layout.origin.z() + k * cellSize);
+                    Eigen::Vector3f p1 = p0;
+                    p1[axis] = layout.origin[axis] + ((axis == 0 ? i : axis == 1 ? j : k) + 1) * cellSize;
+                    ++rowStart[axis][rowIdx(j, k) + 1];
+                    edges[axis].push_back({i, j, k, f1 > f0, edgeHermite(f, p0, p1, f0, f1)});
+                }
+        for (size_t r = 0; r + 1 < rowStart[axis].size(); ++r) rowStart[axis][r + 1] += rowStart[axis][r];
+    }
+    auto findEdge = [&](int axis, int i, int j, int k) -> const HermiteEdge* {
+        const int row = rowIdx(j, k);
+        const HermiteEdge* first = edges[axis].data() + rowStart[axis][row];
+        const HermiteEdge* last = edges[axis].data() + rowStart[axis][row + 1];
+        const HermiteEdge* e = std::lower_bound(first, last, i,
+            [](const HermiteEdge& edge, int value) { return edge.i < value; });
+        return e != last && e->i == i ? e : nullptr;
+    };
+
+    // One vertex per active cell, apron included
+    std::vector<int> cellVertex(size_t(n[0] - 1) * (n[1] - 1) * (n[2] - 1), -1);
+    std::vector<std::array<float,3>> positions;
+    for (int k = lo[2]; k < own1[2]; ++k)
+        for (int j = lo[1]; j < own1[1]; ++j)
+            for (int i = lo[0]; i < own1[0]; ++i) {
+                QEF qef;
+                for (int e = 0; e < 12; ++e) {
+                    const int axis = e / 4;
+                    const int c0 = EDGE_CORNERS[e][0];
+                    const HermiteEdge* edge = findEdge(axis, i + (c0 & 1), j + ((c0 >> 1) & 1),
+                                                       k + ((c0 >> 2) & 1));
+                    if (edge) qef.add(edge->hermite);
+                }
+                if (qef.count == 0) continue;
+
+                Eigen::Vector3f cellMin(layout.origin.x() + i * cellSize,
+                                        layout.origin.y() + j * cellSize,
+                                        layout.origin.z() + k * cellSize);
+                Eigen::Vector3f cellMax(layout.origin.x() + (i+1) * cellSize,
+                                        layout.origin.y() + (j+1) * cellSize,
+                                        layout.origin.z() + (k+1) * cellSize);
+                Eigen::Vector3f vertex = qef.solve(cellMin, cellMax);
+                cellVertex[cellIdx(i, j, k)] = static_cast<int>(positions.size());
+                positions.push_back({vertex.x(), vertex.y(), vertex.z()});
+
+                if (i >= own0[0] && j >= own0[1] && k >= own0[2]) {
+                    chunk.vertexCells.push_back(layout.cellKey(i, j, k));
+                    chunk.vertices.push_back(positions.back());
+                }
+            }
+
+    // Quads of the owned edges, with the same degenerate-triangle test as
+    // removeDegenerateTriangles
+    const int64_t numCorners = int64_t(layout.cells[0] + 1) * (layout.cells[1] + 1) * (layout.cells[2] + 1);
+    std::vector<std::array<int,3>> quad;
+    for (int axis = 0; axis < 3; ++axis) {
+        for (const HermiteEdge& edge : edges[axis]) {
+            if (edge.i < own0[0] || edge.j < own0[1] || edge.k < own0[2]) continue;
+            int v[4];
+            int64_t keys[4];
+            bool complete = true;
+            for (int q = 0; q < 4 && complete; ++q) {
+                const int i = edge.i + QUAD_CELLS[axis][q][0];
+                const int j = edge.j + QUAD_CELLS[axis][q][1];
+                const int k = edge.k + QUAD_CELLS[axis][q][2];
+                if (i < 0 || j < 0 || k < 0 || i >= own1[0] || j >= own1[1] || k >= own1[2]) {
+                    complete = false;
+                    break;
+                }
+                v[q] = cellVertex[cellIdx(i, j, k)];
+                keys[q] = layout.cellKey(i, j, k);
+                complete = v[q] >= 0;
+            }
+            if (!complete) continue;
+
+            int local[4] = {0, 1, 2, 3};
+            quad.clear();
+            appendQuad(local, axis, edge.rising, quad);
+            const int64_t edgeKey = layout.cornerKey(edge.i, edge.j, edge.k);
+            for (int half = 0; half < 2; ++half) {
+                const auto& tri = quad[half];
+                const Eigen::Vector3f p0(positions[v[tri[0]]].data());
+                const Eigen::Vector3f p1(positions[v[tri[1]]].data());
+                const Eigen::Vector3f p2(positions[v[tri[2]]].data());
+                Eigen::Vector3f normal = (p1 - p0).cross(p2 - p0);
+                if (normal.squaredNorm() < 1e-12f) continue;
+                chunk.triangles.push_back({keys[tri[0]], keys[tri[1]], keys[tri[2]]});
+                chunk.triangleOrder.push_back((axis * numCorners + edgeKey) * 2 + half);
+            }
+        }
+    }
+    return chunk;
+}
+
+DCMesh mergeChunks(const std::vector<DCChunk>& chunks, int numThreads) {
+    DCMesh mesh;
+
+    // Vertex ids in global cell order. Chunks hold disjoint cells, so sorting
+    // the concatenated keys merges them.
+    std::vector<int64_t> keys;
+    std::vector<std::array<float,3>> positions;
+    for (const DCChunk& chunk : chunks) {
+        keys.insert(keys.end(), chunk.vertexCells.begin(), chunk.vertexCells.end());
+        positions.insert(positions.end(), chunk.vertices.begin(), chunk.vertices.end());
+    }
+    std::vector<size_t> perm(keys.size());
+    std::iota(perm.begin(), perm.end(), 0);
+    std::sort(perm.begin(), perm.end(), [&](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+    std::vector<int64_t> sortedKeys(keys.size());
+    mesh.vertices.resize(keys.size());
+    parallelFor(0, chunkCount(perm.size(), ITEMS_PER_TASK), numThreads, [&](int task) {
+        const size_t end = std::min(perm.size(), size_t(task + 1) * ITEMS_PER_TASK);
+        for (size_t v = size_t(task) * ITEMS_PER_TASK; v < end; ++v) {
+            sortedKeys[v] = keys[perm[v]];
+            mesh.vertices[v] = positions[perm[v]];
+        }
+    });
+
+    // Triangles in (axis, edge) order, cell keys mapped to vertex ids
+    std::vector<int64_t> order;
+    std::vector<std::array<int64_t,3>> triangles;
+    for (const DCChunk& chunk : chunks) {
+        order.insert(order.end(), chunk.triangleOrder.begin(), chunk.triangleOrder.end());
+        triangles.insert(triangles.end(), chunk.triangles.begin(), chunk.triangles.end());
+    }
+    perm.resize(order.size());
+    std::iota(perm.begin(), perm.end(), 0);
+    std::sort(perm.begin(), perm.end(), [&](size_t a, size_t b) { return order[a] < order[b]; });
+
+    mesh.triangles.resize(triangles.size());
+    parallelFor(0, chunkCount(perm.size(), ITEMS_PER_TASK), numThreads, [&](int task) {
+        const size_t end = std::min(perm.size(), size_t(task + 1) * ITEMS_PER_TASK);
+        for (size_t t = size_t(task) * ITEMS_PER_TASK; t < end; ++t) {
+            for (int c = 0; c < 3; ++c) {
+                const int64_t key = triangles[perm[t]][c];
+                const auto it = std::lower_bound(sortedKeys.begin(), sortedKeys.end(), key);
+                mesh.triangles[t][c] = static_cast<int>(it - sortedKeys.begin());
+            }
+        }
+    });
+    return mesh;
+}
+
+DCMesh dualContourChunked(const ImplicitField& f, const ChunkLayout& layout, int numThreads) {
+    std::vector<DCChunk> chunks(layout.numChunks());
+    const int nx = layout.chunksAlong(0), ny = layout.chunksAlong(1);
+    parallelFor(0, layout.numChunks(), numThreads, [&](int c) {
+        chunks[c] = meshChunk(f, layout, c % nx, (c / nx) % ny, c / (nx * ny));
+    });
+    return mergeChunks(chunks, numThreads);
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "dual_contour.h"
+#include <Eigen/Core>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// A global lattice of cells[0] x cells[1] x cells[2] cells of edge cellSize,
+// with lattice corner (0,0,0) at origin, split into chunks of chunkSize^3
+// cells (the last chunk along an axis may be smaller). Corner (i,j,k) sits at
+// origin + (i,j,k) * cellSize, the same arithmetic buildGrid uses, so a cubic
+// layout samples exactly the corners of the matching DCGrid.
+struct ChunkLayout {
+    Eigen::Vector3f origin = Eigen::Vector3f::Constant(-1.0f);
+    float cellSize = 2.0f / 64;
+    int cells[3] = {64, 64, 64};
+    int chunkSize = 64;
+
+    int chunksAlong(int axis) const { return (cells[axis] + chunkSize - 1) / chunkSize; }
+    int numChunks() const { return chunksAlong(0) * chunksAlong(1) * chunksAlong(2); }
+
+    // Linear keys of global cells and corners, (i, j, k) with i fastest
+    int64_t cellKey(int i, int j, int k) const {
+        return i + int64_t(cells[0]) * (j + int64_t(cells[1]) * k);
+    }
+    int64_t cornerKey(int i, int j, int k) const {
+        return i + int64_t(cells[0] + 1) * (j + int64_t(cells[1] + 1) * k);
+    }
+};
+
+// The layout matching buildGrid(f, N, minBound, maxBound).
+ChunkLayout cubicChunkLayout(int N, float minBound=-1.f, float maxBound=1.f, int chunkSize=64);
+
+// Mesh fragment of one chunk. A chunk owns the vertices of its cells and the
+// quads of the sign-changing edges whose lower corner lies in its cells; the
+// cells around an owned edge reach one cell below the chunk, so the chunk
+// samples a one-cell apron there and recomputes those vertices (bit-identical
+// to their owner's) without emitting them. Triangles refer to vertices by
+// global cell key, so fragments merge without seam duplicates.
+struct DCChunk {
+    std::vector<int64_t>             vertexCells;  // global cell key per owned vertex, ascending
+    std::vector<std::array<float,3>> vertices;
+    std::vector<std::array<int64_t,3>> triangles;  // corners as global cell keys
+    std::vector<int64_t>             triangleOrder; // (axis, edge corner key, half) packed; see mergeChunks
+};
+
+DCChunk meshChunk(const ImplicitField& f, const ChunkLayout& layout, int ci, int cj, int ck);
+
+// Stitch chunk fragments into one mesh: vertex ids follow global cell order and
+// triangles global (axis, edge) order, so the result equals the monolithic
+// dualContour mesh of the same lattice.
+DCMesh mergeChunks(const std::vector<DCChunk>& chunks, int numThreads=0);
+
+// Mesh every chunk concurrently, then merge. Chunks are handed to workers one
+// at a time from a shared counter, so chunks crossed by the surface and empty
+// ones balance out.
+DCMesh dualContourChunked(const ImplicitField& f, const ChunkLayout& layout, int numThreads=0);
@@ -0,0 +1,418 @@
+#pragma once
+#include "dual_contour.h"
+#include "parallel.h"
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Constructive solid geometry as expression templates. Primitives and the
+// operations below compose into one type per model, e.g.
+//     auto part = csgDifference(csgUnion(csgBox({0, 0, 0}, {0.6f, 0.2f, 0.4f}),
+//                                        csgTranslate(csgTorus(0.3f, 0.08f), {0, 0.2f, 0})),
+//                               csgSphere({0.4f, 0, 0}, 0.15f));
+// so the whole tree is inlined into one evaluator: operator()(x, y, z) is a
+// field object for buildGrid / dualContour (see dual_contour.h).
+//
+// Every node also bounds its values over a box by interval arithmetic. While
+// bounding, a node marks children that cannot change its value anywhere in the
+// box (a union member that is never the minimum, ...) as inactive, and
+// eval(x, y, z, active) then skips them; inside that box the pruned value is
+// identical to the full one. buildGridCSG uses both to skip blocks the surface
+// cannot cross and to sample the rest with only the nearby primitives.
+//
+// Each node owns `size` slots of an activity mask, itself first and its
+// children after it in pre-order.
+
+struct CSGInterval {
+    float lo, hi;
+    bool containsZero() const { return lo <= 0.0f && hi >= 0.0f; }
+};
+
+struct CSGBounds {
+    Eigen::Vector3f lo, hi;
+};
+
+// Widening of every primitive bound, so float rounding never prunes a node
+// that should have been kept
+inline constexpr float CSG_BOUND_SLACK = 1e-5f;
+
+// Half-diagonal and centre of a box, for bounds of 1-Lipschitz primitives
+inline CSGInterval lipschitzBound(float centreValue, const CSGBounds& box) {
+    const float reach = 0.5f * (box.hi - box.lo).norm();
+    return {centreValue - reach - CSG_BOUND_SLACK, centreValue + reach + CSG_BOUND_SLACK};
+}
+
+// ---- Primitives (exact signed distances) ----------------------------------
+
+struct CSGSphere {
+    static constexpr int size = 1;
+    Eigen::Vector3f centre;
+    float radius;
+
+    float operator()(float x, float y, float z) const {
+        return (Eigen::Vector3f(x, y, z) - centre).norm() - radius;
+    }
+    float eval(float x, float y, float z, const uint8_t*) const { return (*this)(x, y, z); }
+    CSGInterval bound(const CSGBounds& box, uint8_t*) const {
+        // Nearest and farthest points of the box from the centre
+        const Eigen::Vector3f nearest = centre.cwiseMax(box.lo).cwiseMin(box.hi);
+        const Eigen::Vector3f farthest = (centre - box.lo).cwiseAbs().cwiseMax((box.hi - centre).cwiseAbs());
+        return {(nearest - centre).norm() - radius - CSG_BOUND_SLACK,
+                farthest.norm() - radius + CSG_BOUND_SLACK};
+    }
+};
+
+struct CSGBox {
+    static constexpr int size = 1;
+    Eigen::Vector3f centre, half;
+
+    float operator()(float x, float y, float z) const {
+        const Eigen::Vector3f q = (Eigen::Vector3f(x, y, z) - centre).cwiseAbs() - half;
+        return q.cwiseMax(Eigen::Vector3f::Zero()).norm() + std::min(q.maxCoeff(), 0.0f);
+    }
+    float eval(float x, float y, float z, const uint8_t*) const { return (*this)(x, y, z); }
+    CSGInterval bound(const CSGBounds& box, uint8_t*) const {
+        const Eigen::Vector3f m = 0.5f * (box.lo + box.hi);
+        return lipschitzBound((*this)(m.x(), m.y(), m.z()), box);
+    }
+};
+
+// Torus around the Y axis through centre (major radius R, minor radius r)
+struct CSGTorus {
+    static constexpr int size = 1;
+    Eigen::Vector3f centre;
+    float major, minor;
+
+    float operator()(float x, float y, float z) const {
+        const float px = x - centre.x(), py = y - centre.y(), pz = z - centre.z();
+        const float qx = std::sqrt(px*px + pz*pz) - major;
+        return std::sqrt(qx*qx + py*py) - minor;
+    }
+    float eval(float x, float y, float z, const uint8_t*) const { return (*this)(x, y, z); }
+    CSGInterval bound(const CSGBounds& box, uint8_t*) const {
+        const Eigen::Vector3f m = 0.5f * (box.lo + box.hi);
+        return lipschitzBound((*this)(m.x(), m.y(), m.z()), box);
+    }
+};
+
+// ---- Operations -------------------------------------------------------------
+
+template <class A, class B>
+struct CSGUnion {
+    static constexpr int size = 1 + A::size + B::size;
+    A a;
+    B b;
+
+    float operator()(float x, float y, float z) const { return std::min(a(x, y, z), b(x, y, z)); }
+    float eval(float x, float y, float z, const uint8_t* active) const {
+        const uint8_t* ta = active + 1;
+        const uint8_t* tb = active + 1 + A::size;
+        if (!*ta) return b.eval(x, y, z, tb);
+        if (!*tb) return a.eval(x, y, z, ta);
+        return std::min(a.eval(x, y, z, ta), b.eval(x, y, z, tb));
+    }
+    CSGInterval bound(const CSGBounds& box, uint8_t* active) const {
+        uint8_t* ta = active + 1;
+        uint8_t* tb = active + 1 + A::size;
+        if (!*ta) return b.bound(box, tb);
+        if (!*tb) return a.bound(box, ta);
+        const CSGInterval ia = a.bound(box, ta), ib = b.bound(box, tb);
+        // A child that is never below the other never is the minimum
+        if (ia.lo >= ib.hi) { *ta = 0; return ib; }
+        if (ib.lo >= ia.hi) { *tb = 0; return ia; }
+        return {std::min(ia.lo, ib.lo), std::min(ia.hi, ib.hi)};
+    }
+};
+
+template <class A, class B>
+struct CSGIntersection {
+    static constexpr int size = 1 + A::size + B::size;
+    A a;
+    B b;
+
+    float operator()(float x, float y, float z) const { return std::max(a(x, y, z), b(x, y, z)); }
+    float eval(float x, float y, float z, const uint8_t* active) const {
+        const uint8_t* ta = active + 1;
+        const uint8_t* tb = active + 1 + A::size;
+        if (!*ta) return b.eval(x, y, z, tb);
+        if (!*tb) return a.eval(x, y, z, ta);
+        return std::max(a.eval(x, y, z, ta), b.eval(x, y, z, tb));
+    }
+    CSGInterval bound(const CSGBounds& box, uint8_t* active) const {
+        uint8_t* ta = active + 1;
+        uint8_t* tb = active + 1 + A::size;
+        if (!*ta) return b.bound(box, tb);
+        if (!*tb) return a.bound(box, ta);
+        const CSGInterval ia = a.bound(box, ta), ib = b.bound(box, tb);
+        if (ia.hi <= ib.lo) { *ta = 0; return ib; }
+        if (ib.hi <= ia.lo) { *tb = 0; return ia; }
+        return {std::max(ia.lo, ib.lo), std::max(ia.hi, ib.hi)};
+    }
+};
+
+// a minus b: max(a, -b)
+template <class A, class B>
+struct CSGDifference {
+    static constexpr int size = 1 + A::size + B::size;
+    A a;
+    B b;
+
+    float operator()(float x, float y, float z) const { return std::max(a(x, y, z), -b(x, y, z)); }
+    float eval(float x, float y, float z, const uint8_t* active) const {
+        const uint8_t* ta = active + 1;
+        const uint8_t* tb = active + 1 + A::size;
+        if (!*ta) return -b.eval(x, y, z, tb);
+        if (!*tb) return a.eval(x, y, z, ta);
+        return std::max(a.eval(x, y, z, ta), -b.eval(x, y, z, tb));
+    }
+    CSGInterval bound(const CSGBounds& box, uint8_t* active) const {
+        uint8_t* ta = active + 1;
+        uint8_t* tb = active + 1 + A::size;
+        if (!*ta) {
+            const CSGInterval ib = b.bound(box, tb);
+            return {-ib.hi, -ib.lo};
+        }
+        if (!*tb) return a.bound(box, ta);
+        const CSGInterval ia = a.bound(box, ta), ib = b.bound(box, tb);
+        const CSGInterval nb = {-ib.hi, -ib.lo};
+        if (ia.hi <= nb.lo) { *ta = 0; return nb; }
+        if (nb.hi <= ia.lo) { *tb = 0; return ia; }
+        return {std::max(ia.lo, nb.lo), std::max(ia.hi, nb.hi)};
+    }
+};
+
+// Polynomial smooth minimum with blend radius k: min(a, b) - h^2 k / 4,
+// h = max(k - |a - b|, 0) / k, so the value is min(a, b) wherever |a - b| >= k.
+template <class A, class B>
+struct CSGSmoothUnion {
+    static constexpr int size = 1 + A::size + B::size;
+    A a;
+    B b;
+    float k;
+
+    float blend(float va, float vb) const {
+        const float h = std::max(k - std::abs(va - vb), 0.0f) / k;
+        return std::min(va, vb) - h * h * k * 0.25f;
+    }
+    float operator()(float x, float y, float z) const { return blend(a(x, y, z), b(x, y, z)); }
+    float eval(float x, float y, float z, const uint8_t* active) const {
+        const uint8_t* ta = active + 1;
+        const uint8_t* tb = active + 1 + A::size;
+        if (!*ta) return b.eval(x, y, z, tb);
+        if (!*tb) return a.eval(x, y, z, ta);
+        return blend(a.eval(x, y, z, ta), b.eval(x, y, z, tb));
+    }
+    CSGInterval bound(const CSGBounds& box, uint8_t* active) const {
+        uint8_t* ta = active + 1;
+        uint8_t* tb = active + 1 + A::size;
+        if (!*ta) return b.bound(box, tb);
+        if (!*tb) return a.bound(box, ta);
+        const CSGInterval ia = a.bound(box, ta), ib = b.bound(box, tb);
+        // Beyond the blend radius the other child is the exact value
+        if (ia.lo >= ib.hi + k) { *ta = 0; return ib; }
+        if (ib.lo >= ia.hi + k) { *tb = 0; return ia; }
+        return {std::min(ia.lo, ib.lo) - 0.25f * k, std::min(ia.hi, ib.hi)};
+    }
+};
+
+template <class A>
+struct CSGTranslate {
+    static constexpr int size = 1 + A::size;
+    A a;
+    Eigen::Vector3f offset;
+
+    float operator()(float x, float y, float z) const {
+        return a(x - offset.x(), y - offset.y(), z - offset.z());
+    }
+    float eval(float x, float y, float z, const uint8_t* active) const {
+        return a.eval(x - offset.x(), y - offset.y(), z - offset.z(), active + 1);
+    }
+    CSGInterval bound(const CSGBounds& box, uint8_t* active) const {
+        return a.bound({box.lo - offset, box.hi - offset}, active + 1);
+    }
+};
+
+// Uniform scale about the origin; keeps a distance field a distance field
+template <class A>
+struct CSGScale {
+    static constexpr int size = 1 + A::size;
+    A a;
+    float factor;
+
+    float operator()(float x, float y, float z) const {
+        return factor * a(x / factor, y / factor, z / factor);
+    }
+    float eval(float x, float y, float z, const uint8_t* active) const {
+        return factor * a.eval(x / factor, y / factor, z / factor, active + 1);
+    }
+    CSGInterval bound(const CSGBounds& box, uint8_t* active) const {
+        const CSGInterval i = a.bound({box.lo / factor, box.hi / factor}, active + 1);
+        return {factor * i.lo - CSG_BOUND_SLACK, factor * i.hi + CSG_BOUND_SLACK};
+    }
+};
+
+// ---- Builders -----------------------------------------------------------------
+
+inline CSGSphere csgSphere(const Eigen::Vector3f& centre, float radius) { return {centre, radius}; }
+inline CSGBox csgBox(const Eigen::Vector3f& centre, const Eigen::Vector3f& half) { return {centre, half}; }
+inline CSGTorus csgTorus(float major, float minor, const Eigen::Vector3f& centre = Eigen::Vector3f::Zero()) {
+    return {centre, major, minor};
+}
+
+template <class A, class B>
+CSGIntersection<A, B> csgIntersection(const A& a, const B& b) { return {a, b}; }
+template <class A, class B>
+CSGDifference<A, B> csgDifference(const A& a, const B& b) { return {a, b}; }
+template <class A, class B>
+CSGSmoothUnion<A, B> csgSmoothUnion(const A& a, const B& b, float k) { return {a, b, k}; }
+template <class A>
+CSGTranslate<A> csgTranslate(const A& a, const Eigen::Vector3f& offset) { return {a, offset}; }
+template <class A>
+CSGScale<A> csgScale(const A& a, float factor) { return {a, factor}; }
+
+// Union of parts[Begin, End) as a balanced tree, so a block far from most
+// parts prunes them a whole subtree at a time
+template <size_t Begin, size_t End, class Parts>
+auto csgUnionRange(const Parts& parts) {
+    if constexpr (End - Begin == 1) {
+        return std::get<Begin>(parts);
+    } else {
+        constexpr size_t mid = (Begin + End) / 2;
+        auto a = csgUnionRange<Begin, mid>(parts);
+        auto b = csgUnionRange<mid, End>(parts);
+        return CSGUnion<decltype(a), decltype(b)>{a, b};
+    }
+}
+
+template <class... Parts>
+auto csgUnion(const Parts&... parts) {
+    static_assert(sizeof...(Parts) > 0, "csgUnion needs at least one part");
+    return csgUnionRange<0, sizeof...(Parts)>(std::tie(parts...));
+}
+
+// ---- Sampling -------------------------------------------------------------------
+
+// buildGridHierarchical for CSG expressions, with interval bounds instead of
+// distance tests. Blocks from 16 down to 4 cells are bounded with the parent's
+// pruned tree: a block whose bound excludes 0 gets a sign-only fill (its
+// bound nearest 0), the others are split, and each 4-cell block the surface
+// may cross keeps its activity mask. Corners of those blocks are evaluated
+// exactly with the mask of one of them, so values, and the mesh dualContour
+// produces from them, are identical to buildGrid(expr). stats->
+// centreEvaluations counts block bounds.
+template <class Expr>
+DCGrid buildGridCSG(const Expr& expr, int N, float minBound=-1.f, float maxBound=1.f,
+                    int numThreads=0, SamplingStats* stats=nullptr) {
+    using Mask = std::array<uint8_t, Expr::size>;
+    DCGrid grid;
+    grid.N = N;
+    grid.minBound = minBound;
+    grid.maxBound = maxBound;
+    grid.cellSize = (maxBound - minBound) / N;
+    grid.values.resize((N+1) * (N+1) * (N+1));
+    grid.vertexIndex.resize(N * N * N, -1);
+    const float cellSize = grid.cellSize;
+
+    const int leafSize = 4;
+    int topSize = leafSize;
+    while (topSize < 16 && topSize < N) topSize *= 2;
+    const int leaves = (N + leafSize - 1) / leafSize;     // leaf blocks per axis
+    const int tops = (N + topSize - 1) / topSize;         // top blocks per axis
+
+    // Per leaf block: the sign-only fill of the skipped block it lies in, or
+    // the slot of its mask among the refined leaves (-1 if skipped)
+    std::vector<float> fill(size_t(leaves) * leaves * leaves, 0.0f);
+    std::vector<int> slot(fill.size(), -1);
+    struct RefinedLeaf {
+        int leaf;
+        Mask active;
+    };
+    std::vector<RefinedLeaf> refined;
+    std::vector<long long> topBounds(size_t(tops) * tops * tops, 0);
+
+    // One top block per task, refined depth-first; tasks touch disjoint leaves
+    parallelGather(tops * tops * tops, numThreads, refined,
+                   [&](int top, std::vector<RefinedLeaf>& out) {
+        auto refine = [&](auto&& self, int i, int j, int k, int size, Mask active) -> void {
+            const CSGBounds box = {
+                Eigen::Vector3f(minBound + i * cellSize, minBound + j * cellSize, minBound + k * cellSize),
+                Eigen::Vector3f(minBound + std::min(i + size, N) * cellSize,
+                                minBound + std::min(j + size, N) * cellSize,
+                                minBound + std::min(k + size, N) * cellSize)};
+            const CSGInterval range = expr.bound(box, active.data());
+            ++topBounds[top];
+            const int li0 = i / leafSize, lj0 = j / leafSize, lk0 = k / leafSize;
+            if (!range.containsZero()) {
+                const float value = range.lo > 0.0f ? range.lo : range.hi;
+                const int span = size / leafSize;
+                for (int lk = lk0; lk < std::min(lk0 + span, leaves); ++lk)
+                    for (int lj = lj0; lj < std::min(lj0 + span, leaves); ++lj)
+                        for (int li = li0; li < std::min(li0 + span, leaves); ++li)
+                            fill[li + size_t(leaves) * (lj + size_t(leaves) * lk)] = value;
+            } else if (size == leafSize) {
+                out.push_back({li0 + leaves * (lj0 + leaves * lk0), active});
+            } else {
+                const int h = size / 2;
+                for (int c = 0; c < 8; ++c) {
+                    const int ci = i + (c & 1) * h, cj = j + ((c >> 1) & 1) * h, ck = k + ((c >> 2) & 1) * h;
+                    if (ci < N && cj < N && ck < N) self(self, ci, cj, ck, h, active);
+                }
+            }
+        };
+        Mask all;
+        all.fill(1);
+        const int ti = top % tops, tj = (top / tops) % tops, tk = top / (tops * tops);
+        refine(refine, ti * topSize, tj * topSize, tk * topSize, topSize, all);
+    });
+    for (size_t r = 0; r < refined.size(); ++r) slot[refined[r].leaf] = static_cast<int>(r);
+
+    // Leaf blocks whose closed box contains lattice coordinate c along one axis
+    auto leafRange = [&](int c, int& lo, int& hi) {
+        hi = std::min(c / leafSize, leaves - 1);
+        lo = (c % leafSize == 0 && c > 0) ? c / leafSize - 1 : hi;
+    };
+
+    // Corners touched by a refined leaf are evaluated with its mask; all
+    // others take their leaf's fill. One z-slab per task.
+    std::vector<long long> slabEvals(N + 1, 0);
+    parallelFor(0, N + 1, numThreads, [&](int k) {
+        const float z = minBound + k * cellSize;
+        int klo, khi;
+        leafRange(k, klo, khi);
+        for (int j = 0; j <= N; ++j) {
+            const float y = minBound + j * cellSize;
+            int jlo, jhi;
+            leafRange(j, jlo, jhi);
+            for (int i = 0; i <= N; ++i) {
+                int ilo, ihi;
+                leafRange(i, ilo, ihi);
+                int s = -1;
+                for (int lk = klo; lk <= khi && s < 0; ++lk)
+                    for (int lj = jlo; lj <= jhi && s < 0; ++lj)
+                        for (int li = ilo; li <= ihi && s < 0; ++li)
+                            s = slot[li + size_t(leaves) * (lj + size_t(leaves) * lk)];
+                float& value = grid.values[gridCornerIndex(i, j, k, N)];
+                if (s < 0) {
+                    value = fill[ihi + size_t(leaves) * (jhi + size_t(leaves) * khi)];
+                } else {
+                    value = expr.eval(minBound + i * cellSize, y, z, refined[s].active.data());
+                    ++slabEvals[k];
+                }
+            }
+        }
+    });
+
+    if (stats) {
+        stats->centreEvaluations = 0;
+        for (long long n : topBounds) stats->centreEvaluations += n;
+        stats->cornerEvaluations = 0;
+        for (long long n : slabEvals) stats->cornerEvaluations += n;
+        stats->denseEvaluations = static_cast<long long>(N+1) * (N+1) * (N+1);
+    }
+    return grid;
+}
@@ -1,116 +1,301 @@
 #include "dual_contour.h"
 #include "qef.h"
 #include "implicit.h"
+#include "parallel.h"
 #include <Eigen/Core>
 #include <Eigen/Geometry>
 #include <cmath>
+#include <cstdint>
 #include <algorithm>
-
-// Flat index helpers
-static inline int cornerIdx(int i, int j, int k, int N) {
-    return i + (N+1)*j + (N+1)*(N+1)*k;
-}
-
-static inline int cellIdx(int ci, int cj, int ck, int N) {
-    return ci + N*cj + N*N*ck;
-}
+#include <limits>
 
 // 12 edges per cell: EDGE_CORNERS[edge][0] and EDGE_CORNERS[edge][1] are corner indices
-static const int EDGE_CORNERS[12][2] = {
+const int EDGE_CORNERS[12][2] = {
     {0,1}, {2,3}, {4,5}, {6,7},   // X-axis edges
     {0,2}, {1,3}, {4,6}, {5,7},   // Y-axis edges
     {0,4}, {1,5}, {2,6}, {3,7}    // Z-axis edges
 };
 
-// Get corner position from corner index (0-7) within a cell
-static Eigen::Vector3f getCornerPos(int corner, int ci, int cj, int ck, float minBound, float cellSize) {
-    int i = ci + (corner & 1);
-    int j = cj + ((corner >> 1) & 1);
-    int k = ck + ((corner >> 2) & 1);
-    return Eigen::Vector3f(
-        minBound + i * cellSize,
-        minBound + j * cellSize,
-        minBound + k * cellSize
-    );
+DCGrid buildGrid(const ImplicitField& f, int N, float minBound, float maxBound, int numThreads) {
+    return buildGrid<ImplicitField>(f, N, minBound, maxBound, numThreads);
 }
 
-DCGrid buildGrid(ScalarField f, int N, float minBound, float maxBound) {
+// Coarse-to-fine sampling. Blocks of `size` cells are tested breadth-first, one
+// level at a time so each level's centres go to the field as batches.
+struct SampleBlock { int i, j, k; };
+
+DCGrid buildGridHierarchical(const ImplicitField& f, int N, float minBound, float maxBound,
+                             int numThreads, float safetyFactor, SamplingStats* stats) {
     DCGrid grid;
     grid.N = N;
     grid.minBound = minBound;
     grid.maxBound = maxBound;
     grid.cellSize = (maxBound - minBound) / N;
-    
-    int numCorners = (N+1) * (N+1) * (N+1);
-    grid.values.resize(numCorners);
+    grid.values.resize((N+1) * (N+1) * (N+1));
     grid.vertexIndex.resize(N * N * N, -1);
-    
-    // Sample the scalar field at all corners
-    for (int k = 0; k <= N; ++k) {
+    const float cellSize = grid.cellSize;
+
+    const int leafSize = 2;
+    int topSize = leafSize;
+    while (topSize < 16 && topSize < N) topSize *= 2;
+    const int leaves = (N + leafSize - 1) / leafSize;  // leaf blocks per axis
+
+    // Per leaf block: refined (sample every corner) or the sign-only fill of the
+    // skipped ancestor it lies in.
+    std::vector<uint8_t> refined(size_t(leaves) * leaves * leaves, 0);
+    std::vector<float>   fill(refined.size(), 0.0f);
+    long long centreEvals = 0;
+
+    std::vector<SampleBlock> level;
+    for (int k = 0; k < N; k += topSize)
+        for (int j = 0; j < N; j += topSize)
+            for (int i = 0; i < N; i += topSize)
+                level.push_back({i, j, k});
+
+    for (int size = topSize; !level.empty(); size /= 2) {
+        // Evaluate all block centres of this level in batched chunks
+        const float half = 0.5f * size;
+        std::vector<float> centreValue(level.size());
+        const size_t chunk = 256;
+        parallelFor(0, chunkCount(level.size(), chunk), numThreads, [&](int task) {
+            const size_t begin = task * chunk, end = std::min(level.size(), begin + chunk);
+            float xs[chunk], ys[chunk], zs[chunk];
+            for (size_t b = begin; b < end; ++b) {
+                xs[b - begin] = minBound + (level[b].i + half) * cellSize;
+                ys[b - begin] = minBound + (level[b].j + half) * cellSize;
+                zs[b - begin] = minBound + (level[b].k + half) * cellSize;
+            }
+            f.evaluate(xs, ys, zs, &centreValue[begin], static_cast<int>(end - begin));
+        });
+        centreEvals += static_cast<long long>(level.size());
+
+        // Skip blocks the surface cannot reach; refine the rest
+        const float halfDiagonal = 0.5f * std::sqrt(3.0f) * size * cellSize;
+        const float reach = std::max(safetyFactor, 1.0f) * halfDiagonal;
+        std::vector<SampleBlock> next;
+        parallelGather(chunkCount(level.size(), chunk), numThreads, next,
+                       [&](int task, std::vector<SampleBlock>& out) {
+            const size_t end = std::min(level.size(), (task + 1) * chunk);
+            for (size_t b = task * chunk; b < end; ++b) {
+                const SampleBlock& block = level[b];
+                const float fc = centreValue[b];
+                const int li0 = block.i / leafSize, lj0 = block.j / leafSize, lk0 = block.k / leafSize;
+                const int span = size / leafSize;
+                if (std::abs(fc) > reach) {
+                    // |f| >= |f(centre)| - halfDiagonal everywhere in the block
+                    const float bound = std::max(std::abs(fc) - halfDiagonal,
+                                                 std::numeric_limits<float>::min());
+                    for (int lk = lk0; lk < std::min(lk0 + span, leaves); ++lk)
+                        for (int lj = lj0; lj < std::min(lj0 + span, leaves); ++lj)
+                            for (int li = li0; li < std::min(li0 + span, leaves); ++li)
+                                fill[li + size_t(leaves) * (lj + size_t(leaves) * lk)] = fc < 0.0f ? -bound : bound;
+                } else if (size == leafSize) {
+                    refined[li0 + size_t(leaves) * (lj0 + size_t(leaves) * lk0)] = 1;
+                } else {
+                    const int h = size / 2;
+                    for (int c = 0; c < 8; ++c) {
+                        SampleBlock child{block.i + (c & 1) * h, block.j + ((c >> 1) & 1) * h,
+                                          block.k + ((c >> 2) & 1) * h};
+                        if (child.i < N && child.j < N && child.k < N) out.push_back(child);
+                    }
+                }
+            }
+        });
+        level.swap(next);
+    }
+
+    // Leaf blocks whose closed box contains lattice coordinate c along one axis
+    auto leafRange = [&](int c, int& lo, int& hi) {
+        hi = std::min(c / leafSize, leaves - 1);
+        lo = (c % leafSize == 0 && c > 0) ? c / leafSize - 1 : hi;
+    };
+
+    // Fine pass, one z-slab per task: corners touched by a refined leaf are
+    // sampled exactly (batched per row); all others take their leaf's fill.
+    std::vector<long long> slabEvals(N + 1, 0);
+    parallelFor(0, N + 1, numThreads, [&](int k) {
+        std::vector<float> xs(N + 1), ys(N + 1), zs(N + 1, minBound + k * cellSize), out(N + 1);
+        std::vector<int> exact;
+        int klo, khi;
+        leafRange(k, klo, khi);
         for (int j = 0; j <= N; ++j) {
+            int jlo, jhi;
+            leafRange(j, jlo, jhi);
+            exact.clear();
             for (int i = 0; i <= N; ++i) {
-                float x = minBound + i * grid.cellSize;
-                float y = minBound + j * grid.cellSize;
-                float z = minBound + k * grid.cellSize;
-                int idx = cornerIdx(i, j, k, N);
-                grid.values[idx] = f(x, y, z);
+                int ilo, ihi;
+                leafRange(i, ilo, ihi);
+                bool needed = false;
+                for (int lk = klo; lk <= khi && !needed; ++lk)
+                    for (int lj = jlo; lj <= jhi && !needed; ++lj)
+                        for (int li = ilo; li <= ihi && !needed; ++li)
+                            needed = refined[li + size_t(leaves) * (lj + size_t(leaves) * lk)] != 0;
+                if (needed) {
+                    xs[exact.size()] = minBound + i * cellSize;
+                    exact.push_back(i);
+                } else {
+                    grid.values[gridCornerIndex(i, j, k, N)] =
+                        fill[ihi + size_t(leaves) * (jhi + size_t(leaves) * khi)];
+                }
+            }
+            if (exact.empty()) continue;
+            std::fill(ys.begin(), ys.begin() + exact.size(), minBound + j * cellSize);
+            f.evaluate(xs.data(), ys.data(), zs.data(), out.data(), static_cast<int>(exact.size()));
+            for (size_t e = 0; e < exact.size(); ++e) {
+                grid.values[gridCornerIndex(exact[e], j, k, N)] = out[e];
             }
+            slabEvals[k] += static_cast<long long>(exact.size());
         }
+    });
+
+    if (stats) {
+        stats->centreEvaluations = centreEvals;
+        stats->cornerEvaluations = 0;
+        for (long long n : slabEvals) stats->cornerEvaluations += n;
+        stats->denseEvaluations = static_cast<long long>(N+1) * (N+1) * (N+1);
     }
-    
     return grid;
 }
 
-DCMesh dualContour(ScalarField f, DCGrid& grid) {
+// For an edge along each axis with lower corner (i,j,k): the four cells around
+// it, as offsets from (i,j,k), in quad winding order.
+const int QUAD_CELLS[3][4][3] = {
+    {{0, -1, -1}, {0,  0, -1}, {0, 0, 0}, {0, -1,  0}},  // X-edges, around Y/Z
+    {{-1, 0, -1}, {0,  0, -1}, {0, 0, 0}, {-1, 0,  0}},  // Y-edges, around X/Z
+    {{-1, -1, 0}, {0, -1,  0}, {0, 0, 0}, {-1, 0,  0}}   // Z-edges, around X/Y
+};
+
+// Work granularity for the list-based passes (edges / triangles per task)
+static const int ITEMS_PER_TASK = 4096;
+
+static int taskCount(size_t items) {
+    return chunkCount(items, ITEMS_PER_TASK);
+}
+
+HermiteSample edgeHermite(const ImplicitField& f,
+                          const Eigen::Vector3f& p0, const Eigen::Vector3f& p1,
+                          float f0, float f1) {
+    return edgeHermite<ImplicitField>(f, p0, p1, f0, f1);
+}
+
+// The winding comes from the edge alone: QUAD_CELLS runs counter-clockwise
+// around +X and +Z and clockwise around +Y, and sign(f1 - f0) along the edge
+// says which way the surface faces. Unlike a test against the geometric normal
+// of the quad, this stays consistent between neighbouring quads when a quad is
+// folded (thin features, or a vertex clamped back into its cell).
+static inline bool facesCellOrder(int axis, bool rising) {
+    return rising != (axis == 1);
+}
+
+void appendQuad(int v[4], int axis, bool rising, std::vector<std::array<int,3>>& out) {
+    if (!facesCellOrder(axis, rising)) {
+        std::swap(v[1], v[3]);
+    }
+
+    out.push_back({v[0], v[1], v[2]});
+    out.push_back({v[0], v[2], v[3]});
+}
+
+void appendPolygon(const int v[4], int axis, bool rising, std::vector<std::array<int,3>>& out) {
+    // Drop repeated neighbours (cyclically); a leaf can only repeat next to itself
+    int poly[4], n = 0;
+    for (int q = 0; q < 4; ++q) {
+        if (v[q] != v[(q + 3) % 4]) poly[n++] = v[q];
+    }
+    if (n == 4) {
+        appendQuad(poly, axis, rising, out);
+    } else if (n == 3) {
+        if (!facesCellOrder(axis, rising)) std::swap(poly[1], poly[2]);
+        out.push_back({poly[0], poly[1], poly[2]});
+    }
+}
+
+bool isDegenerateTriangle(const std::vector<std::array<float,3>>& vertices, const std::array<int,3>& tri) {
+    const Eigen::Vector3f p0(vertices[tri[0]][0], vertices[tri[0]][1], vertices[tri[0]][2]);
+    const Eigen::Vector3f p1(vertices[tri[1]][0], vertices[tri[1]][1], vertices[tri[1]][2]);
+    const Eigen::Vector3f p2(vertices[tri[2]][0], vertices[tri[2]][1], vertices[tri[2]][2]);
+    const Eigen::Vector3f n = (p1 - p0).cross(p2 - p0);
+    return n.squaredNorm() < 1e-12f;
+}
+
+void removeDegenerateTriangles(DCMesh& mesh, int numThreads) {
+    std::vector<std::array<int, 3>> cleanTriangles;
+    cleanTriangles.reserve(mesh.triangles.size());
+    parallelGather(taskCount(mesh.triangles.size()), numThreads, cleanTriangles,
+                   [&](int task, std::vector<std::array<int,3>>& out) {
+        const size_t end = std::min(mesh.triangles.size(), size_t(task + 1) * ITEMS_PER_TASK);
+        for (size_t t = size_t(task) * ITEMS_PER_TASK; t < end; ++t) {
+            const auto& tri = mesh.triangles[t];
+            if (!isDegenerateTriangle(mesh.vertices, tri)) out.push_back(tri);
+        }
+    });
+    mesh.triangles.swap(cleanTriangles);
+}
+
+void DCEdges::indexRows(int gridN) {
+    N = gridN;
+    const size_t rows = size_t(N + 1) * (N + 1);
+    for (int axis = 0; axis < 3; ++axis) {
+        std::vector<int>& start = rowStart[axis];
+        start.assign(rows + 1, 0);
+        for (const HermiteEdge& e : edges[axis]) ++start[e.j + (N+1) * e.k + 1];
+        for (size_t r = 0; r < rows; ++r) start[r + 1] += start[r];
+    }
+}
+
+void buildHermiteEdges(const ImplicitField& f, DCGrid& grid, int numThreads) {
+    buildHermiteEdges<ImplicitField>(f, grid, numThreads);
+}
+
+DCMesh dualContour(const ImplicitField& f, DCGrid& grid, int numThreads) {
+    return dualContour<ImplicitField>(f, grid, numThreads);
+}
+
+DCMesh dualContourHermite(DCGrid& grid, int numThreads) {
     DCMesh mesh;
     int N = grid.N;
     float minBound = grid.minBound;
     float cellSize = grid.cellSize;
+
+    // Accumulate a cell's QEF from its sign-changing edges in the shared store
+    auto gatherCell = [&](int ci, int cj, int ck, QEF& qef) {
+        for (int e = 0; e < 12; ++e) {
+            const int axis = e / 4;
+            const int c0 = EDGE_CORNERS[e][0];
+            const int slot = grid.edges.find(axis, ci + (c0 & 1), cj + ((c0 >> 1) & 1),
+                                             ck + ((c0 >> 2) & 1));
+            if (slot >= 0) {
+                qef.add(grid.edges.edges[axis][slot].hermite);
+            }
+        }
+    };
     
-    // Pass 1: One vertex per cell
-    for (int ck = 0; ck < N; ++ck) {
+    // Pass 1: One vertex per cell. Vertices are numbered in (ck, cj, ci) scan
+    // order for every thread count: count active cells per slab, prefix-sum the
+    // counts into slab offsets, then solve and fill each slab in parallel.
+    std::vector<int> slabOffset(N + 1, 0);
+    parallelFor(0, N, numThreads, [&](int ck) {
+        int active = 0;
         for (int cj = 0; cj < N; ++cj) {
             for (int ci = 0; ci < N; ++ci) {
-                // Get corner values for this cell
-                float cornerVals[8];
-                for (int c = 0; c < 8; ++c) {
-                    int i = ci + (c & 1);
-                    int j = cj + ((c >> 1) & 1);
-                    int k = ck + ((c >> 2) & 1);
-                    int idx = cornerIdx(i, j, k, N);
-                    cornerVals[c] = grid.values[idx];
-                }
-                
-                // Check all 12 edges for sign changes
-                std::vector<HermiteSample> samples;
-                for (int e = 0; e < 12; ++e) {
-                    int c0 = EDGE_CORNERS[e][0];
-                    int c1 = EDGE_CORNERS[e][1];
-                    float f0 = cornerVals[c0];
-                    float f1 = cornerVals[c1];
-                    
-                    if ((f0 < 0) != (f1 < 0)) {  // Sign change
-                        // Compute intersection point
-                        float t = -f0 / (f1 - f0);
-                        Eigen::Vector3f p0 = getCornerPos(c0, ci, cj, ck, minBound, cellSize);
-                        Eigen::Vector3f p1 = getCornerPos(c1, ci, cj, ck, minBound, cellSize);
-                        Eigen::Vector3f p = p0 + t * (p1 - p0);
-                        
-                        // Compute normal via gradient
-                        Eigen::Vector3f n = gradient(f, p.x(), p.y(), p.z());
-                        float len = n.norm();
-                        if (len > 1e-6f) {
-                            n /= len;
-                        } else {
-                            n = Eigen::Vector3f(1, 0, 0);  // Fallback
-                        }
-                        
-                        samples.push_back({p, n});
-                    }
-                }
+                if (cellHasSignChange(grid.values, ci, cj, ck, N)) ++active;
+            }
+        }
+        slabOffset[ck + 1] = active;
+    });
+    for (int ck = 0; ck < N; ++ck) slabOffset[ck + 1] += slabOffset[ck];
+    mesh.vertices.resize(slabOffset[N]);
+
+    parallelFor(0, N, numThreads, [&](int ck) {
+        int vertexIdx = slabOffset[ck];
+        for (int cj = 0; cj < N; ++cj) {
+            for (int ci = 0; ci < N; ++ci) {
+                if (!cellHasSignChange(grid.values, ci, cj, ck, N)) continue;
+                QEF qef;
+                gatherCell(ci, cj, ck, qef);
                 
                 // If we have samples, solve QEF and add vertex
-                if (!samples.empty()) {
+                if (qef.count > 0) {
                     Eigen::Vector3f cellMin(minBound + ci * cellSize,
                                            minBound + cj * cellSize,
                                            minBound + ck * cellSize);
@@ -118,131 +303,54 @@ DCMesh dualContour(ScalarField f, DCGrid& grid) {
                                            minBound + (cj+1) * cellSize,
                                            minBound + (ck+1) * cellSize);
                     
-                    Eigen::Vector3f vertex = solveQEF(samples, cellMin, cellMax);
-                    int vertexIdx = static_cast<int>(mesh.vertices.size());
-                    mesh.vertices.push_back({vertex.x(), vertex.y(), vertex.z()});
-                    
-                    int cellIdx_val = cellIdx(ci, cj, ck, N);
-                    grid.vertexIndex[cellIdx_val] = vertexIdx;
+                    Eigen::Vector3f vertex = qef.solve(cellMin, cellMax);
+                    mesh.vertices[vertexIdx] = {vertex.x(), vertex.y(), vertex.z()};
+                    grid.vertexIndex[gridCellIndex(ci, cj, ck, N)] = vertexIdx++;
                 }
             }
         }
-    }
+    });
     
-    auto signChange = [](float a, float b) {
-        return (a < 0.0f) != (b < 0.0f);
-    };
-
     auto fetchCellVertex = [&](int ci, int cj, int ck, int& outV) -> bool {
         if (ci < 0 || cj < 0 || ck < 0 || ci >= N || cj >= N || ck >= N) return false;
-        outV = grid.vertexIndex[cellIdx(ci, cj, ck, N)];
+        outV = grid.vertexIndex[gridCellIndex(ci, cj, ck, N)];
         return outV >= 0;
     };
 
-    // outward: the direction the surface faces at this edge's sign change.
-    // sign(f1 - f0) * axis gives the reliable outward direction without calling
-    // gradient(), which can be unreliable near thin features of the mesh SDF.
-    auto emitQuad = [&](const int cells[4][3], const Eigen::Vector3f& outward) {
+    auto emitQuad = [&](const int cells[4][3], int axis, bool rising,
+                        std::vector<std::array<int,3>>& out) {
         int v[4];
         for (int t = 0; t < 4; ++t) {
             if (!fetchCellVertex(cells[t][0], cells[t][1], cells[t][2], v[t])) {
                 return;
             }
         }
-
-        const Eigen::Vector3f p0(mesh.vertices[v[0]][0], mesh.vertices[v[0]][1], mesh.vertices[v[0]][2]);
-        const Eigen::Vector3f p1(mesh.vertices[v[1]][0], mesh.vertices[v[1]][1], mesh.vertices[v[1]][2]);
-        const Eigen::Vector3f p2(mesh.vertices[v[2]][0], mesh.vertices[v[2]][1], mesh.vertices[v[2]][2]);
-        Eigen::Vector3f n = (p1 - p0).cross(p2 - p0);
-
-        if (n.squaredNorm() > 1e-16f && n.dot(outward) < 0.0f) {
-            std::swap(v[1], v[3]);
-        }
-
-        mesh.triangles.push_back({v[0], v[1], v[2]});
-        mesh.triangles.push_back({v[0], v[2], v[3]});
+        appendQuad(v, axis, rising, out);
     };
 
-    // Pass 2: emit one quad for each sign-changing grid edge.
-    // X-edges (i->i+1), shared by 4 cells around Y/Z.
-    for (int k = 0; k <= N; ++k) {
-        for (int j = 0; j <= N; ++j) {
-            for (int i = 0; i < N; ++i) {
-                float f0 = grid.values[cornerIdx(i, j, k, N)];
-                float f1 = grid.values[cornerIdx(i + 1, j, k, N)];
-                if (!signChange(f0, f1) || j == 0 || k == 0) continue;
-
-                const int cells[4][3] = {
-                    {i, j - 1, k - 1},
-                    {i, j,     k - 1},
-                    {i, j,     k},
-                    {i, j - 1, k}
-                };
-                // Outward direction: sign(f1-f0) * X
-                const float sx = (f1 > f0) ? 1.0f : -1.0f;
-                emitQuad(cells, Eigen::Vector3f(sx, 0.0f, 0.0f));
-            }
-        }
-    }
-
-    // Y-edges (j->j+1), shared by 4 cells around X/Z.
-    for (int k = 0; k <= N; ++k) {
-        for (int j = 0; j < N; ++j) {
-            for (int i = 0; i <= N; ++i) {
-                float f0 = grid.values[cornerIdx(i, j, k, N)];
-                float f1 = grid.values[cornerIdx(i, j + 1, k, N)];
-                if (!signChange(f0, f1) || i == 0 || k == 0) continue;
-
-                const int cells[4][3] = {
-                    {i - 1, j, k - 1},
-                    {i,     j, k - 1},
-                    {i,     j, k},
-                    {i - 1, j, k}
-                };
-                // Outward direction: sign(f1-f0) * Y
-                const float sy = (f1 > f0) ? 1.0f : -1.0f;
-                emitQuad(cells, Eigen::Vector3f(0.0f, sy, 0.0f));
-            }
-        }
-    }
-
-    // Z-edges (k->k+1), shared by 4 cells around X/Y.
-    for (int k = 0; k < N; ++k) {
-        for (int j = 0; j <= N; ++j) {
-            for (int i = 0; i <= N; ++i) {
-                float f0 = grid.values[cornerIdx(i, j, k, N)];
-                float f1 = grid.values[cornerIdx(i, j, k + 1, N)];
-                if (!signChange(f0, f1) || i == 0 || j == 0) continue;
-
-                const int cells[4][3] = {
-                    {i - 1, j - 1, k},
-                    {i,     j - 1, k},
-                    {i,     j,     k},
-                    {i - 1, j,     k}
-                };
-                // Outward direction: sign(f1-f0) * Z
-                const float sz = (f1 > f0) ? 1.0f : -1.0f;
-                emitQuad(cells, Eigen::Vector3f(0.0f, 0.0f, sz));
+    // Pass 2: emit one quad for each sign-changing grid edge, read from the edge
+    // store: X-edges, then Y, then Z, each in scan order. Chunks of the edge
+    // lists run in parallel and are concatenated in order.
+    for (int axis = 0; axis < 3; ++axis) {
+        const auto& edges = grid.edges.edges[axis];
+        parallelGather(taskCount(edges.size()), numThreads, mesh.triangles,
+                       [&](int task, std::vector<std::array<int,3>>& out) {
+            const size_t end = std::min(edges.size(), size_t(task + 1) * ITEMS_PER_TASK);
+            for (size_t e = size_t(task) * ITEMS_PER_TASK; e < end; ++e) {
+                const HermiteEdge& edge = edges[e];
+                int cells[4][3];
+                for (int c = 0; c < 4; ++c) {
+                    cells[c][0] = edge.i + QUAD_CELLS[axis][c][0];
+                    cells[c][1] = edge.j + QUAD_CELLS[axis][c][1];
+                    cells[c][2] = edge.k + QUAD_CELLS[axis][c][2];
+                }
+                emitQuad(cells, axis, edge.rising, out);
             }
-        }
+        });
     }
 
-    // Final pass: remove degenerate triangles and enforce consistent outward winding.
-    std::vector<std::array<int, 3>> cleanTriangles;
-    cleanTriangles.reserve(mesh.triangles.size());
-    for (const auto& tri : mesh.triangles) {
-        const Eigen::Vector3f p0(mesh.vertices[tri[0]][0], mesh.vertices[tri[0]][1], mesh.vertices[tri[0]][2]);
-        const Eigen::Vector3f p1(mesh.vertices[tri[1]][0], mesh.vertices[tri[1]][1], mesh.vertices[tri[1]][2]);
-        const Eigen::Vector3f p2(mesh.vertices[tri[2]][0], mesh.vertices[tri[2]][1], mesh.vertices[tri[2]][2]);
-        Eigen::Vector3f n = (p1 - p0).cross(p2 - p0);
-        if (n.squaredNorm() < 1e-12f) {
-            continue;
-        }
-
-        cleanTriangles.push_back(tri);
-    }
-    mesh.triangles.swap(cleanTriangles);
+    // Final pass: remove degenerate triangles (order-preserving, in parallel chunks).
+    removeDegenerateTriangles(mesh, numThreads);
     
     return mesh;
 }
-
@@ -1,13 +1,53 @@
 #pragma once
 #include "implicit.h"
+#include "parallel.h"
+#include "qef.h"
+#include <algorithm>
 #include <vector>
 #include <array>
+#include <type_traits>
+#include <utility>
+
+// One sign-changing grid edge: its lower corner (i,j,k), whether the field
+// increases along the edge (the outward side), and its crossing point/normal.
+struct HermiteEdge {
+    int i, j, k;
+    bool rising;
+    HermiteSample hermite;
+};
+
+// Hermite data for every sign-changing edge, computed once by dualContour and
+// shared by the (up to) four cells around the edge. Edges are found through
+// their row of corners (j, k) rather than a table over every corner, so the
+// lookup costs (N+1)^2 ints per axis, not (N+1)^3.
+struct DCEdges {
+    std::vector<HermiteEdge> edges[3];  // per axis, in (k, j, i) scan order
+    // Per axis, (N+1)^2 + 1 entries: the edges of corner row (j, k) are
+    // edges[axis][rowStart[r] .. rowStart[r + 1]) with r = j + (N+1) * k
+    std::vector<int> rowStart[3];
+    int N = 0;
+
+    // Fill rowStart from edges, which must be in scan order.
+    void indexRows(int gridN);
+
+    // Slot in edges[axis] of the edge with lower corner (i, j, k), or -1.
+    int find(int axis, int i, int j, int k) const {
+        const int row = j + (N+1) * k;
+        const HermiteEdge* first = edges[axis].data() + rowStart[axis][row];
+        const HermiteEdge* last = edges[axis].data() + rowStart[axis][row + 1];
+        // Rows hold a few crossings each
+        const HermiteEdge* e = std::lower_bound(first, last, i,
+            [](const HermiteEdge& edge, int value) { return edge.i < value; });
+        return e != last && e->i == i ? static_cast<int>(e - edges[axis].data()) : -1;
+    }
+};
 
 struct DCGrid {
     int N;
     float minBound, maxBound, cellSize;
     std::vector<float> values;       // (N+1)^3 scalar samples
     std::vector<int>   vertexIndex;  // N^3, -1 if no vertex in cell
+    DCEdges            edges;        // filled by dualContour
 };
 
 struct DCMesh {
@@ -15,6 +55,251 @@ struct DCMesh {
     std::vector<std::array<int,3>>   triangles;
 };
 
-DCGrid buildGrid(ScalarField f, int N, float minBound=-1.f, float maxBound=1.f);
-DCMesh dualContour(ScalarField f, DCGrid& grid);
+// Largest N for a DCGrid: its (N+1)^3 corners are indexed with int.
+inline constexpr int MAX_GRID_N = 1289;
+
+// Rows of corners are sampled through ImplicitField::evaluate, so fields with a
+// batch kernel are vectorized. buildGrid, buildHermiteEdges and dualContour
+// also take any field object with float operator()(x, y, z) const and are then
+// compiled for it (see "Fields known at compile time" below). numThreads <= 0
+// uses one thread per hardware core; 1 samples serially. DCGrid::values is
+// identical for every thread count.
+DCGrid buildGrid(const ImplicitField& f, int N, float minBound=-1.f, float maxBound=1.f,
+                 int numThreads=0);
+
+// Field evaluations spent by buildGridHierarchical, against (N+1)^3 for buildGrid.
+struct SamplingStats {
+    long long centreEvaluations = 0;  // coarse-to-fine block tests
+    long long cornerEvaluations = 0;  // exact corner samples
+    long long denseEvaluations  = 0;  // what buildGrid would have spent
+    long long total() const { return centreEvaluations + cornerEvaluations; }
+};
+
+// Coarse-to-fine alternative to buildGrid for (approximately) signed distance
+// fields. Blocks from 16 down to 2 cells are tested at their centre: when
+// |f| > safetyFactor * (block half-diagonal) the surface cannot cross the block
+// and its corners get a sign-only fill (the sign of f and a lower bound on |f|)
+// instead of samples. Every corner of a block the surface may cross is sampled
+// exactly, so dualContour produces the same mesh as from buildGrid, provided
+// the sign of f only changes across its zero set. That holds for a closed
+// mesh; an open mesh's pseudonormal sign also flips across sheets away from
+// the surface, which the fill smooths over. Use safetyFactor > 1 for fields
+// that only approximate the distance.
+DCGrid buildGridHierarchical(const ImplicitField& f, int N, float minBound=-1.f, float maxBound=1.f,
+                             int numThreads=0, float safetyFactor=1.f,
+                             SamplingStats* stats=nullptr);
+
+// Both passes run on numThreads threads (<= 0: one per hardware core). Vertex
+// numbering and triangle order are identical for every thread count.
+DCMesh dualContour(const ImplicitField& f, DCGrid& grid, int numThreads=0);
+
+// dualContour without its Hermite pass: contours grid.edges as already filled
+// (by buildHermiteEdges, or by scanConvertMesh without any field).
+DCMesh dualContourHermite(DCGrid& grid, int numThreads=0);
+
+// Adaptive dual contouring on an octree over the grid's cells. Blocks of
+// cells are collapsed into one vertex bottom-up while the merged QEF stays
+// within tolerance (RMS distance to the Hermite tangent planes, in world
+// units) and the collapse cannot change the surface topology; the octree is
+// then contoured by cell/face/edge recursion. A negative tolerance never
+// collapses and yields the uniform mesh. grid.vertexIndex maps each active
+// cell to the vertex of the octree leaf covering it.
+DCMesh dualContourAdaptive(const ImplicitField& f, DCGrid& grid, float tolerance,
+                           int numThreads=0);
+
+
+// ---- Building blocks shared by the contouring variants --------------------
+
+// EDGE_CORNERS[e]: the two corners (bit 0 = +x, bit 1 = +y, bit 2 = +z) of
+// cell edge e; edges 0-3 run along X, 4-7 along Y, 8-11 along Z.
+extern const int EDGE_CORNERS[12][2];
+// QUAD_CELLS[axis]: the four cells around an edge, as offsets from the edge's
+// lower corner, in quad winding order.
+extern const int QUAD_CELLS[3][4][3];
+
+// Pass 0 of dualContour: fill grid.edges with the Hermite data of every
+// sign-changing grid edge.
+void buildHermiteEdges(const ImplicitField& f, DCGrid& grid, int numThreads=0);
+
+// Crossing point (linear interpolation between corners p0/p1 with values
+// f0/f1 of opposite sign) and unit normal from the field gradient.
+HermiteSample edgeHermite(const ImplicitField& f,
+                          const Eigen::Vector3f& p0, const Eigen::Vector3f& p1,
+                          float f0, float f1);
+
+// Append the two triangles of the quad with cell vertices v (QUAD_CELLS order)
+// around an edge along axis, wound so the quad faces the direction of
+// increasing f (rising: f increases along +axis).
+void appendQuad(int v[4], int axis, bool rising, std::vector<std::array<int,3>>& out);
+
+// appendQuad for polygons whose cells may share a vertex (adaptive leaves):
+// repeated vertices are collapsed first, leaving a quad, a triangle or nothing.
+void appendPolygon(const int v[4], int axis, bool rising, std::vector<std::array<int,3>>& out);
+
+// Zero-area test used by removeDegenerateTriangles.
+bool isDegenerateTriangle(const std::vector<std::array<float,3>>& vertices, const std::array<int,3>& tri);
+
+// Drop zero-area triangles, keeping the order of the rest.
+void removeDegenerateTriangles(DCMesh& mesh, int numThreads=0);
+
+
+// ---- Fields known at compile time -------------------------------------------
+//
+// A lambda or functor passed to buildGrid / buildHermiteEdges / dualContour /
+// edgeHermite selects these templates, so the field is inlined into the
+// sampling, crossing and gradient loops instead of being called through
+// std::function. Stateful fields work the same way, e.g.
+//     dualContour([&](float x, float y, float z) { return mesh.distance(x, y, z); }, grid);
+// A Field that also has float operator()(x, y, z, Eigen::Vector3f& grad) const
+// supplies closed-form normals; otherwise they are central differences, as for
+// an ImplicitField without evalGrad. Plain ScalarFields keep converting to
+// ImplicitField (for their batch kernels), and the ImplicitField overloads
+// above are these templates instantiated for ImplicitField.
+
+// Flat index of corner (i,j,k) in DCGrid::values
+inline int gridCornerIndex(int i, int j, int k, int N) {
+    return i + (N+1)*j + (N+1)*(N+1)*k;
+}
+
+// Flat index of cell (ci,cj,ck) in DCGrid::vertexIndex
+inline int gridCellIndex(int ci, int cj, int ck, int N) {
+    return ci + N*cj + N*N*ck;
+}
+
+// A cell has a vertex iff its 8 corner signs are mixed. Cheaper than probing
+// the 12 edge slots, and it skips the vast majority of cells.
+inline bool cellHasSignChange(const std::vector<float>& values, int ci, int cj, int ck, int N) {
+    const bool inside = values[gridCornerIndex(ci, cj, ck, N)] < 0;
+    for (int c = 1; c < 8; ++c) {
+        const int idx = gridCornerIndex(ci + (c & 1), cj + ((c >> 1) & 1), ck + ((c >> 2) & 1), N);
+        if ((values[idx] < 0) != inside) return true;
+    }
+    return false;
+}
+
+template <class Field>
+using IfFieldObject = std::enable_if_t<
+    !std::is_function<std::remove_pointer_t<std::decay_t<Field>>>::value, int>;
+
+template <class Field, class = void>
+struct HasFieldGradient : std::false_type {};
+template <class Field>
+struct HasFieldGradient<Field, decltype(void(std::declval<const Field&>()(
+                                   0.f, 0.f, 0.f, std::declval<Eigen::Vector3f&>())))>
+    : std::true_type {};
+
+// out[i] = f(x[i], y[i], z[i]); an ImplicitField goes through its batch kernel.
+template <class Field>
+inline void evaluateField(const Field& f, const float* x, const float* y, const float* z,
+                          float* out, int n) {
+    for (int i = 0; i < n; ++i) out[i] = f(x[i], y[i], z[i]);
+}
+inline void evaluateField(const ImplicitField& f, const float* x, const float* y, const float* z,
+                          float* out, int n) {
+    f.evaluate(x, y, z, out, n);
+}
+
+template <class Field>
+inline Eigen::Vector3f fieldGradient(const Field& f, float x, float y, float z) {
+    if constexpr (HasFieldGradient<Field>::value) {
+        Eigen::Vector3f g;
+        f(x, y, z, g);
+        return g;
+    } else {
+        return centralDifference(f, x, y, z);
+    }
+}
+inline Eigen::Vector3f fieldGradient(const ImplicitField& f, float x, float y, float z) {
+    return gradient(f, x, y, z);
+}
+
+template <class Field, IfFieldObject<Field> = 0>
+DCGrid buildGrid(const Field& f, int N, float minBound=-1.f, float maxBound=1.f,
+                 int numThreads=0) {
+    DCGrid grid;
+    grid.N = N;
+    grid.minBound = minBound;
+    grid.maxBound = maxBound;
+    grid.cellSize = (maxBound - minBound) / N;
+    grid.values.resize((N+1) * (N+1) * (N+1));
+    grid.vertexIndex.resize(N * N * N, -1);
+
+    // Sample the scalar field at all corners, one z-slab per task. Each row is
+    // handed to the field as one SoA batch so SIMD kernels can be used.
+    // Every corner is written by exactly one slab, so the result does not
+    // depend on numThreads.
+    const float cellSize = grid.cellSize;
+    std::vector<float> xs(N + 1);
+    for (int i = 0; i <= N; ++i) xs[i] = minBound + i * cellSize;
+
+    parallelFor(0, N + 1, numThreads, [&](int k) {
+        std::vector<float> ys(N + 1), zs(N + 1, minBound + k * cellSize);
+        for (int j = 0; j <= N; ++j) {
+            std::fill(ys.begin(), ys.end(), minBound + j * cellSize);
+            evaluateField(f, xs.data(), ys.data(), zs.data(),
+                          &grid.values[gridCornerIndex(0, j, k, N)], N + 1);
+        }
+    });
+    return grid;
+}
+
+template <class Field, IfFieldObject<Field> = 0>
+HermiteSample edgeHermite(const Field& f,
+                          const Eigen::Vector3f& p0, const Eigen::Vector3f& p1,
+                          float f0, float f1) {
+    // Compute intersection point
+    float t = -f0 / (f1 - f0);
+    Eigen::Vector3f p = p0 + t * (p1 - p0);
+
+    // Compute normal via gradient
+    Eigen::Vector3f n = fieldGradient(f, p.x(), p.y(), p.z());
+    float len = n.norm();
+    if (len > 1e-6f) {
+        n /= len;
+    } else {
+        n = Eigen::Vector3f(1, 0, 0);  // Fallback
+    }
+    return {p, n};
+}
+
+// Pass 0: Hermite data for every sign-changing grid edge, computed once.
+// Each axis is scanned in (k, j, i) order, one z-slab per task; the slabs are
+// concatenated in order, so the edge lists do not depend on the thread count.
+template <class Field, IfFieldObject<Field> = 0>
+void buildHermiteEdges(const Field& f, DCGrid& grid, int numThreads=0) {
+    const int N = grid.N;
+    const float minBound = grid.minBound;
+    const float cellSize = grid.cellSize;
+    const int step[3] = {1, N+1, (N+1)*(N+1)};
+
+    for (int axis = 0; axis < 3; ++axis) {
+        auto& edges = grid.edges.edges[axis];
+        edges.clear();
+        const int ext[3] = {axis == 0 ? N : N+1, axis == 1 ? N : N+1, axis == 2 ? N : N+1};
+
+        parallelGather(ext[2], numThreads, edges, [&](int k, std::vector<HermiteEdge>& out) {
+            for (int j = 0; j < ext[1]; ++j) {
+                for (int i = 0; i < ext[0]; ++i) {
+                    const int idx = gridCornerIndex(i, j, k, N);
+                    const float f0 = grid.values[idx];
+                    const float f1 = grid.values[idx + step[axis]];
+                    if ((f0 < 0) == (f1 < 0)) continue;  // No sign change
+
+                    Eigen::Vector3f p0(minBound + i * cellSize,
+                                       minBound + j * cellSize,
+                                       minBound + k * cellSize);
+                    Eigen::Vector3f p1 = p0;
+                    p1[axis] = minBound + ((axis == 0 ? i : axis == 1 ? j : k) + 1) * cellSize;
+                    out.push_back({i, j, k, f1 > f0, edgeHermite<Field>(f, p0, p1, f0, f1)});
+                }
+            }
+        });
+    }
+    grid.edges.indexRows(N);
+}
 
+template <class Field, IfFieldObject<Field> = 0>
+DCMesh dualContour(const Field& f, DCGrid& grid, int numThreads=0) {
+    buildHermiteEdges<Field>(f, grid, numThreads);
+    return dualContourHermite(grid, numThreads);
+}
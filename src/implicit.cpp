@@ -1,15 +1,29 @@
 #include "implicit.h"
+#include <algorithm>
 #include <cmath>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DC_HAVE_SIMD 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define DC_HAVE_SIMD 1
+#endif
+
 // Convention: f < 0 = inside, f > 0 = outside. Zero level-set is the surface.
 
+// Shape parameters shared by the scalar and batch kernels.
+static const float kSphereRadius = 0.75f;
+static const float kBoxHalf[3]   = {0.6f, 0.45f, 0.5f};
+static const float kTorusMajor   = 0.6f;
+static const float kTorusMinor   = 0.25f;
+
 float implicitSphere(float x, float y, float z) {
-    float r = 0.75f;
-    return std::sqrt(x*x + y*y + z*z) - r;
+    return std::sqrt(x*x + y*y + z*z) - kSphereRadius;
 }
 
 float implicitBox(float x, float y, float z) {
-    const Eigen::Vector3f b(0.6f, 0.45f, 0.5f);
+    const Eigen::Vector3f b(kBoxHalf[0], kBoxHalf[1], kBoxHalf[2]);
     const Eigen::Vector3f p(std::abs(x), std::abs(y), std::abs(z));
     const Eigen::Vector3f q = p - b;
     const Eigen::Vector3f qMax = q.cwiseMax(Eigen::Vector3f::Zero());
@@ -19,17 +33,175 @@ float implicitBox(float x, float y, float z) {
 }
 
 float implicitTorus(float x, float y, float z) {
-    float R = 0.6f, r = 0.25f;
     // Torus in XZ-plane (major radius R, minor radius r)
-    float qx = std::sqrt(x*x + z*z) - R;
-    return std::sqrt(qx*qx + y*y) - r;
+    float qx = std::sqrt(x*x + z*z) - kTorusMajor;
+    return std::sqrt(qx*qx + y*y) - kTorusMinor;
+}
+
+// ---- Closed-form gradients -----------------------------------------------
+
+float implicitSphereGrad(float x, float y, float z, Eigen::Vector3f& grad) {
+    const float len = std::sqrt(x*x + y*y + z*z);
+    if (len > 0.0f) {
+        grad = Eigen::Vector3f(x, y, z) / len;
+    } else {
+        grad = Eigen::Vector3f::Zero();  // at the centre
+    }
+    return len - kSphereRadius;
+}
+
+float implicitBoxGrad(float x, float y, float z, Eigen::Vector3f& grad) {
+    const Eigen::Vector3f s(x < 0.0f ? -1.0f : 1.0f, y < 0.0f ? -1.0f : 1.0f, z < 0.0f ? -1.0f : 1.0f);
+    const Eigen::Vector3f q(std::abs(x) - kBoxHalf[0], std::abs(y) - kBoxHalf[1], std::abs(z) - kBoxHalf[2]);
+    const Eigen::Vector3f qMax = q.cwiseMax(Eigen::Vector3f::Zero());
+    const float outside = qMax.norm();
+    if (outside > 0.0f) {
+        // Outside: direction from the nearest box point
+        grad = s.cwiseProduct(qMax) / outside;
+        return outside;
+    }
+    // Inside (or on the surface): the face with the largest q is nearest;
+    // ties resolve in the same x, y, z order as the max() in implicitBox.
+    int axis = 2;
+    if (q.x() >= std::max(q.y(), q.z())) axis = 0;
+    else if (q.y() >= q.z())             axis = 1;
+    grad = Eigen::Vector3f::Zero();
+    grad[axis] = s[axis];
+    return q[axis];
+}
+
+float implicitTorusGrad(float x, float y, float z, Eigen::Vector3f& grad) {
+    const float rho = std::sqrt(x*x + z*z);
+    const float qx = rho - kTorusMajor;
+    const float d = std::sqrt(qx*qx + y*y);
+    if (d > 0.0f && rho > 0.0f) {
+        grad = Eigen::Vector3f(qx * x / rho, y, qx * z / rho) / d;
+    } else {
+        grad = Eigen::Vector3f::Zero();  // on the core circle or the axis
+    }
+    return d - kTorusMinor;
+}
+
+// ---- SIMD batch kernels ---------------------------------------------------
+// Thin wrappers so each kernel is written once for AVX2 (8 lanes) or SSE2
+// (4 lanes). The tail, and builds without either, use the scalar functions.
+#if defined(__AVX2__)
+using VecF = __m256;
+static const int kLanes = 8;
+static inline VecF vload(const float* p)     { return _mm256_loadu_ps(p); }
+static inline void vstore(float* p, VecF a)  { _mm256_storeu_ps(p, a); }
+static inline VecF vset1(float a)            { return _mm256_set1_ps(a); }
+static inline VecF vadd(VecF a, VecF b)      { return _mm256_add_ps(a, b); }
+static inline VecF vsub(VecF a, VecF b)      { return _mm256_sub_ps(a, b); }
+static inline VecF vmul(VecF a, VecF b)      { return _mm256_mul_ps(a, b); }
+static inline VecF vmax(VecF a, VecF b)      { return _mm256_max_ps(a, b); }
+static inline VecF vmin(VecF a, VecF b)      { return _mm256_min_ps(a, b); }
+static inline VecF vsqrt(VecF a)             { return _mm256_sqrt_ps(a); }
+static inline VecF vabs(VecF a)              { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+#elif defined(__SSE2__)
+using VecF = __m128;
+static const int kLanes = 4;
+static inline VecF vload(const float* p)     { return _mm_loadu_ps(p); }
+static inline void vstore(float* p, VecF a)  { _mm_storeu_ps(p, a); }
+static inline VecF vset1(float a)            { return _mm_set1_ps(a); }
+static inline VecF vadd(VecF a, VecF b)      { return _mm_add_ps(a, b); }
+static inline VecF vsub(VecF a, VecF b)      { return _mm_sub_ps(a, b); }
+static inline VecF vmul(VecF a, VecF b)      { return _mm_mul_ps(a, b); }
+static inline VecF vmax(VecF a, VecF b)      { return _mm_max_ps(a, b); }
+static inline VecF vmin(VecF a, VecF b)      { return _mm_min_ps(a, b); }
+static inline VecF vsqrt(VecF a)             { return _mm_sqrt_ps(a); }
+static inline VecF vabs(VecF a)              { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+#endif
+
+void implicitSphereBatch(const float* x, const float* y, const float* z, float* out, int n) {
+    int i = 0;
+#ifdef DC_HAVE_SIMD
+    const VecF r = vset1(kSphereRadius);
+    for (; i + kLanes <= n; i += kLanes) {
+        const VecF vx = vload(x + i), vy = vload(y + i), vz = vload(z + i);
+        const VecF len2 = vadd(vadd(vmul(vx, vx), vmul(vy, vy)), vmul(vz, vz));
+        vstore(out + i, vsub(vsqrt(len2), r));
+    }
+#endif
+    for (; i < n; ++i) out[i] = implicitSphere(x[i], y[i], z[i]);
+}
+
+void implicitBoxBatch(const float* x, const float* y, const float* z, float* out, int n) {
+    int i = 0;
+#ifdef DC_HAVE_SIMD
+    const VecF bx = vset1(kBoxHalf[0]), by = vset1(kBoxHalf[1]), bz = vset1(kBoxHalf[2]);
+    const VecF zero = vset1(0.0f);
+    for (; i + kLanes <= n; i += kLanes) {
+        const VecF qx = vsub(vabs(vload(x + i)), bx);
+        const VecF qy = vsub(vabs(vload(y + i)), by);
+        const VecF qz = vsub(vabs(vload(z + i)), bz);
+        const VecF mx = vmax(qx, zero), my = vmax(qy, zero), mz = vmax(qz, zero);
+        // Same summation order as Eigen's unrolled norm(): x² + (y² + z²)
+        const VecF outside = vsqrt(vadd(vmul(mx, mx), vadd(vmul(my, my), vmul(mz, mz))));
+        const VecF inside = vmin(vmax(qx, vmax(qy, qz)), zero);
+        vstore(out + i, vadd(outside, inside));
+    }
+#endif
+    for (; i < n; ++i) out[i] = implicitBox(x[i], y[i], z[i]);
+}
+
+void implicitTorusBatch(const float* x, const float* y, const float* z, float* out, int n) {
+    int i = 0;
+#ifdef DC_HAVE_SIMD
+    const VecF R = vset1(kTorusMajor), r = vset1(kTorusMinor);
+    for (; i + kLanes <= n; i += kLanes) {
+        const VecF vx = vload(x + i), vy = vload(y + i), vz = vload(z + i);
+        const VecF qx = vsub(vsqrt(vadd(vmul(vx, vx), vmul(vz, vz))), R);
+        vstore(out + i, vsub(vsqrt(vadd(vmul(qx, qx), vmul(vy, vy))), r));
+    }
+#endif
+    for (; i < n; ++i) out[i] = implicitTorus(x[i], y[i], z[i]);
+}
+
+// ---- ImplicitField --------------------------------------------------------
+
+ImplicitField::ImplicitField(ScalarField f) : eval(f) {
+    if (f == implicitSphere) {
+        evalBatch = implicitSphereBatch;
+        evalGrad  = implicitSphereGrad;
+    } else if (f == implicitBox) {
+        evalBatch = implicitBoxBatch;
+        evalGrad  = implicitBoxGrad;
+    } else if (f == implicitTorus) {
+        evalBatch = implicitTorusBatch;
+        evalGrad  = implicitTorusGrad;
+    }
+}
+
+ImplicitField::ImplicitField(ScalarField f, BatchScalarField batch, GradientField grad) : eval(f) {
+    if (batch) evalBatch = batch;
+    if (grad)  evalGrad  = grad;
+}
+
+void ImplicitField::evaluate(const float* x, const float* y, const float* z,
+                             float* out, int n) const {
+    if (evalBatch) {
+        evalBatch(x, y, z, out, n);
+        return;
+    }
+    for (int i = 0; i < n; ++i) out[i] = eval(x[i], y[i], z[i]);
 }
 
 Eigen::Vector3f gradient(ScalarField f, float x, float y, float z, float eps) {
-    float fx = f(x + eps, y, z) - f(x - eps, y, z);
-    float fy = f(x, y + eps, z) - f(x, y - eps, z);
-    float fz = f(x, y, z + eps) - f(x, y, z - eps);
-    Eigen::Vector3f g(fx, fy, fz);
-    return g / (2.0f * eps);
+    return centralDifference(f, x, y, z, eps);
 }
 
+Eigen::Vector3f gradient(const ImplicitField& f, float x, float y, float z, float eps) {
+    if (f.evalGrad) {
+        Eigen::Vector3f g;
+        f.evalGrad(x, y, z, g);
+        return g;
+    }
+    if (!f.evalBatch) return centralDifference(f, x, y, z, eps);
+    const float px[6] = {x + eps, x - eps, x, x, x, x};
+    const float py[6] = {y, y, y + eps, y - eps, y, y};
+    const float pz[6] = {z, z, z, z, z + eps, z - eps};
+    float v[6];
+    f.evalBatch(px, py, pz, v, 6);
+    return Eigen::Vector3f(v[0] - v[1], v[2] - v[3], v[4] - v[5]) / (2.0f * eps);
+}
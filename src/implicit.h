@@ -1,10 +1,62 @@
 #pragma once
 #include <Eigen/Core>
+#include <functional>
 
 using ScalarField = float(*)(float x, float y, float z);
 
+// Value plus closed-form gradient at one point: returns f(x,y,z), writes grad.
+using GradientField = float(*)(float x, float y, float z, Eigen::Vector3f& grad);
+
+// Batch evaluation over SoA coordinates: out[i] = f(x[i], y[i], z[i]) for i < n.
+using BatchScalarField = void(*)(const float* x, const float* y, const float* z,
+                                 float* out, int n);
+
+// A scalar field as consumed by buildGrid/dualContour: a point evaluator plus an
+// optional batch kernel and an optional value-and-gradient evaluator.
+// Constructing from a plain ScalarField is the adapter for the old
+// function-pointer API; the built-in analytic shapes also pick up their SIMD
+// batch kernels and closed-form gradients that way.
+struct ImplicitField {
+    std::function<float(float, float, float)> eval;
+    std::function<void(const float*, const float*, const float*, float*, int)> evalBatch;
+    std::function<float(float, float, float, Eigen::Vector3f&)> evalGrad;
+
+    ImplicitField() = default;
+    ImplicitField(ScalarField f);
+    ImplicitField(ScalarField f, BatchScalarField batch, GradientField grad = nullptr);
+
+    float operator()(float x, float y, float z) const { return eval(x, y, z); }
+
+    // Evaluate n points; falls back to a per-point loop when there is no batch kernel.
+    void evaluate(const float* x, const float* y, const float* z, float* out, int n) const;
+};
+
 float implicitSphere(float x, float y, float z);  // r=0.75
 float implicitBox   (float x, float y, float z);  // half-extents (0.6,0.45,0.5)
 float implicitTorus (float x, float y, float z);  // R=0.6, r=0.25 in XZ-plane
-Eigen::Vector3f gradient(ScalarField f, float x, float y, float z, float eps=1e-4f);
 
+// Vectorized (AVX2 / SSE2 / scalar fallback) batch versions of the shapes above.
+void implicitSphereBatch(const float* x, const float* y, const float* z, float* out, int n);
+void implicitBoxBatch   (const float* x, const float* y, const float* z, float* out, int n);
+void implicitTorusBatch (const float* x, const float* y, const float* z, float* out, int n);
+
+// Value and closed-form gradient of the shapes above (unit length wherever defined).
+float implicitSphereGrad(float x, float y, float z, Eigen::Vector3f& grad);
+float implicitBoxGrad   (float x, float y, float z, Eigen::Vector3f& grad);
+float implicitTorusGrad (float x, float y, float z, Eigen::Vector3f& grad);
+
+// Step of the central-difference gradients below
+inline constexpr float GRADIENT_EPS = 1e-4f;
+
+// Central-difference gradient of anything callable as f(x, y, z)
+template <class F>
+inline Eigen::Vector3f centralDifference(const F& f, float x, float y, float z, float eps=GRADIENT_EPS) {
+    return Eigen::Vector3f(f(x + eps, y, z) - f(x - eps, y, z),
+                           f(x, y + eps, z) - f(x, y - eps, z),
+                           f(x, y, z + eps) - f(x, y, z - eps)) / (2.0f * eps);
+}
+
+Eigen::Vector3f gradient(ScalarField f, float x, float y, float z, float eps=GRADIENT_EPS);
+// Uses the field's closed-form gradient when it has one (eps is then unused);
+// otherwise central differences, with the six taps in one batch call when available.
+Eigen::Vector3f gradient(const ImplicitField& f, float x, float y, float z, float eps=GRADIENT_EPS);
@@ -0,0 +1,266 @@
+#include "incremental.h"
+#include "parallel.h"
+#include "qef.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+static inline int64_t edgeKey(int axis, int corner) {
+    return axis + 3 * int64_t(corner);
+}
+
+void IncrementalDC::build(const ImplicitField& f, int N, float minBound, float maxBound, int numThreads) {
+    dcGrid = buildGrid(f, N, minBound, maxBound, numThreads);
+    dcMesh = dualContour(f, dcGrid, numThreads);
+
+    // Re-emit the quads edge by edge, in dualContour's order, so each
+    // triangle knows its edge
+    dcMesh.triangles.clear();
+    freeVertices.clear();
+    triangleEdge.clear();
+    edgeTriangles.clear();
+    for (int axis = 0; axis < 3; ++axis) {
+        for (const HermiteEdge& e : dcGrid.edges.edges[axis]) {
+            emitQuad(axis, e.i, e.j, e.k);
+        }
+    }
+}
+
+void IncrementalDC::emitQuad(int axis, int i, int j, int k) {
+    const int N = dcGrid.N;
+    const int slot = dcGrid.edges.find(axis, i, j, k);
+    if (slot < 0) return;
+    const int corner = gridCornerIndex(i, j, k, N);
+    const HermiteEdge& edge = dcGrid.edges.edges[axis][slot];
+    int v[4];
+    for (int c = 0; c < 4; ++c) {
+        const int ci = edge.i + QUAD_CELLS[axis][c][0];
+        const int cj = edge.j + QUAD_CELLS[axis][c][1];
+        const int ck = edge.k + QUAD_CELLS[axis][c][2];
+        if (ci < 0 || cj < 0 || ck < 0 || ci >= N || cj >= N || ck >= N) return;
+        v[c] = dcGrid.vertexIndex[gridCellIndex(ci, cj, ck, N)];
+        if (v[c] < 0) return;
+    }
+    std::vector<std::array<int,3>> quad;
+    appendQuad(v, axis, edge.rising, quad);
+
+    std::array<int,2> owned = {-1, -1};
+    int n = 0;
+    for (const auto& tri : quad) {
+        if (isDegenerateTriangle(dcMesh.vertices, tri)) continue;
+        owned[n++] = static_cast<int>(dcMesh.triangles.size());
+        dcMesh.triangles.push_back(tri);
+        triangleEdge.push_back(edgeKey(axis, corner));
+    }
+    if (n > 0) edgeTriangles[edgeKey(axis, corner)] = owned;
+}
+
+void IncrementalDC::removeQuad(int axis, int corner) {
+    auto it = edgeTriangles.find(edgeKey(axis, corner));
+    if (it == edgeTriangles.end()) return;
+    const std::array<int,2> owned = it->second;
+    edgeTriangles.erase(it);
+    // Higher slot first, so the lower one is not the moved triangle
+    for (int t : {std::max(owned[0], owned[1]), std::min(owned[0], owned[1])}) {
+        if (t < 0) continue;
+        const int last = static_cast<int>(dcMesh.triangles.size()) - 1;
+        if (t != last) {
+            dcMesh.triangles[t] = dcMesh.triangles[last];
+            triangleEdge[t] = triangleEdge[last];
+            std::array<int,2>& moved = edgeTriangles[triangleEdge[t]];
+            for (int& m : moved) {
+                if (m == last) m = t;
+            }
+        }
+        dcMesh.triangles.pop_back();
+        triangleEdge.pop_back();
+    }
+}
+
+// One cell's vertex after an update: solved position or none
+struct CellUpdate {
+    int cell;
+    bool active;
+    Eigen::Vector3f position;
+};
+
+DCUpdateStats IncrementalDC::update(const ImplicitField& f, const Eigen::Vector3f& lo,
+                                    const Eigen::Vector3f& hi, int numThreads) {
+    DCUpdateStats stats;
+    DCGrid& grid = dcGrid;
+    const int N = grid.N;
+    const float minBound = grid.minBound;
+    const float cellSize = grid.cellSize;
+    if (N <= 0) return stats;
+
+    // Corners of every cell the box overlaps
+    int c0[3], c1[3];
+    for (int a = 0; a < 3; ++a) {
+        if (hi[a] < grid.minBound || lo[a] > grid.maxBound || lo[a] > hi[a]) return stats;
+        c0[a] = std::max(0, static_cast<int>(std::floor((lo[a] - minBound) / cellSize)));
+        c1[a] = std::min(N, static_cast<int>(std::ceil((hi[a] - minBound) / cellSize)));
+    }
+
+    // 1. Re-sample those corners, a row at a time
+    const int rowLength = c1[0] - c0[0] + 1;
+    std::vector<float> xs(rowLength);
+    for (int i = 0; i < rowLength; ++i) xs[i] = minBound + (c0[0] + i) * cellSize;
+    parallelFor(c0[2], c1[2] + 1, numThreads, [&](int k) {
+        std::vector<float> ys(rowLength), zs(rowLength, minBound + k * cellSize);
+        for (int j = c0[1]; j <= c1[1]; ++j) {
+            std::fill(ys.begin(), ys.end(), minBound + j * cellSize);
+            f.evaluate(xs.data(), ys.data(), zs.data(),
+                       &grid.values[gridCornerIndex(c0[0], j, k, N)], rowLength);
+        }
+    });
+    stats.corners = static_cast<long long>(rowLength) * (c1[1] - c0[1] + 1) * (c1[2] - c0[2] + 1);
+
+    // 2. Edges with an endpoint among them: new Hermite data in parallel, then
+    // spliced into the edge store in place of the old ones, keeping scan order
+    const int step[3] = {1, N+1, (N+1)*(N+1)};
+    for (int axis = 0; axis < 3; ++axis) {
+        int e0[3], e1[3];
+        for (int a = 0; a < 3; ++a) {
+            e0[a] = a == axis ? std::max(c0[a] - 1, 0) : c0[a];
+            e1[a] = a == axis ? std::min(c1[a], N - 1) : c1[a];
+        }
+        if (e0[axis] > e1[axis]) continue;
+        stats.edges += static_cast<long long>(e1[0] - e0[0] + 1) * (e1[1] - e0[1] + 1) * (e1[2] - e0[2] + 1);
+
+        std::vector<HermiteEdge> crossings;
+        parallelGather(e1[2] - e0[2] + 1, numThreads, crossings, [&](int dk, std::vector<HermiteEdge>& out) {
+            const int k = e0[2] + dk;
+            for (int j = e0[1]; j <= e1[1]; ++j) {
+                for (int i = e0[0]; i <= e1[0]; ++i) {
+                    const int idx = gridCornerIndex(i, j, k, N);
+                    const float v0 = grid.values[idx];
+                    const float v1 = grid.values[idx + step[axis]];
+                    if ((v0 < 0) == (v1 < 0)) continue;
+
+                    // Same arithmetic as buildHermiteEdges
+                    Eigen::Vector3f p0(minBound + i * cellSize,
+                                       minBound + j * cellSize,
+                                       minBound + k * cellSize);
+                    Eigen::Vector3f p1 = p0;
+                    p1[axis] = minBound + ((axis == 0 ? i : axis == 1 ? j : k) + 1) * cellSize;
+                    out.push_back({i, j, k, v1 > v0, edgeHermite(f, p0, p1, v0, v1)});
+                }
+            }
+        });
+
+        // The region's rows all lie between its first and last row, so only
+        // that span of the store is rewritten; later rows shift by the change
+        // in its length. crossings are in scan order, as the store is.
+        auto& edges = grid.edges.edges[axis];
+        auto& rowStart = grid.edges.rowStart[axis];
+        const int firstRow = e0[1] + (N+1) * e0[2], lastRow = e1[1] + (N+1) * e1[2];
+        const int spanBegin = rowStart[firstRow], spanEnd = rowStart[lastRow + 1];
+        std::vector<HermiteEdge> span;
+        span.reserve(spanEnd - spanBegin + crossings.size());
+        size_t next = 0;
+        int oldBegin = spanBegin;
+        for (int row = firstRow; row <= lastRow; ++row) {
+            const int oldEnd = rowStart[row + 1];
+            const int j = row % (N+1);
+            rowStart[row] = spanBegin + static_cast<int>(span.size());
+            if (j < e0[1] || j > e1[1]) {
+                span.insert(span.end(), edges.begin() + oldBegin, edges.begin() + oldEnd);
+            } else {
+                const int k = row / (N+1);
+                int e = oldBegin;
+                for (; e < oldEnd && edges[e].i < e0[0]; ++e) span.push_back(edges[e]);
+                for (; next < crossings.size() && crossings[next].j == j && crossings[next].k == k; ++next) {
+                    span.push_back(crossings[next]);
+                }
+                while (e < oldEnd && edges[e].i <= e1[0]) ++e;
+                for (; e < oldEnd; ++e) span.push_back(edges[e]);
+            }
+            oldBegin = oldEnd;
+        }
+        const int shift = static_cast<int>(span.size()) - (spanEnd - spanBegin);
+        for (size_t row = lastRow + 1; row < rowStart.size(); ++row) rowStart[row] += shift;
+        edges.erase(edges.begin() + spanBegin, edges.begin() + spanEnd);
+        edges.insert(edges.begin() + spanBegin, span.begin(), span.end());
+    }
+
+    // 3. Cells around those edges re-solve their vertex; the edge store is
+    // read in dualContourHermite's order so positions come out identical
+    int r0[3], r1[3];
+    for (int a = 0; a < 3; ++a) {
+        r0[a] = std::max(c0[a] - 1, 0);
+        r1[a] = std::min(c1[a], N - 1);
+        if (r0[a] > r1[a]) return stats;
+    }
+    std::vector<CellUpdate> cells;
+    parallelGather(r1[2] - r0[2] + 1, numThreads, cells, [&](int dk, std::vector<CellUpdate>& out) {
+        const int ck = r0[2] + dk;
+        for (int cj = r0[1]; cj <= r1[1]; ++cj) {
+            for (int ci = r0[0]; ci <= r1[0]; ++ci) {
+                CellUpdate cell = {gridCellIndex(ci, cj, ck, N), false, Eigen::Vector3f::Zero()};
+                if (cellHasSignChange(grid.values, ci, cj, ck, N)) {
+                    QEF qef;
+                    for (int e = 0; e < 12; ++e) {
+                        const int axis = e / 4;
+                        const int c = EDGE_CORNERS[e][0];
+                        const int slot = grid.edges.find(axis, ci + (c & 1), cj + ((c >> 1) & 1),
+                                                         ck + ((c >> 2) & 1));
+                        if (slot >= 0) qef.add(grid.edges.edges[axis][slot].hermite);
+                    }
+                    if (qef.count > 0) {
+                        const Eigen::Vector3f cellMin(minBound + ci * cellSize,
+                                                      minBound + cj * cellSize,
+                                                      minBound + ck * cellSize);
+                        const Eigen::Vector3f cellMax(minBound + (ci+1) * cellSize,
+                                                      minBound + (cj+1) * cellSize,
+                                                      minBound + (ck+1) * cellSize);
+                        cell.active = true;
+                        cell.position = qef.solve(cellMin, cellMax);
+                    }
+                }
+                out.push_back(cell);
+            }
+        }
+    });
+    stats.cells = static_cast<long long>(cells.size());
+
+    // 4. Drop the quads around those cells, place the vertices (keeping
+    // indices, reusing freed slots), then emit the quads again
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int k = r0[2]; k <= (axis == 2 ? r1[2] : std::min(r1[2] + 1, N)); ++k)
+            for (int j = r0[1]; j <= (axis == 1 ? r1[1] : std::min(r1[1] + 1, N)); ++j)
+                for (int i = r0[0]; i <= (axis == 0 ? r1[0] : std::min(r1[0] + 1, N)); ++i)
+                    removeQuad(axis, gridCornerIndex(i, j, k, N));
+    }
+    // Freed slots first, so a cell that moves within the region can reuse one
+    for (const CellUpdate& cell : cells) {
+        int& v = grid.vertexIndex[cell.cell];
+        if (!cell.active && v >= 0) {
+            freeVertices.push_back(v);
+            v = -1;
+        }
+    }
+    std::sort(freeVertices.begin(), freeVertices.end(), std::greater<int>());
+    for (const CellUpdate& cell : cells) {
+        if (!cell.active) continue;
+        int& v = grid.vertexIndex[cell.cell];
+        if (v < 0) {
+            if (!freeVertices.empty()) {
+                v = freeVertices.back();
+                freeVertices.pop_back();
+            } else {
+                v = static_cast<int>(dcMesh.vertices.size());
+                dcMesh.vertices.push_back({});
+            }
+        }
+        dcMesh.vertices[v] = {cell.position.x(), cell.position.y(), cell.position.z()};
+    }
+    const size_t before = dcMesh.triangles.size();
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int k = r0[2]; k <= (axis == 2 ? r1[2] : std::min(r1[2] + 1, N)); ++k)
+            for (int j = r0[1]; j <= (axis == 1 ? r1[1] : std::min(r1[1] + 1, N)); ++j)
+                for (int i = r0[0]; i <= (axis == 0 ? r1[0] : std::min(r1[0] + 1, N)); ++i)
+                    emitQuad(axis, i, j, k);
+    }
+    stats.triangles = static_cast<long long>(dcMesh.triangles.size() - before);
+    return stats;
+}
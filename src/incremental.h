@@ -0,0 +1,57 @@
+#pragma once
+#include "dual_contour.h"
+#include <Eigen/Core>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Work done by one IncrementalDC::update.
+struct DCUpdateStats {
+    long long corners = 0;    // corners re-sampled
+    long long edges = 0;      // grid edges whose crossing was redone
+    long long cells = 0;      // cells whose vertex was re-solved
+    long long triangles = 0;  // triangles re-emitted
+};
+
+// A DCGrid and its DCMesh kept in step with a field that changes locally (a
+// moved primitive, a brush stamp). After build(), update() is given the box
+// the edit touched and redoes only what depends on it: the corners of the
+// cells the box overlaps are re-sampled, the edges at those corners get new
+// Hermite data, the cells around those edges re-solve their QEF, and the
+// quads around those cells are re-emitted. The work scales with the edit, not
+// with N^3.
+//
+// Vertex indices are stable: a cell that keeps its vertex keeps its index,
+// and a vertex that disappears leaves its slot unreferenced until a new
+// vertex takes it. Triangles of untouched edges keep their vertices but may
+// move within mesh().triangles, as removed ones are back-filled from the end.
+// Otherwise grid and mesh are what buildGrid + dualContour would produce for
+// the edited field; grid().edges stays in scan order.
+class IncrementalDC {
+public:
+    // buildGrid + dualContour, keeping track of which edge owns which triangle.
+    void build(const ImplicitField& f, int N, float minBound=-1.f, float maxBound=1.f,
+               int numThreads=0);
+
+    // f differs from the field of the last build/update only inside [lo, hi].
+    DCUpdateStats update(const ImplicitField& f, const Eigen::Vector3f& lo, const Eigen::Vector3f& hi,
+                         int numThreads=0);
+
+    const DCGrid& grid() const { return dcGrid; }
+    const DCMesh& mesh() const { return dcMesh; }
+    // Vertex slots no triangle refers to.
+    size_t freeVertexCount() const { return freeVertices.size(); }
+
+private:
+    void emitQuad(int axis, int i, int j, int k);
+    void removeQuad(int axis, int corner);
+
+    DCGrid dcGrid;
+    DCMesh dcMesh;
+    std::vector<int> freeVertices;
+    // Owner of each triangle as axis + 3 * corner index of its edge, and the
+    // (up to two) triangles of each edge with a quad
+    std::vector<int64_t> triangleEdge;
+    std::unordered_map<int64_t, std::array<int,2>> edgeTriangles;
+};
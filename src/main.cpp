@@ -1,10 +1,21 @@
 #include "dual_contour.h"
 #include "mesh_sdf.h"
+#include "mapped_file.h"
+#include "mesh_scan.h"
+#include "sdf_volume.h"
 #include "implicit.h"
+#include "incremental.h"
+#include "build_worker.h"
+#include "resolution_cache.h"
 #include <polyscope/polyscope.h>
 #include <polyscope/surface_mesh.h>
 #include <imgui.h>
+#include <algorithm>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 // Global state
 static int g_resolution = 32;
@@ -16,29 +27,106 @@ static const char* g_shapeNames[] = { "Sphere", "Box", "Torus", "Teapot", "Gear"
 static const char* g_meshPaths[]  = { nullptr, nullptr, nullptr,
                                       DATA_DIR "/teapot.obj",
                                       DATA_DIR "/GEAR.obj" };
-static int g_loadedMeshIdx = -1;  // which mesh-based shape is currently loaded
+// Loaded mesh shapes, so switching back is instant; their .meshbin files in
+// the user cache directory also speed up the next session's first load
+static MeshSDFCache g_meshCache(4, userCacheDirectory());
+static bool g_useSDFCache = false;     // sample mesh shapes from a baked SDF volume
+static bool g_scanConvert = false;     // mesh shapes: Hermite data straight from the triangles
+static bool g_windingSign = false;     // mesh shapes: winding-number inside/outside (open meshes)
+static bool g_skipEmptySpace = false;  // coarse-to-fine sampling (buildGridHierarchical)
+static SamplingStats g_samplingStats;
+static bool g_adaptive = false;        // octree simplification (dualContourAdaptive)
+static float g_tolerance = 1e-3f;
 
-static DCGrid g_grid;
 static DCMesh g_mesh;
 
-void rebuildMesh() {
-    // If this shape needs a mesh SDF, reload the OBJ only when the selection changed.
-    if (g_meshPaths[g_shapeIdx] != nullptr && g_loadedMeshIdx != g_shapeIdx) {
-        if (!loadMeshSDF(g_meshPaths[g_shapeIdx])) {
-            std::cerr << "Warning: Failed to load " << g_meshPaths[g_shapeIdx] << std::endl;
-        }
-        g_loadedMeshIdx = g_shapeIdx;
+// Brush: each stamp pushes the surface out (or in, for a negative depth)
+// within its radius, on top of the selected shape
+struct BrushStamp {
+    Eigen::Vector3f centre;
+    float radius, depth;
+};
+static std::vector<BrushStamp> g_stamps;
+static float g_brushCentre[3] = {0.0f, 0.75f, 0.0f};
+static float g_brushRadius = 0.15f;
+static float g_brushDepth = 0.05f;
+static ImplicitField g_baseField;      // the shape's field without the stamps
+static std::shared_ptr<IncrementalDC> g_editor;  // uniform grid + mesh that stamps update in place,
+                                                 // when g_mesh came from it
+
+// Everything a rebuild depends on, copied from the UI when it is requested
+struct RebuildSettings {
+    int resolution, shapeIdx;
+    bool useSDFCache, scanConvert, windingSign, skipEmptySpace, adaptive;
+    float tolerance;
+    std::vector<BrushStamp> stamps;
+};
+
+// A mesh built on the worker, waiting to be shown
+struct RebuildResult {
+    long long generation;
+    bool preview;
+    DCMesh mesh;
+    SamplingStats samplingStats;
+    ResolutionCacheStats cacheStats;
+    ImplicitField baseField;
+    std::shared_ptr<IncrementalDC> editor;
+};
+
+// Rebuilds run on g_worker; only the worker touches these
+static int g_cachedMeshIdx = -1;           // which mesh-based shape the volume holds
+static ResolutionCache g_resolutionCache;  // samples and meshes by shape and resolution
+
+// Finished meshes are handed back through g_finished, and only the newest
+// request's are shown
+static std::mutex g_finishedMutex;
+static std::unique_ptr<RebuildResult> g_finished;
+static long long g_generation = 0;
+static std::shared_ptr<const BuildProgress> g_progress;
+static bool g_building = false;
+static std::string g_buildError;  // why the last rebuild failed, if it did
+static bool g_showingPreview = false;
+static ResolutionCacheStats g_cacheStats;
+static BuildWorker g_worker;  // after the state its jobs use, so it stops first
+
+// Total depression of the stamps at p; adds its gradient to *grad if given.
+// Each stamp subtracts depth * w^2 with w = max(1 - |p - c|^2 / r^2, 0).
+static float stampOffset(const std::vector<BrushStamp>& stamps, const Eigen::Vector3f& p,
+                         Eigen::Vector3f* grad = nullptr) {
+    float offset = 0.0f;
+    for (const BrushStamp& s : stamps) {
+        const float d2 = (p - s.centre).squaredNorm() / (s.radius * s.radius);
+        const float w = std::max(1.0f - d2, 0.0f);
+        offset += s.depth * w * w;
+        if (grad && w > 0.0f) *grad += (4.0f * s.depth * w / (s.radius * s.radius)) * (p - s.centre);
     }
+    return offset;
+}
 
-    ScalarField f = g_shapes[g_shapeIdx];
+// f minus the stamps, keeping f's batch kernel and closed-form gradient so a
+// stamped mesh shape still samples in batches and takes one query per normal
+static ImplicitField withStamps(const ImplicitField& f, const std::vector<BrushStamp>& stamps) {
+    if (stamps.empty()) return f;
+    ImplicitField stamped;
+    stamped.eval = [f, stamps](float x, float y, float z) {
+        return f(x, y, z) - stampOffset(stamps, Eigen::Vector3f(x, y, z));
+    };
+    if (f.evalBatch) {
+        stamped.evalBatch = [f, stamps](const float* x, const float* y, const float* z, float* out, int n) {
+            f.evalBatch(x, y, z, out, n);
+            for (int i = 0; i < n; ++i) out[i] -= stampOffset(stamps, Eigen::Vector3f(x[i], y[i], z[i]));
+        };
+    }
+    if (f.evalGrad) {
+        stamped.evalGrad = [f, stamps](float x, float y, float z, Eigen::Vector3f& grad) {
+            const float v = f.evalGrad(x, y, z, grad);
+            return v - stampOffset(stamps, Eigen::Vector3f(x, y, z), &grad);
+        };
+    }
+    return stamped;
+}
 
-    // Build grid
-    g_grid = buildGrid(f, g_resolution);
-    
-    // Run dual contouring
-    g_mesh = dualContour(f, g_grid);
-    
-    // Update Polyscope
+static void showMesh() {
     if (polyscope::hasSurfaceMesh("mesh")) {
         polyscope::removeSurfaceMesh("mesh");
     }
@@ -48,7 +136,151 @@ void rebuildMesh() {
     }
 }
 
+// Runs on the worker: the mesh for s at resolution N. Every field goes
+// through monitoredField, so a newer request stops it within a sample.
+static RebuildResult buildMesh(const RebuildSettings& s, int N, BuildProgress& progress) {
+    progress.beginStage(static_cast<long long>(N + 1) * (N + 1) * (N + 1));
+
+    // With the cache on, map the shape's baked volume (baking it on first use).
+    const bool cached = s.useSDFCache && g_meshPaths[s.shapeIdx] != nullptr;
+    if (cached && g_cachedMeshIdx != s.shapeIdx) {
+        const std::string path = g_meshPaths[s.shapeIdx];
+        if (!loadCachedMeshSDF(path, path + ".sdfv")) {
+            std::cerr << "Warning: Failed to load the SDF cache for " << path << std::endl;
+        }
+        g_cachedMeshIdx = s.shapeIdx;
+    }
+
+    // Mesh shapes go through the baked volume, an exact MeshSDF instance, or
+    // scan conversion of its triangles (no field at all, uniform contouring)
+    ImplicitField f(g_shapes[s.shapeIdx]);
+    std::shared_ptr<const MeshSDF> scanned;
+    if (cached) {
+        f = ImplicitField(implicitCachedMeshSDF);
+    } else if (g_meshPaths[s.shapeIdx] != nullptr) {
+        const MeshSign sign = s.windingSign ? MeshSign::WindingNumber : MeshSign::Pseudonormal;
+        std::shared_ptr<const MeshSDF> mesh = g_meshCache.get(g_meshPaths[s.shapeIdx], sign);
+        if (mesh && s.scanConvert) {
+            scanned = mesh;
+        } else if (mesh) {
+            f = meshSDFField(mesh);
+        } else {
+            std::cerr << "Warning: Failed to load " << g_meshPaths[s.shapeIdx] << std::endl;
+        }
+    }
+    progress.checkpoint();
+
+    RebuildResult result;
+    result.baseField = f;
+    if (scanned) {
+        DCGrid grid = scanConvertMesh(scanned->surface(), N);
+        progress.checkpoint();
+        result.mesh = dualContourHermite(grid);
+    } else {
+        // Build grid
+        const ImplicitField edited = monitoredField(withStamps(f, s.stamps), progress);
+        const bool winding = s.windingSign && g_meshPaths[s.shapeIdx] != nullptr && !cached;
+        DCGrid grid;
+        bool contoured = false;
+        if (s.skipEmptySpace) {
+            grid = buildGridHierarchical(edited, N, -1.f, 1.f, 0, 1.f, &result.samplingStats);
+        } else if (!s.adaptive && s.stamps.empty()) {
+            // Plain uniform contouring: moving the resolution slider reuses
+            // the samples of earlier resolutions, and revisits are instant
+            const std::string key = std::string(g_shapeNames[s.shapeIdx]) + (cached ? "/volume" : "") +
+                                    (winding ? "/winding" : "");
+            result.mesh = *g_resolutionCache.mesh(key, edited, N);
+            contoured = true;
+        } else if (!s.adaptive) {
+            // With stamps it goes through the editor, so further stamps only
+            // redo the region they touch
+            result.editor = std::make_shared<IncrementalDC>();
+            result.editor->build(edited, N);
+            result.mesh = result.editor->mesh();
+            contoured = true;
+        } else {
+            grid = buildGrid(edited, N);
+        }
+
+        // Run dual contouring
+        if (!contoured) {
+            result.mesh = s.adaptive ? dualContourAdaptive(edited, grid, s.tolerance) : dualContour(edited, grid);
+        }
+    }
+    result.cacheStats = g_resolutionCache.stats();
+    return result;
+}
+
+// Hand a finished mesh to the main thread
+static void publish(RebuildResult result, long long generation, bool preview) {
+    result.generation = generation;
+    result.preview = preview;
+    std::lock_guard<std::mutex> lock(g_finishedMutex);
+    g_finished = std::make_unique<RebuildResult>(std::move(result));
+}
+
+// Start rebuilding on the worker with the current settings, cancelling any
+// rebuild still running. Large resolutions first show a preview at N/4: for
+// plain contouring its corners are a quarter-resolution sub-lattice of the
+// final grid, so the resolution cache reuses them rather than resampling.
+void rebuildMesh() {
+    const RebuildSettings settings = {g_resolution, g_shapeIdx, g_useSDFCache, g_scanConvert, g_windingSign,
+                                      g_skipEmptySpace, g_adaptive, g_tolerance, g_stamps};
+    const long long generation = ++g_generation;
+    g_editor.reset();
+    g_building = true;
+    g_buildError.clear();
+    g_progress = g_worker.submit([settings, generation](BuildProgress& progress) {
+        const int previewN = settings.resolution / 4;
+        if (previewN >= 16) {
+            publish(buildMesh(settings, previewN, progress), generation, true);
+        }
+        publish(buildMesh(settings, settings.resolution, progress), generation, false);
+    });
+}
+
+// Show the worker's latest mesh, if it belongs to the newest request
+static void collectRebuild() {
+    std::unique_ptr<RebuildResult> result;
+    {
+        std::lock_guard<std::mutex> lock(g_finishedMutex);
+        result = std::move(g_finished);
+    }
+    if (g_building && g_progress->failed()) {
+        g_building = false;
+        g_buildError = g_progress->error();
+    }
+    if (!result || result->generation != g_generation) return;
+
+    g_mesh = std::move(result->mesh);
+    g_samplingStats = result->samplingStats;
+    g_cacheStats = result->cacheStats;
+    g_showingPreview = result->preview;
+    if (!result->preview) {
+        g_baseField = result->baseField;
+        g_editor = result->editor;
+        g_building = false;
+    }
+    showMesh();
+}
+
+// Add a stamp at the brush and update the mesh in place when it came from
+// the editor, otherwise rebuild
+static void stampBrush() {
+    const Eigen::Vector3f centre(g_brushCentre[0], g_brushCentre[1], g_brushCentre[2]);
+    g_stamps.push_back({centre, g_brushRadius, g_brushDepth});
+    if (!g_editor) {
+        rebuildMesh();
+        return;
+    }
+    const Eigen::Vector3f reach = Eigen::Vector3f::Constant(g_brushRadius);
+    g_editor->update(withStamps(g_baseField, g_stamps), centre - reach, centre + reach);
+    g_mesh = g_editor->mesh();
+    showMesh();
+}
+
 void myCallback() {
+    collectRebuild();
     ImGui::PushItemWidth(200);
     
     bool changed = false;
@@ -62,13 +294,68 @@ void myCallback() {
     
     // Shape combo
     if (ImGui::Combo("Shape", &g_shapeIdx, g_shapeNames, 5)) {
+        g_stamps.clear();
+        changed = true;
+    }
+
+    if (ImGui::Checkbox("SDF cache", &g_useSDFCache)) {
+        changed = true;
+    }
+
+    if (ImGui::Checkbox("Scan convert mesh", &g_scanConvert)) {
+        changed = true;
+    }
+
+    if (ImGui::Checkbox("Winding number sign", &g_windingSign)) {
+        changed = true;
+    }
+
+    if (ImGui::Checkbox("Skip empty space", &g_skipEmptySpace)) {
+        changed = true;
+    }
+
+    if (ImGui::Checkbox("Adaptive", &g_adaptive)) {
+        changed = true;
+    }
+    if (g_adaptive &&
+        ImGui::SliderFloat("Tolerance", &g_tolerance, 1e-5f, 1e-2f, "%.5f", ImGuiSliderFlags_Logarithmic)) {
         changed = true;
     }
     
+    // Brush
+    ImGui::Separator();
+    ImGui::SliderFloat3("Brush centre", g_brushCentre, -1.0f, 1.0f);
+    ImGui::SliderFloat("Brush radius", &g_brushRadius, 0.02f, 0.5f);
+    ImGui::SliderFloat("Brush depth", &g_brushDepth, -0.2f, 0.2f);
+    if (ImGui::Button("Stamp")) {
+        stampBrush();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Clear stamps") && !g_stamps.empty()) {
+        g_stamps.clear();
+        changed = true;
+    }
+
     // Stats
     ImGui::Separator();
     ImGui::Text("Vertices: %zu", g_mesh.vertices.size());
     ImGui::Text("Triangles: %zu", g_mesh.triangles.size());
+    if (g_samplingStats.denseEvaluations > 0) {
+        ImGui::Text("Field evaluations: %lld / %lld",
+                    g_samplingStats.total(), g_samplingStats.denseEvaluations);
+    }
+    if (g_cacheStats.meshHits + g_cacheStats.meshMisses > 0) {
+        ImGui::Text("Resolution cache: %.0f%% hits, %.0f%% corners reused, %.1f MB",
+                    100.0 * g_cacheStats.meshHitRate(), 100.0 * g_cacheStats.cornerReuseRate(),
+                    (g_cacheStats.latticeBytes + g_cacheStats.meshBytes) / (1024.0 * 1024.0));
+    }
+    if (g_building) {
+        ImGui::ProgressBar(g_progress->fraction(), ImVec2(200, 0),
+                           g_showingPreview ? "Refining preview" : "Building");
+    }
+    if (!g_buildError.empty()) {
+        ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Build failed: %s", g_buildError.c_str());
+    }
     
     if (changed) {
         rebuildMesh();
@@ -0,0 +1,108 @@
+#include "mapped_file.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#include <memory>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::open(const std::string& path) {
+    close();
+#ifdef _WIN32
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    const size_t size = static_cast<size_t>(in.tellg());
+    if (size == 0) return false;
+    std::unique_ptr<char[]> buffer(new char[size]);
+    in.seekg(0);
+    if (!in.read(buffer.get(), size)) return false;
+    bytes = buffer.release();
+    length = size;
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    void* view = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (view == MAP_FAILED) return false;
+    bytes = static_cast<const char*>(view);
+    length = static_cast<size_t>(st.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes) {
+#ifdef _WIN32
+        delete[] bytes;
+#else
+        munmap(const_cast<char*>(bytes), length);
+#endif
+    }
+    bytes = nullptr;
+    length = 0;
+}
+
+uint64_t hashFileContents(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return 0;
+    uint64_t hash = 1469598103934665603ull;
+    char buffer[1 << 16];
+    while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+        for (std::streamsize i = 0; i < in.gcount(); ++i) {
+            hash ^= static_cast<unsigned char>(buffer[i]);
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+std::string temporaryPathFor(const std::string& path) {
+    static std::atomic<unsigned> counter(0);
+#ifdef _WIN32
+    const long pid = _getpid();
+#else
+    const long pid = getpid();
+#endif
+    return path + ".tmp" + std::to_string(pid) + "." + std::to_string(counter++);
+}
+
+bool replaceFile(const std::string& tmp, const std::string& path) {
+#ifdef _WIN32
+    // rename does not replace an existing file there
+    std::remove(path.c_str());
+#endif
+    if (std::rename(tmp.c_str(), path.c_str()) == 0) return true;
+    std::remove(tmp.c_str());
+    return false;
+}
+
+std::string userCacheDirectory() {
+#ifdef _WIN32
+    const char* local = std::getenv("LOCALAPPDATA");
+    return local && *local ? std::string(local) + "\\dualcontour" : std::string();
+#else
+    const char* xdg = std::getenv("XDG_CACHE_HOME");
+    if (xdg && *xdg) return std::string(xdg) + "/dualcontour";
+    const char* home = std::getenv("HOME");
+    return home && *home ? std::string(home) + "/.cache/dualcontour" : std::string();
+#endif
+}
+
+bool createDirectories(const std::string& dir) {
+    std::error_code error;
+    std::filesystem::create_directories(dir, error);
+    return std::filesystem::is_directory(dir, error);
+}
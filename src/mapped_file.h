@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only view of a whole file: mmap'd where available, otherwise (_WIN32)
+// read into a heap buffer.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Returns false if the file is missing, empty or cannot be mapped.
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return bytes != nullptr; }
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+};
+
+// FNV-1a hash of a file's bytes, used to key caches to their source file.
+// Returns 0 if the file cannot be read.
+uint64_t hashFileContents(const std::string& path);
+
+// Cache files are written to a temporary beside their final path and renamed
+// over it, so a reader never maps a half-written file and concurrent writers
+// of one cache never interleave. temporaryPathFor returns a path next to path
+// that is unique to this process and call.
+std::string temporaryPathFor(const std::string& path);
+
+// Move tmp to path, replacing any existing file (atomically on POSIX). On
+// failure tmp is removed and false returned.
+bool replaceFile(const std::string& tmp, const std::string& path);
+
+// Where the app keeps its caches (e.g. .meshbin files): $XDG_CACHE_HOME/dualcontour,
+// else $HOME/.cache/dualcontour (%LOCALAPPDATA%\dualcontour on Windows). Empty if
+// none of those variables is set. The directory may not exist yet.
+std::string userCacheDirectory();
+
+// Create dir and any missing parents. Returns true if it exists afterwards.
+bool createDirectories(const std::string& dir);
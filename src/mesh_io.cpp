@@ -0,0 +1,314 @@
+#include "mesh_io.h"
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+// Width of the patched element counts in the header
+static const int COUNT_WIDTH = 12;
+
+// PLY (and binary STL) store 4-byte floats and ints little-endian. On a
+// little-endian host that is the in-memory layout and records are copied
+// as they are; elsewhere every word is byte-swapped on the way out.
+static bool isLittleEndianHost() {
+    const uint32_t one = 1;
+    unsigned char first;
+    std::memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+// Copy count 4-byte words (float or int32) from src to dst in file byte order.
+static void copyLittleEndian32(void* dst, const void* src, size_t count) {
+    std::memcpy(dst, src, count * 4);
+    if (isLittleEndianHost()) return;
+    unsigned char* bytes = static_cast<unsigned char*>(dst);
+    for (size_t w = 0; w < count; ++w, bytes += 4) {
+        std::swap(bytes[0], bytes[3]);
+        std::swap(bytes[1], bytes[2]);
+    }
+}
+
+PLYStreamWriter::PLYStreamWriter(const std::string& path)
+    : facesPath(path + ".faces") {
+    file = std::fopen(path.c_str(), "wb");
+    faces = std::fopen(facesPath.c_str(), "w+b");
+    if (!isOpen()) {
+        std::cerr << "Error: cannot open " << path << " for writing\n";
+        ok = false;
+        return;
+    }
+
+    std::fputs("ply\nformat binary_little_endian 1.0\nelement vertex ", file);
+    vertexCountPos = std::ftell(file);
+    std::fprintf(file, "%0*d\n", COUNT_WIDTH, 0);
+    std::fputs("property float x\nproperty float y\nproperty float z\nelement face ", file);
+    faceCountPos = std::ftell(file);
+    std::fprintf(file, "%0*d\n", COUNT_WIDTH, 0);
+    std::fputs("property list uchar int vertex_indices\nend_header\n", file);
+}
+
+PLYStreamWriter::~PLYStreamWriter() {
+    if (file) std::fclose(file);
+    if (faces) {
+        std::fclose(faces);
+        std::remove(facesPath.c_str());
+    }
+}
+
+DCMeshSink PLYStreamWriter::sink() {
+    DCMeshSink s;
+    s.vertices = [this](const std::vector<std::array<float,3>>& v) { addVertices(v); };
+    s.triangles = [this](const std::vector<std::array<int,3>>& t) { addTriangles(t); };
+    return s;
+}
+
+void PLYStreamWriter::addVertices(const std::vector<std::array<float,3>>& vertices) {
+    if (!isOpen() || vertices.empty()) return;
+    // std::array<float,3> is three packed floats: the PLY vertex record
+    const void* records = vertices.data();
+    std::vector<std::array<float,3>> swapped;
+    if (!isLittleEndianHost()) {
+        swapped.resize(vertices.size());
+        copyLittleEndian32(swapped.data(), vertices.data(), vertices.size() * 3);
+        records = swapped.data();
+    }
+    ok = ok && std::fwrite(records, sizeof(vertices[0]), vertices.size(), file) == vertices.size();
+    vertexCount += vertices.size();
+}
+
+void PLYStreamWriter::addTriangles(const std::vector<std::array<int,3>>& triangles) {
+    if (!isOpen() || triangles.empty()) return;
+    // 13-byte records: uchar 3, then three int32 indices
+    std::vector<unsigned char> buffer(triangles.size() * 13);
+    unsigned char* out = buffer.data();
+    for (const auto& t : triangles) {
+        *out++ = 3;
+        for (int c = 0; c < 3; ++c) {
+            const int32_t idx = t[c];
+            copyLittleEndian32(out, &idx, 1);
+            out += sizeof(idx);
+        }
+    }
+    ok = ok && std::fwrite(buffer.data(), 1, buffer.size(), faces) == buffer.size();
+    faceCount += triangles.size();
+}
+
+bool PLYStreamWriter::finish() {
+    if (!isOpen()) return false;
+
+    // Append the faces
+    std::rewind(faces);
+    std::vector<char> chunk(1 << 20);
+    size_t n;
+    while ((n = std::fread(chunk.data(), 1, chunk.size(), faces)) > 0) {
+        ok = ok && std::fwrite(chunk.data(), 1, n, file) == n;
+    }
+
+    // Patch the counts
+    std::fseek(file, vertexCountPos, SEEK_SET);
+    std::fprintf(file, "%0*zu", COUNT_WIDTH, vertexCount);
+    std::fseek(file, faceCountPos, SEEK_SET);
+    std::fprintf(file, "%0*zu", COUNT_WIDTH, faceCount);
+
+    ok = std::fclose(file) == 0 && ok;
+    file = nullptr;
+    std::fclose(faces);
+    std::remove(facesPath.c_str());
+    faces = nullptr;
+    return ok;
+}
+
+// A file written through one large buffer. Records are formatted straight
+// into the buffer (space + commit); it goes to fwrite whenever it fills.
+class BlockWriter {
+public:
+    static const size_t BLOCK_SIZE = 4 << 20;
+
+    explicit BlockWriter(const std::string& path)
+        : buffer(new char[BLOCK_SIZE]) {
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            std::cerr << "Error: cannot open " << path << " for writing\n";
+            return;
+        }
+        std::setvbuf(file, nullptr, _IONBF, 0);
+    }
+    ~BlockWriter() {
+        if (file) std::fclose(file);
+    }
+
+    bool isOpen() const { return file != nullptr; }
+
+    // At least n (<= BLOCK_SIZE) writable bytes; commit() the ones used.
+    char* space(size_t n) {
+        if (BLOCK_SIZE - used < n) flush();
+        return buffer.get() + used;
+    }
+    void commit(size_t n) { used += n; }
+
+    // count 4-byte words in file byte order (see copyLittleEndian32). Large
+    // runs on a little-endian host bypass the buffer like append's.
+    void appendLittleEndian32(const void* words, size_t count) {
+        if (isLittleEndianHost()) {
+            append(words, count * 4);
+            return;
+        }
+        const char* src = static_cast<const char*>(words);
+        while (count > 0) {
+            const size_t n = std::min(count, BLOCK_SIZE / 8);
+            copyLittleEndian32(space(n * 4), src, n);
+            commit(n * 4);
+            src += n * 4;
+            count -= n;
+        }
+    }
+
+    // Large runs (e.g. the whole PLY vertex array) bypass the buffer.
+    void append(const void* data, size_t n) {
+        if (n > BLOCK_SIZE / 2) {
+            flush();
+            ok = ok && std::fwrite(data, 1, n, file) == n;
+            return;
+        }
+        std::memcpy(space(n), data, n);
+        commit(n);
+    }
+
+    // Write what is left and close. Returns false if any write failed.
+    bool close() {
+        flush();
+        ok = std::fclose(file) == 0 && ok;
+        file = nullptr;
+        return ok;
+    }
+
+private:
+    void flush() {
+        if (used > 0) ok = ok && std::fwrite(buffer.get(), 1, used, file) == used;
+        used = 0;
+    }
+
+    std::FILE* file = nullptr;
+    std::unique_ptr<char[]> buffer;
+    size_t used = 0;
+    bool ok = true;
+};
+
+bool writePLY(const std::string& path, const DCMesh& mesh) {
+    BlockWriter out(path);
+    if (!out.isOpen()) return false;
+
+    const std::string header =
+        "ply\nformat binary_little_endian 1.0\nelement vertex " + std::to_string(mesh.vertices.size()) +
+        "\nproperty float x\nproperty float y\nproperty float z\nelement face " +
+        std::to_string(mesh.triangles.size()) + "\nproperty list uchar int vertex_indices\nend_header\n";
+    out.append(header.data(), header.size());
+    // std::array<float,3> is three packed floats: the PLY vertex record
+    out.appendLittleEndian32(mesh.vertices.data(), mesh.vertices.size() * 3);
+    for (const auto& t : mesh.triangles) {
+        // 13-byte records: uchar 3, then three int32 indices
+        char* record = out.space(13);
+        record[0] = 3;
+        const int32_t idx[3] = {t[0], t[1], t[2]};
+        copyLittleEndian32(record + 1, idx, 3);
+        out.commit(13);
+    }
+    return out.close();
+}
+
+bool writeSTL(const std::string& path, const DCMesh& mesh) {
+    BlockWriter out(path);
+    if (!out.isOpen()) return false;
+
+    char header[80] = {};
+    std::strncpy(header, "binary STL written by dual_contour", sizeof(header));
+    out.append(header, sizeof(header));
+    const uint32_t count = static_cast<uint32_t>(mesh.triangles.size());
+    out.appendLittleEndian32(&count, 1);
+    for (const auto& t : mesh.triangles) {
+        // 50-byte records: normal, three corners, uint16 attribute count
+        const Eigen::Vector3f a(mesh.vertices[t[0]].data());
+        const Eigen::Vector3f b(mesh.vertices[t[1]].data());
+        const Eigen::Vector3f c(mesh.vertices[t[2]].data());
+        Eigen::Vector3f normal = (b - a).cross(c - a);
+        const float len = normal.norm();
+        normal = len > 0.f ? Eigen::Vector3f(normal / len) : Eigen::Vector3f::Zero();
+
+        char* record = out.space(50);
+        copyLittleEndian32(record, normal.data(), 3);
+        for (int k = 0; k < 3; ++k) {
+            copyLittleEndian32(record + 12 + 12 * k, mesh.vertices[t[k]].data(), 3);
+        }
+        std::memset(record + 48, 0, 2);
+        out.commit(50);
+    }
+    return out.close();
+}
+
+// Text of v that reads back as exactly v, at p (room for 16 characters
+// needed); returns the end of the text.
+static char* formatFloat(char* p, char* end, float v) {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    return std::to_chars(p, end, v).ptr;
+#else
+    // No floating-point to_chars (e.g. older libc++): 9 significant digits
+    // also round-trip every float, just not always in the shortest form
+    return p + std::snprintf(p, end - p, "%.9g", v);
+#endif
+}
+
+bool writeOBJ(const std::string& path, const DCMesh& mesh) {
+    BlockWriter out(path);
+    if (!out.isOpen()) return false;
+
+    // Longest line: "v " and three floats of at most 15 characters each
+    for (const auto& v : mesh.vertices) {
+        char* const line = out.space(64);
+        char* p = line;
+        *p++ = 'v';
+        for (int a = 0; a < 3; ++a) {
+            *p++ = ' ';
+            p = formatFloat(p, line + 64, v[a]);
+        }
+        *p++ = '\n';
+        out.commit(p - line);
+    }
+    for (const auto& t : mesh.triangles) {
+        char* const line = out.space(48);
+        char* p = line;
+        *p++ = 'f';
+        for (int c = 0; c < 3; ++c) {
+            *p++ = ' ';
+            p = std::to_chars(p, line + 48, t[c] + 1).ptr;
+        }
+        *p++ = '\n';
+        out.commit(p - line);
+    }
+    return out.close();
+}
+
+// Lower-case extension of path, without the dot
+static std::string extension(const std::string& path) {
+    const size_t dot = path.find_last_of('.');
+    std::string ext = dot == std::string::npos ? "" : path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char ch) { return std::tolower(ch); });
+    return ext;
+}
+
+bool writeMesh(const std::string& path, const DCMesh& mesh) {
+    const std::string ext = extension(path);
+    if (ext == "ply") return writePLY(path, mesh);
+    if (ext == "stl") return writeSTL(path, mesh);
+    if (ext == "obj") return writeOBJ(path, mesh);
+    std::cerr << "Error: unknown mesh format for " << path << " (use .ply, .stl or .obj)\n";
+    return false;
+}
+
+bool isMeshPath(const std::string& path) {
+    const std::string ext = extension(path);
+    return ext == "ply" || ext == "stl" || ext == "obj";
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "streaming.h"
+#include <cstdio>
+#include <string>
+
+// Binary little-endian PLY written as the mesh streams in. The header reserves
+// fixed-width element counts that are patched by finish(); vertices go straight
+// to the file and faces to a side file that finish() appends, since PLY stores
+// all vertices before the first face.
+class PLYStreamWriter {
+public:
+    explicit PLYStreamWriter(const std::string& path);
+    ~PLYStreamWriter();
+    PLYStreamWriter(const PLYStreamWriter&) = delete;
+    PLYStreamWriter& operator=(const PLYStreamWriter&) = delete;
+
+    bool isOpen() const { return file != nullptr && faces != nullptr; }
+
+    // A sink that forwards to this writer; valid while the writer lives.
+    DCMeshSink sink();
+    void addVertices(const std::vector<std::array<float,3>>& vertices);
+    void addTriangles(const std::vector<std::array<int,3>>& triangles);
+
+    // Complete the file. Returns false if any write failed.
+    bool finish();
+
+private:
+    std::string facesPath;
+    std::FILE* file = nullptr;
+    std::FILE* faces = nullptr;
+    long vertexCountPos = 0, faceCountPos = 0;
+    size_t vertexCount = 0, faceCount = 0;
+    bool ok = true;
+};
+
+// Whole-mesh writers: binary little-endian PLY, binary STL (facet normals from
+// the winding) and OBJ (text; coordinates read back exactly). The file is
+// assembled in large blocks that go to fwrite one at a time, with stdio's own
+// buffering off. Return false and print why if the file cannot be written.
+bool writePLY(const std::string& path, const DCMesh& mesh);
+bool writeSTL(const std::string& path, const DCMesh& mesh);
+bool writeOBJ(const std::string& path, const DCMesh& mesh);
+
+// One of the above by extension (.ply, .stl, .obj, any case).
+bool writeMesh(const std::string& path, const DCMesh& mesh);
+// Whether writeMesh knows the extension of path.
+bool isMeshPath(const std::string& path);
@@ -0,0 +1,285 @@
+#include "mesh_scan.h"
+#include "parallel.h"
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+// Work granularity for the triangle passes (faces per task)
+static const size_t ITEMS_PER_TASK = 4096;
+
+// The lattice lines along an axis are indexed by their lattice coordinates on
+// the two other axes, u = axis+1 and v = axis+2 (mod 3): line lu + (N+1)*lv.
+static inline int axisU(int axis) { return (axis + 1) % 3; }
+static inline int axisV(int axis) { return (axis + 2) % 3; }
+
+// One triangle crossing one lattice line
+struct LineHit {
+    double t;          // world coordinate along the line
+    int face;
+    bool beforeOnTie;  // if t equals a corner's coordinate, it lies before the shifted corner
+};
+
+struct LineRecord {
+    int line;
+    LineHit hit;
+};
+
+// Whether a crossing lies before lattice coordinate c on its line
+static inline bool before(const LineHit& h, double c) {
+    return h.t < c || (h.t == c && h.beforeOnTie);
+}
+
+// cross(b - a, p - a) in the (u, v) plane. The endpoints are taken in a fixed
+// order and the result negated as needed, so the two triangles sharing an edge
+// get exactly opposite values.
+static inline double edgeFunction(const double a[2], const double b[2], double pu, double pv) {
+    const bool swap = b[0] < a[0] || (b[0] == a[0] && b[1] < a[1]);
+    const double* lo = swap ? b : a;
+    const double* hi = swap ? a : b;
+    const double w = (hi[0] - lo[0]) * (pv - lo[1]) - (hi[1] - lo[1]) * (pu - lo[0]);
+    return swap ? -w : w;
+}
+
+// Sign of cross(b - a, p - a) for p on the line through a and b, after the
+// lattice shift (1, d, d^2): the gradient (-dv, du) dotted with the shift,
+// whose component on the lower-numbered axis dominates.
+static inline bool shiftedPositive(double du, double dv, bool uFirst) {
+    const double gu = -dv, gv = du;
+    if (uFirst) return gu != 0 ? gu > 0 : gv > 0;
+    return gv != 0 ? gv > 0 : gu > 0;
+}
+
+// Append a crossing for every lattice line along axis that passes through the
+// triangle's projection, owned edges and vertices included.
+static void rasterizeTriangle(const DCMesh& surface, int face, int axis, int N,
+                              float minBound, float cellSize, std::vector<LineRecord>& out) {
+    const int u = axisU(axis), v = axisV(axis);
+    const auto& tri = surface.triangles[face];
+    Eigen::Vector3d P[3];
+    double g[3][2];  // (u, v) in lattice units
+    for (int c = 0; c < 3; ++c) {
+        const auto& p = surface.vertices[tri[c]];
+        P[c] = Eigen::Vector3d(p[0], p[1], p[2]);
+        g[c][0] = (P[c][u] - minBound) / cellSize;
+        g[c][1] = (P[c][v] - minBound) / cellSize;
+    }
+    const double area = edgeFunction(g[0], g[1], g[2][0], g[2][1]);
+    if (area == 0) return;  // parallel to the lines
+    const double orient = area > 0 ? 1.0 : -1.0;
+
+    const int lu0 = std::max(0, int(std::ceil(std::min({g[0][0], g[1][0], g[2][0]}))));
+    const int lu1 = std::min(N, int(std::floor(std::max({g[0][0], g[1][0], g[2][0]}))));
+    const int lv0 = std::max(0, int(std::ceil(std::min({g[0][1], g[1][1], g[2][1]}))));
+    const int lv1 = std::min(N, int(std::floor(std::max({g[0][1], g[1][1], g[2][1]}))));
+    if (lu0 > lu1 || lv0 > lv1) return;
+
+    // A crossing exactly on a corner moves by -(n_u e_u + n_v e_v) / n_axis
+    // under the shift e and the corner by e_axis; the first nonzero term in
+    // x, y, z order decides which comes first.
+    const Eigen::Vector3d n = (P[1] - P[0]).cross(P[2] - P[0]);
+    bool beforeOnTie = true;
+    for (int m = 0; m < 3; ++m) {
+        if (m == axis) break;
+        if (n[m] != 0) {
+            beforeOnTie = n[m] * n[axis] > 0;
+            break;
+        }
+    }
+
+    const bool uFirst = u < v;
+    for (int lv = lv0; lv <= lv1; ++lv) {
+        for (int lu = lu0; lu <= lu1; ++lu) {
+            double w[3];
+            bool inside = true;
+            for (int e = 0; e < 3 && inside; ++e) {
+                const double* a = g[e];
+                const double* b = g[(e + 1) % 3];
+                w[e] = orient * edgeFunction(a, b, lu, lv);
+                if (w[e] == 0) {
+                    inside = shiftedPositive(b[0] - a[0], b[1] - a[1], uFirst) == (orient > 0);
+                } else {
+                    inside = w[e] > 0;
+                }
+            }
+            if (!inside) continue;
+            // w[e] weighs the vertex opposite edge e
+            const double t = (w[0] * P[2][axis] + w[1] * P[0][axis] + w[2] * P[1][axis]) /
+                             (w[0] + w[1] + w[2]);
+            out.push_back({lu + (N + 1) * lv, {t, face, beforeOnTie}});
+        }
+    }
+}
+
+// Crossing for the edge from lo to hi on one line's sorted hits: a hit on the
+// (shifted) edge, preferring a face whose normal points the way f rises, else
+// the nearest hit on the line clamped into the edge, else the midpoint.
+// Returns false if the edge had no hit of its own.
+static bool edgeCrossing(const LineHit* first, const LineHit* last, double lo, double hi,
+                         int axis, bool rising, const std::vector<Eigen::Vector3f>& normals,
+                         HermiteSample& sample) {
+    const LineHit* begin = std::lower_bound(first, last, lo,
+                                            [](const LineHit& h, double c) { return h.t < c; });
+    const LineHit* chosen = nullptr;
+    for (const LineHit* h = begin; h != last && h->t <= hi; ++h) {
+        if (before(*h, lo) || !before(*h, hi)) continue;
+        if (!chosen) chosen = h;
+        if ((normals[h->face][axis] > 0) == rising) {
+            chosen = h;
+            break;
+        }
+    }
+    const bool own = chosen != nullptr;
+    if (!own) {
+        double nearest = HUGE_VAL;
+        const LineHit* h = begin == first ? begin : begin - 1;
+        for (; h != last; ++h) {
+            const double d = h->t < lo ? lo - h->t : h->t > hi ? h->t - hi : 0.0;
+            if (d < nearest) {
+                nearest = d;
+                chosen = h;
+            }
+            if (h->t > hi) break;
+        }
+    }
+
+    const float sign = rising ? 1.f : -1.f;
+    if (chosen) {
+        sample.point[axis] = static_cast<float>(std::min(hi, std::max(lo, chosen->t)));
+        // Oriented the way f rises, so inconsistently wound faces still contour
+        sample.normal = normals[chosen->face];
+        if (sample.normal[axis] * sign < 0) sample.normal = -sample.normal;
+    } else {
+        sample.point[axis] = static_cast<float>(0.5 * (lo + hi));
+        sample.normal = Eigen::Vector3f::Zero();
+        sample.normal[axis] = sign;
+    }
+    return own;
+}
+
+DCGrid scanConvertMesh(const DCMesh& surface, int N, float minBound, float maxBound,
+                       int numThreads, ScanStats* stats) {
+    DCGrid grid;
+    grid.N = N;
+    grid.minBound = minBound;
+    grid.maxBound = maxBound;
+    grid.cellSize = (maxBound - minBound) / N;
+    const float cellSize = grid.cellSize;
+    const int numCorners = (N+1) * (N+1) * (N+1);
+    const int numLines = (N+1) * (N+1);
+    grid.values.resize(numCorners);
+    grid.vertexIndex.resize(N * N * N, -1);
+
+    const size_t numFaces = surface.triangles.size();
+    const int faceTasks = chunkCount(numFaces, ITEMS_PER_TASK);
+    std::vector<Eigen::Vector3f> normals(numFaces);
+    parallelFor(0, faceTasks, numThreads, [&](int task) {
+        const size_t end = std::min(numFaces, size_t(task + 1) * ITEMS_PER_TASK);
+        for (size_t f = size_t(task) * ITEMS_PER_TASK; f < end; ++f) {
+            const auto& tri = surface.triangles[f];
+            const Eigen::Vector3f p0(surface.vertices[tri[0]].data());
+            const Eigen::Vector3f p1(surface.vertices[tri[1]].data());
+            const Eigen::Vector3f p2(surface.vertices[tri[2]].data());
+            normals[f] = (p1 - p0).cross(p2 - p0).normalized();
+        }
+    });
+
+    // Crossings of every lattice line, bucketed by line and sorted along it.
+    // Buckets are filled in face order and ties sort by face, so the result
+    // does not depend on numThreads.
+    std::vector<LineHit> hits[3];
+    std::vector<size_t> lineStart[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        std::vector<LineRecord> records;
+        parallelGather(faceTasks, numThreads, records, [&](int task, std::vector<LineRecord>& out) {
+            const size_t end = std::min(numFaces, size_t(task + 1) * ITEMS_PER_TASK);
+            for (size_t f = size_t(task) * ITEMS_PER_TASK; f < end; ++f) {
+                rasterizeTriangle(surface, static_cast<int>(f), axis, N, minBound, cellSize, out);
+            }
+        });
+        if (stats) stats->lineHits += static_cast<long long>(records.size());
+
+        auto& start = lineStart[axis];
+        start.assign(numLines + 1, 0);
+        for (const LineRecord& r : records) ++start[r.line + 1];
+        for (int l = 0; l < numLines; ++l) start[l + 1] += start[l];
+        std::vector<size_t> fill(start.begin(), start.end() - 1);
+        hits[axis].resize(records.size());
+        for (const LineRecord& r : records) hits[axis][fill[r.line]++] = r.hit;
+
+        // Crossings that precede a corner on a tie sort first among equal t
+        parallelFor(0, N + 1, numThreads, [&](int lv) {
+            for (int lu = 0; lu <= N; ++lu) {
+                const int line = lu + (N + 1) * lv;
+                std::sort(hits[axis].begin() + start[line], hits[axis].begin() + start[line + 1],
+                          [](const LineHit& a, const LineHit& b) {
+                    if (a.t != b.t) return a.t < b.t;
+                    if (a.beforeOnTie != b.beforeOnTie) return a.beforeOnTie;
+                    return a.face < b.face;
+                });
+            }
+        });
+    }
+
+    // Corner signs: parity of the crossings before each corner along its X row,
+    // counting those left of the domain too
+    parallelFor(0, N + 1, numThreads, [&](int k) {
+        for (int j = 0; j <= N; ++j) {
+            const int line = j + (N + 1) * k;
+            size_t h = lineStart[0][line];
+            const size_t end = lineStart[0][line + 1];
+            bool inside = false;
+            for (int i = 0; i <= N; ++i) {
+                const float x = minBound + i * cellSize;
+                while (h < end && before(hits[0][h], x)) {
+                    inside = !inside;
+                    ++h;
+                }
+                grid.values[gridCornerIndex(i, j, k, N)] = inside ? -1.f : 1.f;
+            }
+        }
+    });
+
+    // Hermite data for every sign-changing edge, in the layout buildHermiteEdges
+    // produces: (k, j, i) scan order per axis, one z-slab per task
+    const int step[3] = {1, N+1, (N+1)*(N+1)};
+    std::atomic<long long> inferred{0};
+    for (int axis = 0; axis < 3; ++axis) {
+        auto& edges = grid.edges.edges[axis];
+        edges.clear();
+        const int ext[3] = {axis == 0 ? N : N+1, axis == 1 ? N : N+1, axis == 2 ? N : N+1};
+
+        parallelGather(ext[2], numThreads, edges, [&](int k, std::vector<HermiteEdge>& out) {
+            long long local = 0;
+            for (int j = 0; j < ext[1]; ++j) {
+                for (int i = 0; i < ext[0]; ++i) {
+                    const int idx = gridCornerIndex(i, j, k, N);
+                    const float f0 = grid.values[idx];
+                    const float f1 = grid.values[idx + step[axis]];
+                    if ((f0 < 0) == (f1 < 0)) continue;  // No sign change
+
+                    const int c[3] = {i, j, k};
+                    const int line = c[axisU(axis)] + (N + 1) * c[axisV(axis)];
+                    const LineHit* lineHits = hits[axis].data();
+                    HermiteSample sample;
+                    sample.point = Eigen::Vector3f(minBound + i * cellSize,
+                                                   minBound + j * cellSize,
+                                                   minBound + k * cellSize);
+                    const float lo = minBound + c[axis] * cellSize;
+                    const float hi = minBound + (c[axis] + 1) * cellSize;
+                    if (!edgeCrossing(lineHits + lineStart[axis][line], lineHits + lineStart[axis][line + 1],
+                                      lo, hi, axis, f1 > f0, normals, sample)) {
+                        ++local;
+                    }
+                    out.push_back({i, j, k, f1 > f0, sample});
+                }
+            }
+            inferred += local;
+        });
+    }
+    grid.edges.indexRows(N);
+    if (stats) stats->inferredEdges += inferred;
+
+    return grid;
+}
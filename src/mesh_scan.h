@@ -0,0 +1,28 @@
+#pragma once
+#include "dual_contour.h"
+
+// Work done by scanConvertMesh.
+struct ScanStats {
+    long long lineHits = 0;       // triangle crossings found on lattice lines
+    long long inferredEdges = 0;  // sign-changing edges with no crossing of their own
+};
+
+// Hermite data straight from a closed triangle mesh, with no distance field.
+// Every triangle is rasterized onto the lattice lines along X, Y and Z that
+// cross it, giving exact edge/triangle intersections and face normals; corner
+// signs come from the parity of the crossings along each X row. The cost
+// scales with the surface area in cells rather than with (N+1)^3 distance
+// queries.
+//
+// Ties (a line through a triangle edge or vertex, a crossing exactly on a
+// corner) are broken as if the lattice were shifted by an infinitesimal
+// (1, d, d^2), so mesh vertices on lattice lines are counted exactly once and
+// the X, Y and Z parities agree for any closed mesh. An edge whose corner signs
+// still disagree with its own line (an open or self-intersecting mesh) takes
+// the nearest crossing on that line, clamped to the edge, or failing that its
+// midpoint, and is counted in stats->inferredEdges.
+//
+// grid.values holds only the corner signs (-1 inside, +1 outside) and
+// grid.edges is complete, so the grid goes to dualContourHermite.
+DCGrid scanConvertMesh(const DCMesh& surface, int N, float minBound=-1.f, float maxBound=1.f,
+                       int numThreads=0, ScanStats* stats=nullptr);
@@ -1,4 +1,6 @@
 #include "mesh_sdf.h"
+#include "mapped_file.h"
+#include "parallel.h"
 #include <igl/readOBJ.h>
 #include <igl/signed_distance.h>
 #include <igl/AABB.h>
@@ -7,24 +9,357 @@
 #include <igl/per_edge_normals.h>
 #include <Eigen/Core>
 #include <iostream>
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <vector>
 
-// Module-level state
-static Eigen::MatrixXd g_V;   // Vx3 double
-static Eigen::MatrixXi g_F;   // Fx3 int
-static igl::AABB<Eigen::MatrixXd,3> g_tree;
-static Eigen::MatrixXd g_FN, g_VN, g_EN;
-static Eigen::MatrixXi g_E;
-static Eigen::VectorXi g_EMAP;
-static bool g_loaded = false;
+// One AABB node's triangles seen from afar: their summed area vectors
+// (area * unit normal) placed at their area-weighted centroid, the
+// spread sum (x_t - centre) * areaNormal_t^T over triangle centroids x_t, and
+// the radius of a ball around that centroid holding the node's box.
+struct Dipole {
+    Eigen::Vector3d centre;
+    Eigen::Vector3d areaNormal;
+    Eigen::Matrix3d moment;
+    double area;
+    double radius;
+    int size;  // nodes in the subtree, this one included
+};
+
+struct MeshSDF::Data {
+    Eigen::MatrixXd V;   // Vx3 double
+    Eigen::MatrixXi F;   // Fx3 int
+    igl::AABB<Eigen::MatrixXd,3> tree;
+    Eigen::MatrixXd FN, VN, EN;
+    Eigen::MatrixXi E;
+    Eigen::VectorXi EMAP;
+    MeshSign sign = MeshSign::Pseudonormal;
+    std::vector<Dipole> dipoles;  // tree nodes in pre-order; WindingNumber only
+    std::vector<float> windingLattice;  // see WINDING_LATTICE_CELLS; WindingNumber only
+};
+
+// A node is replaced by its dipole beyond this many radii (Barill et al. 2018)
+static const double WINDING_BETA = 2.0;
+
+// The coarse winding pass: winding numbers at the corners of a lattice of
+// WINDING_LATTICE_CELLS^3 cells over [-1,1]^3 (the mesh is normalised into
+// it), corner (i,j,k) at index i + M*(j + M*k) with M = cells + 1. A point
+// more than one lattice cell diagonal from the surface has that whole cell
+// free of triangles, where the winding number is smooth, so its sign comes
+// from the cell's trilinear interpolant instead of the dipole tree.
+static const int WINDING_LATTICE_CELLS = 32;
+static const double WINDING_LATTICE_MIN = -1.0, WINDING_LATTICE_MAX = 1.0;
+static const double PI = 3.14159265358979323846;
+
+// Points per task in MeshSDF::distanceBatch
+static const int POINTS_PER_TASK = 2048;
+
+// Binary mesh file: MeshHeader, then V, VN (numVertices x 3 double), F
+// (numFaces x 3 int32), FN (numFaces x 3 double), EMAP (numFaces * 3 int32),
+// E (numEdges x 2 int32), EN (numEdges x 3 double), all in Eigen's
+// column-major order, then the AABB tree as numNodes FlatNodes in pre-order.
+struct MeshHeader {
+    char     magic[8];
+    uint64_t contentHash;
+    uint64_t numVertices, numFaces, numEdges, numNodes;
+};
+
+struct FlatNode {
+    double  boxMin[3], boxMax[3];
+    int32_t primitive;  // -1 for inner nodes
+    int32_t children;   // bit 0: left child follows, bit 1: right child
+};
+
+static const char MESH_MAGIC[8] = {'D', 'C', 'M', 'E', 'S', 'H', '0', '1'};
+
+using MeshTree = igl::AABB<Eigen::MatrixXd,3>;
+
+static void flattenTree(const MeshTree& node, std::vector<FlatNode>& out) {
+    FlatNode flat;
+    for (int a = 0; a < 3; ++a) {
+        flat.boxMin[a] = node.m_box.min()(a);
+        flat.boxMax[a] = node.m_box.max()(a);
+    }
+    flat.primitive = node.m_primitive;
+    flat.children = (node.m_left ? 1 : 0) | (node.m_right ? 2 : 0);
+    out.push_back(flat);
+    if (node.m_left) flattenTree(*node.m_left, out);
+    if (node.m_right) flattenTree(*node.m_right, out);
+}
+
+// Rebuild the subtree stored at nodes[next]; returns false on a malformed tree.
+// As in igl::AABB, a node is a leaf holding one of the numFaces triangles or
+// an inner node (primitive -1) with both children.
+static bool unflattenTree(const FlatNode* nodes, size_t count, int64_t numFaces, size_t& next,
+                          MeshTree& node) {
+    if (next >= count) return false;
+    FlatNode flat;
+    std::memcpy(&flat, nodes + next++, sizeof(flat));
+    const bool leaf = flat.children == 0 && flat.primitive >= 0 && flat.primitive < numFaces;
+    const bool inner = flat.children == 3 && flat.primitive == -1;
+    if (!leaf && !inner) return false;
+    for (int a = 0; a < 3; ++a) {
+        node.m_box.min()(a) = flat.boxMin[a];
+        node.m_box.max()(a) = flat.boxMax[a];
+    }
+    node.m_primitive = flat.primitive;
+    if (inner) {
+        node.m_left = new MeshTree();
+        node.m_right = new MeshTree();
+        return unflattenTree(nodes, count, numFaces, next, *node.m_left) &&
+               unflattenTree(nodes, count, numFaces, next, *node.m_right);
+    }
+    return true;
+}
+
+// Whether every entry of an index matrix lies in [0, bound)
+template <class Matrix>
+static bool indicesBelow(const Matrix& m, int64_t bound) {
+    return m.size() == 0 || (m.minCoeff() >= 0 && m.maxCoeff() < bound);
+}
+
+static void buildDipoles(const MeshTree& node, const Eigen::MatrixXd& V, const Eigen::MatrixXi& F,
+                         std::vector<Dipole>& out) {
+    const size_t index = out.size();
+    out.emplace_back();
+    Dipole dipole;
+    if (node.is_leaf()) {
+        const Eigen::Vector3d a = V.row(F(node.m_primitive, 0)).transpose();
+        const Eigen::Vector3d b = V.row(F(node.m_primitive, 1)).transpose();
+        const Eigen::Vector3d c = V.row(F(node.m_primitive, 2)).transpose();
+        dipole.areaNormal = 0.5 * (b - a).cross(c - a);
+        dipole.area = dipole.areaNormal.norm();
+        dipole.centre = (a + b + c) / 3.0;
+        dipole.moment.setZero();
+    } else {
+        dipole.areaNormal.setZero();
+        dipole.area = 0.0;
+        Eigen::Vector3d weighted = Eigen::Vector3d::Zero(), plain = Eigen::Vector3d::Zero();
+        int children = 0;
+        for (const MeshTree* child : {node.m_left, node.m_right}) {
+            if (!child) continue;
+            const size_t c = out.size();
+            buildDipoles(*child, V, F, out);
+            dipole.areaNormal += out[c].areaNormal;
+            dipole.area += out[c].area;
+            weighted += out[c].area * out[c].centre;
+            plain += out[c].centre;
+            ++children;
+        }
+        dipole.centre = dipole.area > 0.0 ? Eigen::Vector3d(weighted / dipole.area)
+                                          : Eigen::Vector3d(plain / std::max(children, 1));
+        // Children's moments, shifted to this centre
+        dipole.moment.setZero();
+        const Dipole* child = &out[index + 1];
+        for (int c = 0; c < children; ++c) {
+            dipole.moment += child->moment + (child->centre - dipole.centre) * child->areaNormal.transpose();
+            child += child->size;
+        }
+    }
+    // The farthest box corner bounds every point of the node's triangles
+    const Eigen::Vector3d reach = (node.m_box.max() - dipole.centre).cwiseMax(dipole.centre - node.m_box.min());
+    dipole.radius = reach.norm();
+    dipole.size = static_cast<int>(out.size() - index);
+    out[index] = dipole;
+}
+
+// Winding number of the subtree at node, whose dipole is *dipole
+static double windingAt(const MeshTree& node, const Dipole* dipole, const Eigen::MatrixXd& V,
+                        const Eigen::MatrixXi& F, const Eigen::Vector3d& q) {
+    if (node.is_leaf()) {
+        // Exact solid angle of the triangle (Van Oosterom & Strackee) over 4 pi
+        const Eigen::Vector3d a = V.row(F(node.m_primitive, 0)).transpose() - q;
+        const Eigen::Vector3d b = V.row(F(node.m_primitive, 1)).transpose() - q;
+        const Eigen::Vector3d c = V.row(F(node.m_primitive, 2)).transpose() - q;
+        const double la = a.norm(), lb = b.norm(), lc = c.norm();
+        const double det = a.dot(b.cross(c));
+        const double den = la * lb * lc + a.dot(b) * lc + a.dot(c) * lb + b.dot(c) * la;
+        return std::atan2(det, den) / (2.0 * PI);
+    }
+    const Eigen::Vector3d r = dipole->centre - q;
+    const double dist2 = r.squaredNorm();
+    if (dist2 > WINDING_BETA * WINDING_BETA * dipole->radius * dipole->radius) {
+        // Dipole plus the first Taylor term of its kernel r / (4 pi |r|^3)
+        const double dist3 = dist2 * std::sqrt(dist2);
+        const double first = r.dot(dipole->areaNormal) / dist3;
+        const double second = dipole->moment.trace() / dist3 -
+                              3.0 * r.dot(dipole->moment * r) / (dist3 * dist2);
+        return (first + second) / (4.0 * PI);
+    }
+    double w = 0.0;
+    const Dipole* child = dipole + 1;
+    if (node.m_left) {
+        w += windingAt(*node.m_left, child, V, F, q);
+        child += child->size;
+    }
+    if (node.m_right) w += windingAt(*node.m_right, child, V, F, q);
+    return w;
+}
+
+MeshSDF::MeshSDF() : d(new Data()) {}
+MeshSDF::~MeshSDF() = default;
+
+bool MeshSDF::writeBinary(const std::string& path, uint64_t contentHash) const {
+    std::vector<FlatNode> nodes;
+    flattenTree(d->tree, nodes);
+
+    MeshHeader header = {};
+    std::memcpy(header.magic, MESH_MAGIC, sizeof(MESH_MAGIC));
+    header.contentHash = contentHash;
+    header.numVertices = d->V.rows();
+    header.numFaces = d->F.rows();
+    header.numEdges = d->E.rows();
+    header.numNodes = nodes.size();
+
+    const std::string tmpPath = temporaryPathFor(path);
+    std::FILE* file = std::fopen(tmpPath.c_str(), "wb");
+    if (!file) return false;
+    auto put = [&](const void* data, size_t bytes) {
+        return bytes == 0 || std::fwrite(data, bytes, 1, file) == 1;
+    };
+    bool ok = put(&header, sizeof(header)) &&
+              put(d->V.data(), d->V.size() * sizeof(double)) &&
+              put(d->VN.data(), d->VN.size() * sizeof(double)) &&
+              put(d->F.data(), d->F.size() * sizeof(int)) &&
+              put(d->FN.data(), d->FN.size() * sizeof(double)) &&
+              put(d->EMAP.data(), d->EMAP.size() * sizeof(int)) &&
+              put(d->E.data(), d->E.size() * sizeof(int)) &&
+              put(d->EN.data(), d->EN.size() * sizeof(double)) &&
+              put(nodes.data(), nodes.size() * sizeof(FlatNode));
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) std::remove(tmpPath.c_str());
+    return ok && replaceFile(tmpPath, path);
+}
+
+std::shared_ptr<MeshSDF> MeshSDF::loadBinary(const std::string& path, uint64_t contentHash) {
+    MappedFile file;
+    if (!file.open(path)) return nullptr;
+
+    MeshHeader header;
+    if (file.size() < sizeof(header)) return nullptr;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, MESH_MAGIC, sizeof(MESH_MAGIC)) != 0 ||
+        header.contentHash != contentHash) {
+        return nullptr;
+    }
+    // Bound each count by the file size before multiplying, so a crafted
+    // header cannot wrap the expected size around to the real one
+    const uint64_t nv = header.numVertices, nf = header.numFaces, ne = header.numEdges;
+    const uint64_t size = file.size();
+    if (nv > size / (6 * sizeof(double)) || nf > size / (6 * sizeof(int) + 3 * sizeof(double)) ||
+        ne > size / (2 * sizeof(int) + 3 * sizeof(double)) || header.numNodes > size / sizeof(FlatNode)) {
+        return nullptr;
+    }
+    const uint64_t expected = sizeof(header) + nv * 6 * sizeof(double) +
+                              nf * (6 * sizeof(int) + 3 * sizeof(double)) +
+                              ne * (2 * sizeof(int) + 3 * sizeof(double)) +
+                              header.numNodes * sizeof(FlatNode);
+    if (size != expected || nf == 0) return nullptr;
+
+    // Straight copies out of the mapping: nothing is parsed or recomputed.
+    // libigl's queries take owning matrices, so the arrays cannot be mapped
+    // in place with Eigen::Map
+    std::shared_ptr<MeshSDF> mesh(new MeshSDF());
+    Data& m = *mesh->d;
+    const char* cursor = file.data() + sizeof(header);
+    auto take = [&](auto& matrix, Eigen::Index rows, Eigen::Index cols) {
+        matrix.resize(rows, cols);
+        const size_t bytes = matrix.size() * sizeof(*matrix.data());
+        std::memcpy(matrix.data(), cursor, bytes);
+        cursor += bytes;
+    };
+    take(m.V, nv, 3);
+    take(m.VN, nv, 3);
+    take(m.F, nf, 3);
+    take(m.FN, nf, 3);
+    take(m.EMAP, nf * 3, 1);
+    take(m.E, ne, 2);
+    take(m.EN, ne, 3);
+    if (!indicesBelow(m.F, nv) || !indicesBelow(m.E, nv) || !indicesBelow(m.EMAP, ne)) return nullptr;
+
+    size_t next = 0;
+    const FlatNode* nodes = reinterpret_cast<const FlatNode*>(cursor);
+    if (!unflattenTree(nodes, header.numNodes, static_cast<int64_t>(nf), next, m.tree) ||
+        next != header.numNodes) {
+        return nullptr;
+    }
+    return mesh;
+}
+
+void MeshSDF::setSign(MeshSign sign) {
+    d->sign = sign;
+    d->dipoles.clear();
+    d->windingLattice.clear();
+    if (sign == MeshSign::WindingNumber) {
+        d->dipoles.reserve(2 * d->F.rows());
+        buildDipoles(d->tree, d->V, d->F, d->dipoles);
+
+        const int M = WINDING_LATTICE_CELLS + 1;
+        const double step = (WINDING_LATTICE_MAX - WINDING_LATTICE_MIN) / WINDING_LATTICE_CELLS;
+        d->windingLattice.resize(size_t(M) * M * M);
+        parallelFor(0, M, 0, [&](int k) {
+            for (int j = 0; j < M; ++j) {
+                for (int i = 0; i < M; ++i) {
+                    const Eigen::Vector3d q(WINDING_LATTICE_MIN + i * step, WINDING_LATTICE_MIN + j * step,
+                                            WINDING_LATTICE_MIN + k * step);
+                    d->windingLattice[i + size_t(M) * (j + size_t(M) * k)] =
+                        static_cast<float>(windingAt(d->tree, d->dipoles.data(), d->V, d->F, q));
+                }
+            }
+        });
+    }
+}
+
+bool MeshSDF::insideByWinding(const Eigen::RowVector3d& p, double distance) const {
+    const double step = (WINDING_LATTICE_MAX - WINDING_LATTICE_MIN) / WINDING_LATTICE_CELLS;
+    double u[3];
+    bool nearOrOutside = distance <= std::sqrt(3.0) * step;
+    for (int a = 0; a < 3; ++a) {
+        u[a] = (p(a) - WINDING_LATTICE_MIN) / step;
+        nearOrOutside = nearOrOutside || !(u[a] >= 0.0 && u[a] <= WINDING_LATTICE_CELLS);
+    }
+    if (nearOrOutside) return windingAt(d->tree, d->dipoles.data(), d->V, d->F, p.transpose()) >= 0.5;
+
+    const int M = WINDING_LATTICE_CELLS + 1;
+    int c[3];
+    for (int a = 0; a < 3; ++a) {
+        c[a] = std::min(static_cast<int>(u[a]), WINDING_LATTICE_CELLS - 1);
+        u[a] -= c[a];
+    }
+    double w = 0.0;
+    for (int corner = 0; corner < 8; ++corner) {
+        const int di = corner & 1, dj = (corner >> 1) & 1, dk = (corner >> 2) & 1;
+        const double weight = (di ? u[0] : 1.0 - u[0]) * (dj ? u[1] : 1.0 - u[1]) * (dk ? u[2] : 1.0 - u[2]);
+        w += weight * d->windingLattice[(c[0] + di) + size_t(M) * ((c[1] + dj) + size_t(M) * (c[2] + dk))];
+    }
+    return w >= 0.5;
+}
+
+std::string MeshSDF::binaryCachePath(const std::string& cacheDir, uint64_t contentHash) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.meshbin", static_cast<unsigned long long>(contentHash));
+    return cacheDir + "/" + name;
+}
+
+std::shared_ptr<MeshSDF> MeshSDF::load(const std::string& obj_path, MeshSign sign, const std::string& cacheDir) {
+    const uint64_t hash = cacheDir.empty() ? 0 : hashFileContents(obj_path);
+    const std::string binaryPath = hash != 0 ? binaryCachePath(cacheDir, hash) : std::string();
+    if (hash != 0) {
+        if (std::shared_ptr<MeshSDF> cached = loadBinary(binaryPath, hash)) {
+            cached->setSign(sign);
+            return cached;
+        }
+    }
 
-bool loadMeshSDF(const std::string& obj_path) {
     // Use the polygon-aware overload so n-gon faces (quads, hexagons, etc.) are read correctly.
     std::vector<std::vector<double>> Vv, TCv, Nv;
     std::vector<std::vector<int>>    Fv, FTCv, FNv;
     if (!igl::readOBJ(obj_path, Vv, TCv, Nv, Fv, FTCv, FNv)) {
         std::cerr << "Failed to load OBJ: " << obj_path << std::endl;
-        return false;
+        return nullptr;
     }
 
     // Copy vertices into Eigen matrix
@@ -44,7 +379,7 @@ bool loadMeshSDF(const std::string& obj_path) {
     }
     if (tris.empty()) {
         std::cerr << "No valid faces in OBJ: " << obj_path << std::endl;
-        return false;
+        return nullptr;
     }
     Eigen::MatrixXi F(static_cast<int>(tris.size()), 3);
     for (int i = 0; i < static_cast<int>(tris.size()); ++i) {
@@ -58,27 +393,208 @@ bool loadMeshSDF(const std::string& obj_path) {
     double scale = 0.9 / (0.5*(hi - lo).maxCoeff());
     V = (V.rowwise() - centre) * scale;
 
-    g_V = V; g_F = F;
-    g_tree.init(g_V, g_F);
+    std::shared_ptr<MeshSDF> mesh(new MeshSDF());
+    Data& d = *mesh->d;
+    d.V = V; d.F = F;
+    d.tree.init(d.V, d.F);
 
     // Pre-compute normals needed by pseudonormal sign
-    igl::per_face_normals  (g_V, g_F, g_FN);
-    igl::per_vertex_normals(g_V, g_F, igl::PER_VERTEX_NORMALS_WEIGHTING_TYPE_ANGLE, g_VN);
-    igl::per_edge_normals  (g_V, g_F, igl::PER_EDGE_NORMALS_WEIGHTING_TYPE_UNIFORM, g_EN, g_E, g_EMAP);
+    igl::per_face_normals  (d.V, d.F, d.FN);
+    igl::per_vertex_normals(d.V, d.F, igl::PER_VERTEX_NORMALS_WEIGHTING_TYPE_ANGLE, d.VN);
+    igl::per_edge_normals  (d.V, d.F, igl::PER_EDGE_NORMALS_WEIGHTING_TYPE_UNIFORM, d.EN, d.E, d.EMAP);
 
-    g_loaded = true;
-    return true;
+    // Best effort: a cache directory that cannot be created or written just
+    // means no cache
+    if (hash != 0 && createDirectories(cacheDir)) mesh->writeBinary(binaryPath, hash);
+    mesh->setSign(sign);
+    return mesh;
 }
 
-float implicitMeshSDF(float x, float y, float z) {
-    if (!g_loaded) {
-        std::cerr << "Error: loadMeshSDF() must be called before implicitMeshSDF()" << std::endl;
-        return 1.0f; // Return outside by default
+float MeshSDF::distance(float x, float y, float z) const {
+    if (d->sign == MeshSign::WindingNumber) {
+        MeshSDFQueryState unbounded;
+        return distanceCoherent(x, y, z, unbounded);
     }
     // Use the 8-arg overload that returns the signed distance directly
     Eigen::RowVector3d p(x, y, z);
     double sd = igl::signed_distance_pseudonormal(
-        g_tree, g_V, g_F, g_FN, g_VN, g_EN, g_EMAP, p);
+        d->tree, d->V, d->F, d->FN, d->VN, d->EN, d->EMAP, p);
     return static_cast<float>(sd);
 }
 
+float MeshSDF::distanceCoherent(float x, float y, float z, MeshSDFQueryState& state) const {
+    const Eigen::RowVector3d p(x, y, z);
+    Eigen::RowVector3d closest;
+    int face = -1;
+    double sqrd = 0.0;
+    if (state.mesh == this) {
+        // libigl's own descent, started from the bound. Its result is only
+        // used for a face it found within the bound; otherwise (face left at
+        // -1, or the bound itself returned) the query reruns unbounded.
+        const Eigen::RowVector3d last(state.lastPoint[0], state.lastPoint[1], state.lastPoint[2]);
+        const double bound = std::abs(state.lastDistance) + (p - last).norm();
+        const double boundSqr = bound * bound * (1.0 + 1e-9);
+        sqrd = d->tree.squared_distance(d->V, d->F, p, 0.0, boundSqr, face, closest);
+        if (face >= 0 && !(sqrd < boundSqr)) face = -1;
+    }
+    if (face < 0) sqrd = d->tree.squared_distance(d->V, d->F, p, face, closest);
+
+    // Same sign test signed_distance_pseudonormal applies to its closest face
+    double s = 0.0;
+    if (d->sign == MeshSign::WindingNumber) {
+        s = insideByWinding(p, std::sqrt(sqrd)) ? -1.0 : 1.0;
+    } else {
+        Eigen::RowVector3d normal;
+        igl::pseudonormal_test(d->V, d->F, d->FN, d->VN, d->EN, d->EMAP, p, face, closest, s, normal);
+    }
+    const double dist = s * std::sqrt(sqrd);
+
+    state.mesh = this;
+    for (int a = 0; a < 3; ++a) state.lastPoint[a] = p(a);
+    state.lastDistance = dist;
+    ++state.queries;
+    return static_cast<float>(dist);
+}
+
+void MeshSDF::distanceBatch(const float* x, const float* y, const float* z, float* out, int n,
+                            int numThreads) const {
+    parallelFor(0, chunkCount(n, POINTS_PER_TASK), numThreads, [&](int task) {
+        // A fresh hint per task, so the result depends only on the batch
+        MeshSDFQueryState state;
+        const int end = std::min(n, (task + 1) * POINTS_PER_TASK);
+        for (int i = task * POINTS_PER_TASK; i < end; ++i) {
+            out[i] = distanceCoherent(x[i], y[i], z[i], state);
+        }
+    });
+}
+
+float MeshSDF::query(float x, float y, float z, Eigen::Vector3f& normal,
+                     Eigen::Vector3f* closest) const {
+    Eigen::RowVector3d p(x, y, z), c, pseudonormal;
+    double s = 0.0, sqrd = 0.0;
+    int face = -1;
+    igl::signed_distance_pseudonormal(
+        d->tree, d->V, d->F, d->FN, d->VN, d->EN, d->EMAP, p, s, sqrd, face, c, pseudonormal);
+    if (d->sign == MeshSign::WindingNumber) s = insideByWinding(p, std::sqrt(sqrd)) ? -1.0 : 1.0;
+
+    const double dist = std::sqrt(sqrd);
+    Eigen::RowVector3d n = dist > 1e-12 ? Eigen::RowVector3d((p - c) * (s / dist))
+                                        : Eigen::RowVector3d(pseudonormal.normalized());
+    normal = n.transpose().cast<float>();
+    if (closest) *closest = c.transpose().cast<float>();
+    return static_cast<float>(s * dist);
+}
+
+double MeshSDF::windingNumber(float x, float y, float z) const {
+    if (d->dipoles.empty()) return -1.0;
+    return windingAt(d->tree, d->dipoles.data(), d->V, d->F, Eigen::Vector3d(x, y, z));
+}
+
+MeshSign MeshSDF::sign() const {
+    return d->sign;
+}
+
+int MeshSDF::numTriangles() const {
+    return static_cast<int>(d->F.rows());
+}
+
+DCMesh MeshSDF::surface() const {
+    DCMesh mesh;
+    mesh.vertices.resize(d->V.rows());
+    for (int v = 0; v < d->V.rows(); ++v) {
+        mesh.vertices[v] = {float(d->V(v, 0)), float(d->V(v, 1)), float(d->V(v, 2))};
+    }
+    mesh.triangles.resize(d->F.rows());
+    for (int f = 0; f < d->F.rows(); ++f) {
+        mesh.triangles[f] = {d->F(f, 0), d->F(f, 1), d->F(f, 2)};
+    }
+    return mesh;
+}
+
+ImplicitField meshSDFField(std::shared_ptr<const MeshSDF> mesh, int numThreads) {
+    ImplicitField field;
+    field.eval = [mesh](float x, float y, float z) { return mesh->distance(x, y, z); };
+    field.evalBatch = [mesh, numThreads](const float* x, const float* y, const float* z, float* out, int n) {
+        mesh->distanceBatch(x, y, z, out, n, numThreads);
+    };
+    field.evalGrad = [mesh](float x, float y, float z, Eigen::Vector3f& grad) {
+        return mesh->query(x, y, z, grad);
+    };
+    return field;
+}
+
+std::shared_ptr<const MeshSDF> MeshSDFCache::get(const std::string& obj_path, MeshSign sign) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->first == obj_path && it->second->sign() == sign) {
+                entries.splice(entries.begin(), entries, it);
+                return entries.front().second;
+            }
+        }
+    }
+
+    // Load outside the lock so other meshes stay available meanwhile; if two
+    // threads miss on the same path, the first insert wins.
+    std::shared_ptr<const MeshSDF> mesh = MeshSDF::load(obj_path, sign, cacheDir);
+    if (!mesh) return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& entry : entries) {
+        if (entry.first == obj_path && entry.second->sign() == sign) return entry.second;
+    }
+    entries.emplace_front(obj_path, mesh);
+    while (entries.size() > capacity) entries.pop_back();
+    return mesh;
+}
+
+size_t MeshSDFCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+void MeshSDFCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+}
+
+// Mesh behind the single-mesh interface
+static MeshSDFCache g_cache;
+static std::shared_ptr<const MeshSDF> g_current;
+
+bool loadMeshSDF(const std::string& obj_path, MeshSign sign) {
+    std::shared_ptr<const MeshSDF> mesh = g_cache.get(obj_path, sign);
+    if (!mesh) return false;
+    g_current = mesh;
+    return true;
+}
+
+float implicitMeshSDF(float x, float y, float z) {
+    if (!g_current) {
+        std::cerr << "Error: loadMeshSDF() must be called before implicitMeshSDF()" << std::endl;
+        return 1.0f; // Return outside by default
+    }
+    return g_current->distance(x, y, z);
+}
+
+void implicitMeshSDFBatch(const float* x, const float* y, const float* z, float* out, int n) {
+    if (!g_current) {
+        std::cerr << "Error: loadMeshSDF() must be called before implicitMeshSDFBatch()" << std::endl;
+        std::fill(out, out + n, 1.0f);
+        return;
+    }
+    g_current->distanceBatch(x, y, z, out, n);
+}
+
+float implicitMeshSDFGrad(float x, float y, float z, Eigen::Vector3f& grad) {
+    if (!g_current) {
+        std::cerr << "Error: loadMeshSDF() must be called before implicitMeshSDFGrad()" << std::endl;
+        grad = Eigen::Vector3f(1, 0, 0);
+        return 1.0f;
+    }
+    return g_current->query(x, y, z, grad);
+}
+
+ImplicitField meshSDFField() {
+    return ImplicitField(implicitMeshSDF, implicitMeshSDFBatch, implicitMeshSDFGrad);
+}
@@ -1,13 +1,170 @@
 #pragma once
+#include "dual_contour.h"
+#include "implicit.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 
-// Load an OBJ, build an AABB tree, normalise to [-0.9,0.9]^3.
+class MeshSDF;
+
+// How a MeshSDF tells inside from outside.
+enum class MeshSign {
+    Pseudonormal,   // angle-weighted pseudonormal at the closest point; needs a
+                    // closed, consistently oriented mesh
+    WindingNumber   // generalized winding number >= 0.5; robust to holes and
+                    // self-intersections. Evaluated exactly only near the
+                    // surface; see MeshSDF::windingNumber
+};
+
+// Hint carried from one query to the next on one thread (see
+// MeshSDF::distanceCoherent), plus a query count.
+struct MeshSDFQueryState {
+    const MeshSDF* mesh = nullptr;  // mesh the hint came from; none yet if null
+    double lastPoint[3] = {0.0, 0.0, 0.0};
+    double lastDistance = 0.0;
+    long long queries = 0;
+};
+
+// Pseudonormal signed distance to one triangle mesh. An instance owns its
+// vertices, faces, AABB tree and normals; queries are const and may run
+// concurrently from any number of threads.
+class MeshSDF {
+public:
+    // Load an OBJ, build an AABB tree, normalise to [-0.9,0.9]^3.
+    // Returns nullptr and prints an error if loading fails.
+    // The binary cache is opt-in: with a cacheDir, the loaded mesh is also
+    // written to binaryCachePath(cacheDir, hash of the OBJ's contents), and
+    // later loads of an unchanged OBJ copy their arrays out of that file
+    // instead of parsing and rebuilding. cacheDir is created if missing; one
+    // that cannot be created or written just means no cache. The apps pass
+    // userCacheDirectory().
+    // MeshSign::WindingNumber also builds a dipole tree over the AABB tree
+    // and the coarse winding pass (see windingNumber); neither is cached.
+    static std::shared_ptr<MeshSDF> load(const std::string& obj_path,
+                                         MeshSign sign = MeshSign::Pseudonormal,
+                                         const std::string& cacheDir = std::string());
+    static std::string binaryCachePath(const std::string& cacheDir, uint64_t contentHash);
+
+    // The binary format: normalised vertices, triangles, face/vertex/edge
+    // normals and the AABB tree flattened in pre-order. writeBinary goes
+    // through a temporary renamed into place. loadBinary returns nullptr if
+    // the file is missing, malformed (including any index out of range) or
+    // keyed to another hash.
+    bool writeBinary(const std::string& path, uint64_t contentHash) const;
+    static std::shared_ptr<MeshSDF> loadBinary(const std::string& path, uint64_t contentHash);
+
+    ~MeshSDF();
+    MeshSDF(const MeshSDF&) = delete;
+    MeshSDF& operator=(const MeshSDF&) = delete;
+
+    // f < 0 = inside, f > 0 = outside, by the sign mode chosen at load.
+    float distance(float x, float y, float z) const;
+
+    // distance() for a sequence of nearby points. A distance field is
+    // 1-Lipschitz, so |d(prev)| + |p - prev| bounds the distance at p; libigl's
+    // AABB query starts from that bound instead of infinity and prunes most of
+    // the tree at once. A bound that rounding leaves too tight finds no face
+    // and the query reruns unbounded, exactly as distance() does. Otherwise
+    // the closest distance is the same, but where several faces are equally
+    // close the descent may settle on another of them, so the result can
+    // differ from distance() in the last bits.
+    float distanceCoherent(float x, float y, float z, MeshSDFQueryState& state) const;
+
+    // out[i] = distance(x[i], y[i], z[i]) for i < n, answered in order by
+    // distanceCoherent, with the hint starting afresh in each run of 2048
+    // points so the result does not depend on the thread count. Batches of
+    // more than 2048 points are split across numThreads threads (0 = all
+    // cores); buildGrid's row batches are smaller and stay on the calling
+    // thread, since buildGrid already runs the rows in parallel.
+    void distanceBatch(const float* x, const float* y, const float* z, float* out, int n,
+                       int numThreads = 0) const;
+
+    // Distance, closest surface point and unit normal from one traversal. The
+    // normal is the SDF gradient, sign * (p - closest) / |p - closest|, or the
+    // pseudonormal at the closest point when p lies on the surface. Returns
+    // the same distance as distance().
+    float query(float x, float y, float z, Eigen::Vector3f& normal,
+                Eigen::Vector3f* closest = nullptr) const;
+
+    // Generalized winding number: ~1 inside, ~0 outside, in between across
+    // holes. A node of the tree counts as one dipole (its area vector at its
+    // area-weighted centroid) once the point is more than twice its radius
+    // away; nearer triangles add their exact solid angle. Far from the
+    // surface only a few nodes are opened, so the cost is mostly near it.
+    // The signed distances only call it within one cell diagonal of a coarse
+    // lattice from the surface: at load, a dense pass stores the winding
+    // number at every corner of a 32^3-cell lattice over [-1,1]^3, and signs
+    // farther out come from its trilinear interpolant, which is smooth there,
+    // so caps across holes do not step. Points outside the lattice always
+    // take this exact value.
+    // Returns -1 unless the mesh was loaded with MeshSign::WindingNumber.
+    double windingNumber(float x, float y, float z) const;
+    MeshSign sign() const;
+
+    int numTriangles() const;
+
+    // The normalised triangles, e.g. for scanConvertMesh.
+    DCMesh surface() const;
+
+private:
+    MeshSDF();
+    void setSign(MeshSign sign);
+    // WindingNumber inside test for p at unsigned distance from the surface
+    bool insideByWinding(const Eigen::RowVector3d& p, double distance) const;
+    struct Data;  // libigl types stay out of this header
+    std::unique_ptr<Data> d;
+};
+
+// Bind an instance into the field interface buildGrid/dualContour consume. The
+// field shares ownership, so it stays valid however long it is kept. Its
+// gradient comes from query(), so each Hermite normal costs one AABB query
+// instead of six for central differences. Its batch kernel splits large
+// batches across numThreads threads (0 = all cores).
+ImplicitField meshSDFField(std::shared_ptr<const MeshSDF> mesh, int numThreads = 0);
+
+// Loaded meshes by OBJ path and sign mode, least recently used first out once
+// more than capacity are held. Switching back to a cached mesh skips the OBJ
+// parse and the tree build. Safe to use from several threads. Loads use
+// cacheDir as MeshSDF::load does (empty: no binary cache).
+class MeshSDFCache {
+public:
+    explicit MeshSDFCache(size_t capacity = 4, const std::string& cacheDir = std::string())
+        : capacity(capacity), cacheDir(cacheDir) {}
+
+    // The mesh at obj_path with the given sign mode, loaded on a miss; nullptr
+    // if loading fails.
+    std::shared_ptr<const MeshSDF> get(const std::string& obj_path,
+                                       MeshSign sign = MeshSign::Pseudonormal);
+    size_t size() const;
+    void clear();
+
+private:
+    size_t capacity;
+    std::string cacheDir;
+    mutable std::mutex mutex;
+    std::list<std::pair<std::string, std::shared_ptr<const MeshSDF>>> entries;  // most recent first
+};
+
+// Single-mesh interface kept for ScalarField callers: loadMeshSDF selects the
+// mesh (through a shared MeshSDFCache) that the free functions below query.
 // Returns false and prints an error if loading fails.
 // Must be called once before implicitMeshSDF is used.
-bool loadMeshSDF(const std::string& obj_path);
+bool loadMeshSDF(const std::string& obj_path, MeshSign sign = MeshSign::Pseudonormal);
 
-// ScalarField-compatible function: queries the pre-loaded mesh SDF.
-// f < 0 = inside, f > 0 = outside (pseudonormal sign).
+// ScalarField-compatible function: queries the mesh selected by loadMeshSDF.
+// f < 0 = inside, f > 0 = outside (sign mode chosen by loadMeshSDF).
 float implicitMeshSDF(float x, float y, float z);
 
+// BatchScalarField-compatible counterpart of implicitMeshSDF.
+void implicitMeshSDFBatch(const float* x, const float* y, const float* z, float* out, int n);
+
+// GradientField-compatible counterpart of implicitMeshSDF (MeshSDF::query).
+float implicitMeshSDFGrad(float x, float y, float z, Eigen::Vector3f& grad);
 
+// implicitMeshSDF together with its batch kernel and gradient, for
+// buildGrid/dualContour.
+ImplicitField meshSDFField();
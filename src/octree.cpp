@@ -0,0 +1,324 @@
+#include "dual_contour.h"
+#include "qef.h"
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+
+// Adaptive dual contouring (Ju et al. 2002, "Dual Contouring of Hermite Data").
+// The octree is built bottom-up over the DCGrid cells; every leaf (a single
+// active cell, or a collapsed block of cells) carries one vertex, and polygons
+// are generated once per minimal sign-changing edge by cell/face/edge
+// recursion. Child index bits follow EDGE_CORNERS: bit 0 = +x, 1 = +y, 2 = +z.
+
+struct OctreeNode {
+    int origin[3];     // lattice coordinates of the lowest corner
+    int size;          // edge length in cells (a power of two)
+    int children[8];   // node indices, -1 for empty space; unused for leaves
+    bool leaf;
+    QEF qef;
+    Eigen::Vector3f position;
+    int vertex;        // mesh vertex index (leaves)
+};
+
+struct OctreeContext {
+    const DCGrid& grid;
+    float tolerance;
+    std::vector<OctreeNode> nodes;
+    DCMesh& mesh;
+};
+
+static bool inside(const DCGrid& grid, int i, int j, int k) {
+    return grid.values[gridCornerIndex(i, j, k, grid.N)] < 0;
+}
+
+// Collapsing a block into one vertex is safe when (Ju et al., section 4.1) the
+// coarse cell's sign configuration has a single component, and the sign at the
+// midpoint of every coarse edge and face, and at the centre, agrees with one of
+// the corners it lies between. Together with the same test on the children this
+// keeps every leaf edge crossed at most once.
+static bool collapsePreservesTopology(const DCGrid& grid, const int o[3], int size) {
+    const int h = size / 2;
+    bool corner[8];
+    for (int c = 0; c < 8; ++c) {
+        corner[c] = inside(grid, o[0] + (c & 1) * size, o[1] + ((c >> 1) & 1) * size,
+                           o[2] + ((c >> 2) & 1) * size);
+    }
+
+    // Corners of each sign must be connected along cube edges
+    int insideCount = 0;
+    for (int c = 0; c < 8; ++c) insideCount += corner[c];
+    if (insideCount == 0 || insideCount == 8) return false;
+    for (int sign = 0; sign < 2; ++sign) {
+        int reached = 0, seed = -1;
+        for (int c = 0; c < 8 && seed < 0; ++c) {
+            if (corner[c] == bool(sign)) seed = c;
+        }
+        reached |= 1 << seed;
+        for (bool grew = true; grew; ) {
+            grew = false;
+            for (int e = 0; e < 12; ++e) {
+                const int a = EDGE_CORNERS[e][0], b = EDGE_CORNERS[e][1];
+                if (corner[a] != bool(sign) || corner[b] != bool(sign)) continue;
+                if (((reached >> a) & 1) != ((reached >> b) & 1)) {
+                    reached |= (1 << a) | (1 << b);
+                    grew = true;
+                }
+            }
+        }
+        for (int c = 0; c < 8; ++c) {
+            if (corner[c] == bool(sign) && !((reached >> c) & 1)) return false;
+        }
+    }
+
+    // Edge midpoints
+    for (int e = 0; e < 12; ++e) {
+        const int a = EDGE_CORNERS[e][0], b = EDGE_CORNERS[e][1];
+        const bool mid = inside(grid, o[0] + ((a & 1) + (b & 1)) * h,
+                                o[1] + (((a >> 1) & 1) + ((b >> 1) & 1)) * h,
+                                o[2] + (((a >> 2) & 1) + ((b >> 2) & 1)) * h);
+        if (mid != corner[a] && mid != corner[b]) return false;
+    }
+
+    // Face midpoints
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int side = 0; side < 2; ++side) {
+            int p[3] = {o[0] + h, o[1] + h, o[2] + h};
+            p[axis] = o[axis] + side * size;
+            const bool mid = inside(grid, p[0], p[1], p[2]);
+            bool matches = false;
+            for (int c = 0; c < 8; ++c) {
+                if (((c >> axis) & 1) == side && corner[c] == mid) matches = true;
+            }
+            if (!matches) return false;
+        }
+    }
+
+    // The centre always matches a corner once both signs are present.
+    return true;
+}
+
+// Build the subtree over cells [o, o + size)^3; returns its node index or -1
+// when it holds no surface. Nodes are appended in post-order, so a node's
+// children are the last nodes appended before it.
+static int buildNode(OctreeContext& ctx, int i, int j, int k, int size) {
+    const DCGrid& grid = ctx.grid;
+    const int N = grid.N;
+    if (i >= N || j >= N || k >= N) return -1;
+
+    OctreeNode node;
+    node.origin[0] = i;
+    node.origin[1] = j;
+    node.origin[2] = k;
+    node.size = size;
+    node.vertex = -1;
+    std::fill(node.children, node.children + 8, -1);
+
+    const Eigen::Vector3f cellMin(grid.minBound + i * grid.cellSize,
+                                  grid.minBound + j * grid.cellSize,
+                                  grid.minBound + k * grid.cellSize);
+    const Eigen::Vector3f cellMax(grid.minBound + (i + size) * grid.cellSize,
+                                  grid.minBound + (j + size) * grid.cellSize,
+                                  grid.minBound + (k + size) * grid.cellSize);
+
+    if (size == 1) {
+        if (!cellHasSignChange(grid.values, i, j, k, N)) return -1;
+        // Same edge order as dualContour's pass 1, so the vertex is identical
+        for (int e = 0; e < 12; ++e) {
+            const int axis = e / 4;
+            const int c0 = EDGE_CORNERS[e][0];
+            const int slot = grid.edges.find(axis, i + (c0 & 1), j + ((c0 >> 1) & 1), k + ((c0 >> 2) & 1));
+            if (slot >= 0) node.qef.add(grid.edges.edges[axis][slot].hermite);
+        }
+        node.leaf = true;
+        node.position = node.qef.solve(cellMin, cellMax);
+        ctx.nodes.push_back(node);
+        return static_cast<int>(ctx.nodes.size()) - 1;
+    }
+
+    const size_t mark = ctx.nodes.size();
+    const int h = size / 2;
+    bool any = false, collapsible = true;
+    for (int c = 0; c < 8; ++c) {
+        node.children[c] = buildNode(ctx, i + (c & 1) * h, j + ((c >> 1) & 1) * h,
+                                     k + ((c >> 2) & 1) * h, h);
+        if (node.children[c] < 0) continue;
+        any = true;
+        if (!ctx.nodes[node.children[c]].leaf) collapsible = false;
+    }
+    if (!any) return -1;
+
+    node.leaf = false;
+    collapsible = collapsible && ctx.tolerance >= 0.0f &&
+                  i + size <= N && j + size <= N && k + size <= N;
+    if (collapsible) {
+        for (int c = 0; c < 8; ++c) {
+            if (node.children[c] >= 0) node.qef.merge(ctx.nodes[node.children[c]].qef);
+        }
+        node.position = node.qef.solve(cellMin, cellMax);
+        const double limit = double(ctx.tolerance) * ctx.tolerance * node.qef.count;
+        if (node.qef.error(node.position) <= limit &&
+            collapsePreservesTopology(grid, node.origin, size)) {
+            // The children are exactly the nodes appended since mark
+            ctx.nodes.resize(mark);
+            node.leaf = true;
+            std::fill(node.children, node.children + 8, -1);
+        }
+    }
+    ctx.nodes.push_back(node);
+    return static_cast<int>(ctx.nodes.size()) - 1;
+}
+
+// Number the leaf vertices in depth-first order
+static void assignVertices(OctreeContext& ctx, int n) {
+    if (n < 0) return;
+    OctreeNode& node = ctx.nodes[n];
+    if (!node.leaf) {
+        for (int c = 0; c < 8; ++c) assignVertices(ctx, node.children[c]);
+        return;
+    }
+    node.vertex = static_cast<int>(ctx.mesh.vertices.size());
+    ctx.mesh.vertices.push_back({node.position.x(), node.position.y(), node.position.z()});
+}
+
+// The child of n at index c, or n itself once n is a leaf
+static int childOrSelf(const OctreeContext& ctx, int n, int c) {
+    return ctx.nodes[n].leaf ? n : ctx.nodes[n].children[c];
+}
+
+// Four nodes around an edge along axis, in QUAD_CELLS order. When all are
+// leaves the edge is minimal: it is an edge of the smallest of them.
+static void edgeProc(OctreeContext& ctx, const int n[4], int axis) {
+    for (int q = 0; q < 4; ++q) {
+        if (n[q] < 0) return;
+    }
+
+    bool allLeaves = true;
+    for (int q = 0; q < 4; ++q) allLeaves = allLeaves && ctx.nodes[n[q]].leaf;
+
+    if (!allLeaves) {
+        // Split the edge in two along axis and recurse on each half
+        for (int t = 0; t < 2; ++t) {
+            int sub[4];
+            for (int q = 0; q < 4; ++q) {
+                int c = t << axis;
+                for (int p = 0; p < 3; ++p) {
+                    if (p != axis && QUAD_CELLS[axis][q][p] < 0) c |= 1 << p;
+                }
+                sub[q] = childOrSelf(ctx, n[q], c);
+            }
+            edgeProc(ctx, sub, axis);
+        }
+        return;
+    }
+
+    int smallest = 0;
+    for (int q = 1; q < 4; ++q) {
+        if (ctx.nodes[n[q]].size < ctx.nodes[n[smallest]].size) smallest = q;
+    }
+    const OctreeNode& s = ctx.nodes[n[smallest]];
+    int lo[3], hi[3];
+    for (int p = 0; p < 3; ++p) {
+        lo[p] = s.origin[p] + (p != axis && QUAD_CELLS[axis][smallest][p] < 0 ? s.size : 0);
+        hi[p] = lo[p];
+    }
+    hi[axis] += s.size;
+
+    const int N = ctx.grid.N;
+    const float f0 = ctx.grid.values[gridCornerIndex(lo[0], lo[1], lo[2], N)];
+    const float f1 = ctx.grid.values[gridCornerIndex(hi[0], hi[1], hi[2], N)];
+    if ((f0 < 0) == (f1 < 0)) return;
+
+    int v[4];
+    for (int q = 0; q < 4; ++q) v[q] = ctx.nodes[n[q]].vertex;
+    appendPolygon(v, axis, f1 > f0, ctx.mesh.triangles);
+}
+
+// Two nodes sharing a face perpendicular to axis; n[0] is on the low side.
+static void faceProc(OctreeContext& ctx, const int n[2], int axis) {
+    if (n[0] < 0 || n[1] < 0) return;
+    if (ctx.nodes[n[0]].leaf && ctx.nodes[n[1]].leaf) return;
+
+    // The four child pairs across the face
+    for (int c = 0; c < 8; ++c) {
+        if ((c >> axis) & 1) continue;
+        const int sub[2] = {childOrSelf(ctx, n[0], c | (1 << axis)), childOrSelf(ctx, n[1], c)};
+        faceProc(ctx, sub, axis);
+    }
+
+    // The four edges inside the face, along each of the two in-plane axes
+    for (int edgeAxis = 0; edgeAxis < 3; ++edgeAxis) {
+        if (edgeAxis == axis) continue;
+        const int other = 3 - axis - edgeAxis;
+        for (int t = 0; t < 2; ++t) {
+            int sub[4];
+            for (int q = 0; q < 4; ++q) {
+                const bool below = QUAD_CELLS[edgeAxis][q][axis] < 0;
+                int c = t << edgeAxis;
+                if (below) c |= 1 << axis;
+                if (QUAD_CELLS[edgeAxis][q][other] == 0) c |= 1 << other;
+                sub[q] = childOrSelf(ctx, n[below ? 0 : 1], c);
+            }
+            edgeProc(ctx, sub, edgeAxis);
+        }
+    }
+}
+
+static void cellProc(OctreeContext& ctx, int n) {
+    if (n < 0 || ctx.nodes[n].leaf) return;
+    int children[8];
+    std::copy(ctx.nodes[n].children, ctx.nodes[n].children + 8, children);
+
+    for (int c = 0; c < 8; ++c) cellProc(ctx, children[c]);
+
+    // The 12 faces between children
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int c = 0; c < 8; ++c) {
+            if ((c >> axis) & 1) continue;
+            const int sub[2] = {children[c], children[c | (1 << axis)]};
+            faceProc(ctx, sub, axis);
+        }
+    }
+
+    // The 6 edges through the centre, two halves per axis
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int t = 0; t < 2; ++t) {
+            int sub[4];
+            for (int q = 0; q < 4; ++q) {
+                int c = t << axis;
+                for (int p = 0; p < 3; ++p) {
+                    if (p != axis && QUAD_CELLS[axis][q][p] == 0) c |= 1 << p;
+                }
+                sub[q] = children[c];
+            }
+            edgeProc(ctx, sub, axis);
+        }
+    }
+}
+
+DCMesh dualContourAdaptive(const ImplicitField& f, DCGrid& grid, float tolerance, int numThreads) {
+    DCMesh mesh;
+    const int N = grid.N;
+    buildHermiteEdges(f, grid, numThreads);
+
+    OctreeContext ctx{grid, tolerance, {}, mesh};
+    int rootSize = 1;
+    while (rootSize < N) rootSize *= 2;
+    const int root = buildNode(ctx, 0, 0, 0, rootSize);
+    assignVertices(ctx, root);
+    cellProc(ctx, root);
+
+    // Map every active cell to the vertex of its leaf
+    std::fill(grid.vertexIndex.begin(), grid.vertexIndex.end(), -1);
+    for (const OctreeNode& node : ctx.nodes) {
+        if (!node.leaf || node.vertex < 0) continue;
+        const int* o = node.origin;
+        for (int ck = o[2]; ck < std::min(o[2] + node.size, N); ++ck)
+            for (int cj = o[1]; cj < std::min(o[1] + node.size, N); ++cj)
+                for (int ci = o[0]; ci < std::min(o[0] + node.size, N); ++ci)
+                    if (cellHasSignChange(grid.values, ci, cj, ck, N))
+                        grid.vertexIndex[gridCellIndex(ci, cj, ck, N)] = node.vertex;
+    }
+
+    removeDegenerateTriangles(mesh, numThreads);
+    return mesh;
+}
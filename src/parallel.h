@@ -0,0 +1,76 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Resolve a requested thread count: <= 0 means one thread per hardware core.
+inline int resolveThreadCount(int numThreads) {
+    if (numThreads > 0) return numThreads;
+    const unsigned hw = std::thread::hardware_concurrency();
+    return hw > 0 ? static_cast<int>(hw) : 1;
+}
+
+// Number of fixed-size chunks covering count items. Chunking by size rather than
+// by thread count keeps per-chunk outputs identical for any numThreads.
+inline int chunkCount(size_t count, size_t chunkSize) {
+    return static_cast<int>((count + chunkSize - 1) / chunkSize);
+}
+
+// Run body(i) for every i in [begin, end) on up to numThreads worker threads.
+// Indices are handed out one at a time from a shared counter, so uneven work
+// (e.g. slabs that intersect the surface vs. empty ones) balances itself.
+// Bodies must only write to disjoint outputs; the execution order is unspecified.
+// numThreads == 1 runs inline on the calling thread. If a body throws, no
+// further indices are handed out and the first exception is rethrown on the
+// calling thread once every worker has stopped.
+template <class Body>
+void parallelFor(int begin, int end, int numThreads, Body&& body) {
+    if (end <= begin) return;
+    const int workers = std::min(resolveThreadCount(numThreads), end - begin);
+    if (workers <= 1) {
+        for (int i = begin; i < end; ++i) body(i);
+        return;
+    }
+
+    std::atomic<int> next(begin);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto worker = [&]() {
+        try {
+            for (int i = next.fetch_add(1); i < end; i = next.fetch_add(1)) {
+                body(i);
+            }
+        } catch (...) {
+            next = end;
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) error = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (int t = 1; t < workers; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& th : threads) th.join();
+    if (error) std::rethrow_exception(error);
+}
+
+// Run produce(task, out) for every task in [0, numTasks) in parallel, each task
+// appending to its own buffer, then append the buffers to result in task order.
+// The result is identical to running the tasks serially, whatever numThreads is.
+template <class T, class Produce>
+void parallelGather(int numTasks, int numThreads, std::vector<T>& result, Produce&& produce) {
+    std::vector<std::vector<T>> parts(numTasks);
+    parallelFor(0, numTasks, numThreads, [&](int t) { produce(t, parts[t]); });
+
+    // Prefix sum of the part sizes gives every part its output offset
+    std::vector<size_t> offset(numTasks + 1, result.size());
+    for (int t = 0; t < numTasks; ++t) offset[t + 1] = offset[t] + parts[t].size();
+    result.resize(offset[numTasks]);
+    parallelFor(0, numTasks, numThreads, [&](int t) {
+        std::copy(parts[t].begin(), parts[t].end(), result.begin() + offset[t]);
+    });
+}
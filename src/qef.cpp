@@ -1,55 +1,77 @@
 #include "qef.h"
-#include <Eigen/SVD>
+#include <Eigen/Eigenvalues>
 #include <algorithm>
 #include <cmath>
+#include <limits>
 
-Eigen::Vector3f solveQEF(const std::vector<HermiteSample>& samples,
-                         const Eigen::Vector3f& cellMin,
-                         const Eigen::Vector3f& cellMax,
-                         float svdThreshold) {
-    if (samples.empty()) {
-        // Fallback: return mass-point clamped to cell
-        Eigen::Vector3f massPoint = (cellMin + cellMax) * 0.5f;
-        return massPoint.cwiseMax(cellMin).cwiseMin(cellMax);
+void QEF::add(const Eigen::Vector3f& point, const Eigen::Vector3f& normal) {
+    const Eigen::Vector3d p = point.cast<double>();
+    Eigen::Vector3d n = normal.cast<double>();
+    const double nNorm = n.norm();
+    if (nNorm > 1e-12) {
+        n /= nNorm;
+    } else {
+        n = Eigen::Vector3d::UnitX();
     }
+    const double d = n.dot(p);
+    ata += n * n.transpose();
+    atb += n * d;
+    btb += d * d;
+    massSum += p;
+    ++count;
+}
 
-    // Compute mass-point (average of intersection points)
-    Eigen::Vector3d massPoint = Eigen::Vector3d::Zero();
-    for (const auto& sample : samples) {
-        massPoint += sample.point.cast<double>();
-    }
-    massPoint /= static_cast<double>(samples.size());
+void QEF::merge(const QEF& other) {
+    ata += other.ata;
+    atb += other.atb;
+    btb += other.btb;
+    massSum += other.massSum;
+    count += other.count;
+}
 
-    // Translate system to mass-point for better conditioning
-    const int sampleCount = static_cast<int>(samples.size());
-    Eigen::MatrixXd A(sampleCount, 3);
-    Eigen::VectorXd b(sampleCount);
+Eigen::Vector3f QEF::massPoint() const {
+    if (count == 0) return Eigen::Vector3f::Zero();
+    return (massSum / static_cast<double>(count)).cast<float>();
+}
 
-    for (int i = 0; i < sampleCount; ++i) {
-        const Eigen::Vector3d p = samples[i].point.cast<double>() - massPoint;
-        Eigen::Vector3d normal = samples[i].normal.cast<double>();
-        const double nNorm = normal.norm();
-        if (nNorm > 1e-12) {
-            normal /= nNorm;
-        } else {
-            normal = Eigen::Vector3d::UnitX();
-        }
-        A.row(i) = normal.transpose();
-        b(i) = normal.dot(p);
+double QEF::error(const Eigen::Vector3f& x) const {
+    const Eigen::Vector3d xd = x.cast<double>();
+    return std::max(0.0, xd.dot(ata * xd) - 2.0 * xd.dot(atb) + btb);
+}
+
+Eigen::Vector3f QEF::solve(const Eigen::Vector3f& cellMin,
+                           const Eigen::Vector3f& cellMax,
+                           float svdThreshold) const {
+    if (count == 0) {
+        // Fallback: return mass-point clamped to cell
+        Eigen::Vector3f massPoint = (cellMin + cellMax) * 0.5f;
+        return massPoint.cwiseMax(cellMin).cwiseMin(cellMax);
     }
 
-    // Solve with SVD
-    Eigen::JacobiSVD<Eigen::MatrixXd> svd(A, Eigen::ComputeThinU | Eigen::ComputeThinV);
+    // Translate system to mass-point for better conditioning:
+    // AᵀA stays the same, Aᵀb becomes Aᵀb - AᵀA m.
+    const Eigen::Vector3d massPoint = massSum / static_cast<double>(count);
+    const Eigen::Vector3d rhs = atb - ata * massPoint;
 
-    // Set threshold to suppress near-degenerate singular values (rank deficiency)
-    const auto& svals = svd.singularValues();
-    const double maxSV = svals.size() > 0 ? svals(0) : 1.0;
-    svd.setThreshold(static_cast<double>(svdThreshold) * std::max(1.0, maxSV));
+    // The singular values of A are the square roots of the eigenvalues of AᵀA.
+    // Suppress the near-degenerate ones exactly as the SVD threshold does:
+    // sigma < threshold * sigmaMax * max(1, sigmaMax).
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eig(ata);
+    const Eigen::Vector3d& lambda = eig.eigenvalues();  // ascending
+    const double maxSV = std::sqrt(std::max(lambda(2), 0.0));
+    const double cutoff = std::max(maxSV * static_cast<double>(svdThreshold) * std::max(1.0, maxSV),
+                                   std::numeric_limits<double>::min());
 
-    // If rank < 3 the system is underdetermined; minimum-norm SVD solve still gives
-    // a reasonable result in constrained directions, with zero displacement in null-space
-    // directions (i.e., biased toward massPoint). This handles edge/corner features.
-    Eigen::Vector3d x = svd.solve(b);
+    // If rank < 3 the system is underdetermined; the pseudo-inverse gives zero
+    // displacement in null-space directions (i.e., biased toward massPoint).
+    // This handles edge/corner features.
+    Eigen::Vector3d x = Eigen::Vector3d::Zero();
+    for (int i = 0; i < 3; ++i) {
+        const double sv = std::sqrt(std::max(lambda(i), 0.0));
+        if (sv < cutoff) continue;
+        const Eigen::Vector3d v = eig.eigenvectors().col(i);
+        x += v * (v.dot(rhs) / lambda(i));
+    }
 
     // Translate back to world space
     x += massPoint;
@@ -72,3 +94,13 @@ Eigen::Vector3f solveQEF(const std::vector<HermiteSample>& samples,
     return xf;
 }
 
+Eigen::Vector3f solveQEF(const std::vector<HermiteSample>& samples,
+                         const Eigen::Vector3f& cellMin,
+                         const Eigen::Vector3f& cellMax,
+                         float svdThreshold) {
+    QEF qef;
+    for (const auto& sample : samples) {
+        qef.add(sample);
+    }
+    return qef.solve(cellMin, cellMax, svdThreshold);
+}
@@ -7,9 +7,35 @@ struct HermiteSample {
     Eigen::Vector3f normal;
 };
 
+// Accumulated quadratic error function E(x) = sum_i (n_i . (x - p_i))^2 in
+// normal-equation form: fixed-size AᵀA, Aᵀb, bᵀb and the mass-point sum.
+// Adding samples and solving never allocates, and two QEFs over disjoint
+// sample sets merge by summation (e.g. when collapsing octree children).
+struct QEF {
+    Eigen::Matrix3d ata = Eigen::Matrix3d::Zero();
+    Eigen::Vector3d atb = Eigen::Vector3d::Zero();
+    double          btb = 0.0;
+    Eigen::Vector3d massSum = Eigen::Vector3d::Zero();
+    int             count = 0;
+
+    // Normals are normalised here; a zero normal falls back to +X.
+    void add(const Eigen::Vector3f& point, const Eigen::Vector3f& normal);
+    void add(const HermiteSample& sample) { add(sample.point, sample.normal); }
+    void merge(const QEF& other);
+
+    Eigen::Vector3f massPoint() const;
+    // Residual E(x) at a candidate vertex.
+    double error(const Eigen::Vector3f& x) const;
+
+    // Minimiser via a thresholded 3x3 symmetric eigen pseudo-inverse, taken
+    // relative to the mass point. Falls back to the mass point when the
+    // solution leaves the cell (same rules as solveQEF).
+    Eigen::Vector3f solve(const Eigen::Vector3f& cellMin,
+                          const Eigen::Vector3f& cellMax,
+                          float svdThreshold = 1e-3f) const;
+};
+
 Eigen::Vector3f solveQEF(const std::vector<HermiteSample>& samples,
                          const Eigen::Vector3f& cellMin,
                          const Eigen::Vector3f& cellMax,
                          float svdThreshold = 1e-3f);
-
-
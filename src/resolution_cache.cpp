@@ -0,0 +1,122 @@
+#include "resolution_cache.h"
+#include "parallel.h"
+#include <algorithm>
+
+static int oddPart(int N) {
+    while (N > 0 && N % 2 == 0) N /= 2;
+    return N;
+}
+
+DCGrid ResolutionCache::grid(const std::string& key, const ImplicitField& f, int N,
+                             float minBound, float maxBound, int numThreads) {
+    DCGrid grid;
+    grid.N = N;
+    grid.minBound = minBound;
+    grid.maxBound = maxBound;
+    grid.cellSize = (maxBound - minBound) / N;
+    grid.values.resize((N+1) * (N+1) * (N+1));
+    grid.vertexIndex.resize(N * N * N, -1);
+
+    const int family = oddPart(N);
+    auto it = std::find_if(lattices.begin(), lattices.end(), [&](const Lattice& l) {
+        return l.key == key && l.minBound == minBound && l.maxBound == maxBound && l.family == family;
+    });
+    if (it != lattices.end()) {
+        lattices.splice(lattices.begin(), lattices, it);
+    }
+    Lattice* lattice = it != lattices.end() ? &lattices.front() : nullptr;
+
+    // A coarser (or the same) resolution is a strided read of the lattice
+    if (lattice && lattice->N >= N) {
+        const int stride = lattice->N / N;
+        const int M = lattice->N;
+        parallelFor(0, N + 1, numThreads, [&](int k) {
+            for (int j = 0; j <= N; ++j)
+                for (int i = 0; i <= N; ++i)
+                    grid.values[gridCornerIndex(i, j, k, N)] =
+                        lattice->values[gridCornerIndex(i * stride, j * stride, k * stride, M)];
+        });
+        counters.reusedCorners += static_cast<long long>(grid.values.size());
+        return grid;
+    }
+
+    // A finer one keeps the coincident corners and samples the rest, a row at a
+    // time; rows through coarse corners only need their new (odd) corners
+    const int stride = lattice ? N / lattice->N : 0;
+    const float cellSize = grid.cellSize;
+    std::vector<long long> slabEvals(N + 1, 0);
+    parallelFor(0, N + 1, numThreads, [&](int k) {
+        std::vector<float> xs(N + 1), ys(N + 1), zs(N + 1, minBound + k * cellSize), out(N + 1);
+        std::vector<int> fresh;
+        for (int j = 0; j <= N; ++j) {
+            const bool coarseRow = stride > 0 && j % stride == 0 && k % stride == 0;
+            fresh.clear();
+            for (int i = 0; i <= N; ++i) {
+                if (coarseRow && i % stride == 0) {
+                    grid.values[gridCornerIndex(i, j, k, N)] = lattice->values[gridCornerIndex(
+                        i / stride, j / stride, k / stride, lattice->N)];
+                } else {
+                    xs[fresh.size()] = minBound + i * cellSize;
+                    fresh.push_back(i);
+                }
+            }
+            if (fresh.empty()) continue;
+            std::fill(ys.begin(), ys.begin() + fresh.size(), minBound + j * cellSize);
+            f.evaluate(xs.data(), ys.data(), zs.data(), out.data(), static_cast<int>(fresh.size()));
+            for (size_t e = 0; e < fresh.size(); ++e) {
+                grid.values[gridCornerIndex(fresh[e], j, k, N)] = out[e];
+            }
+            slabEvals[k] += static_cast<long long>(fresh.size());
+        }
+    });
+    long long sampled = 0;
+    for (long long n : slabEvals) sampled += n;
+    counters.sampledCorners += sampled;
+    counters.reusedCorners += static_cast<long long>(grid.values.size()) - sampled;
+
+    if (lattice) {
+        lattice->N = N;
+        lattice->values = grid.values;
+    } else {
+        lattices.push_front({key, minBound, maxBound, family, N, grid.values});
+        if (lattices.size() > latticeCapacity) lattices.pop_back();
+    }
+    return grid;
+}
+
+std::shared_ptr<const DCMesh> ResolutionCache::mesh(const std::string& key, const ImplicitField& f, int N,
+                                                    float minBound, float maxBound, int numThreads) {
+    auto it = std::find_if(meshes.begin(), meshes.end(), [&](const MeshEntry& e) {
+        return e.key == key && e.minBound == minBound && e.maxBound == maxBound && e.N == N;
+    });
+    if (it != meshes.end()) {
+        meshes.splice(meshes.begin(), meshes, it);
+        ++counters.meshHits;
+        return meshes.front().mesh;
+    }
+    ++counters.meshMisses;
+
+    DCGrid sampled = grid(key, f, N, minBound, maxBound, numThreads);
+    auto mesh = std::make_shared<const DCMesh>(dualContour(f, sampled, numThreads));
+    meshes.push_front({key, minBound, maxBound, N, mesh});
+    if (meshes.size() > meshCapacity) meshes.pop_back();
+    return mesh;
+}
+
+ResolutionCacheStats ResolutionCache::stats() const {
+    ResolutionCacheStats s = counters;
+    s.latticeBytes = 0;
+    for (const Lattice& l : lattices) s.latticeBytes += l.values.capacity() * sizeof(float);
+    s.meshBytes = 0;
+    for (const MeshEntry& e : meshes) {
+        s.meshBytes += e.mesh->vertices.capacity() * sizeof(e.mesh->vertices[0]) +
+                       e.mesh->triangles.capacity() * sizeof(e.mesh->triangles[0]);
+    }
+    return s;
+}
+
+void ResolutionCache::clear() {
+    lattices.clear();
+    meshes.clear();
+    counters = ResolutionCacheStats();
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "dual_contour.h"
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Cache traffic and footprint of a ResolutionCache.
+struct ResolutionCacheStats {
+    long long meshHits = 0, meshMisses = 0;
+    long long reusedCorners = 0;   // corner samples copied from a lattice
+    long long sampledCorners = 0;  // corner samples evaluated
+    size_t latticeBytes = 0;
+    size_t meshBytes = 0;
+
+    double meshHitRate() const {
+        const long long lookups = meshHits + meshMisses;
+        return lookups > 0 ? double(meshHits) / lookups : 0.0;
+    }
+    double cornerReuseRate() const {
+        const long long corners = reusedCorners + sampledCorners;
+        return corners > 0 ? double(reusedCorners) / corners : 0.0;
+    }
+};
+
+// Samples and meshes of a field across grid resolutions, keyed by a name for
+// the field and the domain [minBound, maxBound]^3; the same key must always
+// name the same field.
+//
+// Resolutions N * 2^k share their corner positions exactly (the cell size
+// only changes by powers of two), so samples live on one lattice per field,
+// domain and odd part of N, at the finest resolution sampled so far. A
+// coarser N of the family is read straight from it; a finer one copies the
+// coincident corners and evaluates only the new ones (7/8 of them per
+// doubling), in rows as buildGrid does, so the values are identical to
+// buildGrid's. Contoured meshes are kept in a separate LRU by (key, N).
+//
+// Not safe for concurrent use; give each thread its own cache.
+class ResolutionCache {
+public:
+    explicit ResolutionCache(size_t meshCapacity = 8, size_t latticeCapacity = 4)
+        : meshCapacity(meshCapacity), latticeCapacity(latticeCapacity) {}
+
+    // buildGrid(f, N, minBound, maxBound), reusing cached samples.
+    DCGrid grid(const std::string& key, const ImplicitField& f, int N,
+                float minBound=-1.f, float maxBound=1.f, int numThreads=0);
+
+    // dualContour of grid(...), or the cached mesh of an earlier call.
+    std::shared_ptr<const DCMesh> mesh(const std::string& key, const ImplicitField& f, int N,
+                                       float minBound=-1.f, float maxBound=1.f, int numThreads=0);
+
+    ResolutionCacheStats stats() const;
+    void clear();
+
+private:
+    struct Lattice {
+        std::string key;
+        float minBound, maxBound;
+        int family;                 // odd part of the resolutions it serves
+        int N;                      // finest resolution sampled
+        std::vector<float> values;  // (N+1)^3, as DCGrid::values
+    };
+    struct MeshEntry {
+        std::string key;
+        float minBound, maxBound;
+        int N;
+        std::shared_ptr<const DCMesh> mesh;
+    };
+
+    size_t meshCapacity, latticeCapacity;
+    std::list<Lattice> lattices;  // most recent first
+    std::list<MeshEntry> meshes;  // most recent first
+    ResolutionCacheStats counters;
+};
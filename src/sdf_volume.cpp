@@ -0,0 +1,322 @@
+#include "sdf_volume.h"
+#include "mesh_sdf.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// File layout: VolumeHeader, then int32 brickSlot[bricksPerAxis^3] in
+// (bi, bj, bk) scan order, then the stored bricks' samples in slot order,
+// x fastest. Everything is written in the host's byte order.
+struct VolumeHeader {
+    char     magic[8];
+    uint64_t contentHash;
+    int32_t  resolution, brickSize, quantized, reserved;
+    float    minBound, maxBound, band, reservedF;
+    uint64_t numStored;
+};
+
+static const char MAGIC[8] = {'D', 'C', 'S', 'D', 'F', 'V', '0', '1'};
+static const float QUANT_SCALE = 32767.0f;
+
+// Largest resolution open() accepts, which keeps the slot table size in range
+static const int32_t MAX_RESOLUTION = 1 << 16;
+
+// Narrow-band half-width in world units, as stored in the header
+static float bandWidth(const SDFBakeOptions& options) {
+    const float cellSize = (options.maxBound - options.minBound) / options.resolution;
+    return options.bandCells * cellSize;
+}
+
+bool bakeSDFVolume(const ImplicitField& f, uint64_t contentHash, const std::string& volumePath,
+                   const SDFBakeOptions& options, int numThreads) {
+    const int R = options.resolution, B = options.brickSize;
+    const int bricksPerAxis = (R + B - 1) / B;
+    const int side = B + 1;
+    const float cellSize = (options.maxBound - options.minBound) / R;
+    const float band = bandWidth(options);
+    const size_t numBricks = size_t(bricksPerAxis) * bricksPerAxis * bricksPerAxis;
+
+    // A brick is stored when the surface may come within the band of any of
+    // its cells; every point of a far brick is then at least band away.
+    std::vector<float> cx(numBricks), cy(numBricks), cz(numBricks), centre(numBricks);
+    for (size_t b = 0; b < numBricks; ++b) {
+        const int bi = b % bricksPerAxis, bj = (b / bricksPerAxis) % bricksPerAxis;
+        const int bk = static_cast<int>(b / (size_t(bricksPerAxis) * bricksPerAxis));
+        cx[b] = options.minBound + (bi * B + 0.5f * B) * cellSize;
+        cy[b] = options.minBound + (bj * B + 0.5f * B) * cellSize;
+        cz[b] = options.minBound + (bk * B + 0.5f * B) * cellSize;
+    }
+    f.evaluate(cx.data(), cy.data(), cz.data(), centre.data(), static_cast<int>(numBricks));
+
+    const float reach = band + 0.5f * std::sqrt(3.0f) * B * cellSize;
+    std::vector<int32_t> brickSlot(numBricks);
+    std::vector<size_t> slotBrick;
+    for (size_t b = 0; b < numBricks; ++b) {
+        if (std::abs(centre[b]) <= reach) {
+            brickSlot[b] = static_cast<int32_t>(slotBrick.size());
+            slotBrick.push_back(b);
+        } else {
+            brickSlot[b] = centre[b] < 0 ? -2 : -1;
+        }
+    }
+
+    // Sample the stored bricks row by row, clamped to the band
+    const size_t samplesPerBrick = size_t(side) * side * side;
+    const size_t sampleBytes = options.quantize ? sizeof(int16_t) : sizeof(float);
+    std::vector<char> samples(slotBrick.size() * samplesPerBrick * sampleBytes);
+    parallelFor(0, static_cast<int>(slotBrick.size()), numThreads, [&](int slot) {
+        const size_t b = slotBrick[slot];
+        const int i0 = int(b % bricksPerAxis) * B;
+        const int j0 = int((b / bricksPerAxis) % bricksPerAxis) * B;
+        const int k0 = int(b / (size_t(bricksPerAxis) * bricksPerAxis)) * B;
+        std::vector<float> xs(side), ys(side), zs(side), row(side);
+        for (int i = 0; i < side; ++i) xs[i] = options.minBound + (i0 + i) * cellSize;
+        char* out = samples.data() + slot * samplesPerBrick * sampleBytes;
+        for (int k = 0; k < side; ++k) {
+            std::fill(zs.begin(), zs.end(), options.minBound + (k0 + k) * cellSize);
+            for (int j = 0; j < side; ++j) {
+                std::fill(ys.begin(), ys.end(), options.minBound + (j0 + j) * cellSize);
+                f.evaluate(xs.data(), ys.data(), zs.data(), row.data(), side);
+                const size_t base = size_t(side) * (j + size_t(side) * k);
+                for (int i = 0; i < side; ++i) {
+                    const float v = std::min(std::max(row[i], -band), band);
+                    if (options.quantize) {
+                        const int16_t q = static_cast<int16_t>(std::lrint(v / band * QUANT_SCALE));
+                        std::memcpy(out + (base + i) * sampleBytes, &q, sizeof(q));
+                    } else {
+                        std::memcpy(out + (base + i) * sampleBytes, &v, sizeof(v));
+                    }
+                }
+            }
+        }
+    });
+
+    VolumeHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.contentHash = contentHash;
+    header.resolution = R;
+    header.brickSize = B;
+    header.quantized = options.quantize ? 1 : 0;
+    header.minBound = options.minBound;
+    header.maxBound = options.maxBound;
+    header.band = band;
+    header.numStored = slotBrick.size();
+
+    const std::string tmpPath = temporaryPathFor(volumePath);
+    std::FILE* file = std::fopen(tmpPath.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Error: cannot open " << tmpPath << " for writing\n";
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && std::fwrite(brickSlot.data(), sizeof(int32_t), numBricks, file) == numBricks;
+    ok = ok && std::fwrite(samples.data(), 1, samples.size(), file) == samples.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) std::remove(tmpPath.c_str());
+    ok = ok && replaceFile(tmpPath, volumePath);
+    if (!ok) std::cerr << "Error: failed writing " << volumePath << "\n";
+    return ok;
+}
+
+bool bakeMeshSDFVolume(const std::string& objPath, const std::string& volumePath,
+                       const SDFBakeOptions& options, int numThreads) {
+    const uint64_t hash = hashFileContents(objPath);
+    std::shared_ptr<const MeshSDF> mesh = hash != 0 ? MeshSDF::load(objPath) : nullptr;
+    if (!mesh) {
+        std::cerr << "Error: cannot bake " << objPath << "\n";
+        return false;
+    }
+    return bakeSDFVolume(meshSDFField(mesh, numThreads), hash, volumePath, options, numThreads);
+}
+
+bool SDFVolume::open(const std::string& volumePath, uint64_t expectedHash) {
+    close();
+    if (!file.open(volumePath)) return false;
+    const char* data = file.data();
+    const size_t size = file.size();
+
+    // Validate before trusting any offsets
+    VolumeHeader header;
+    bool valid = size >= sizeof(header);
+    if (valid) {
+        std::memcpy(&header, data, sizeof(header));
+        valid = std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                header.resolution > 0 && header.resolution <= MAX_RESOLUTION &&
+                header.brickSize > 0 && header.brickSize <= MAX_RESOLUTION &&
+                (header.quantized == 0 || header.quantized == 1) &&
+                header.minBound < header.maxBound && header.band > 0.0f;
+    }
+    if (valid && header.contentHash != expectedHash) {
+        std::cerr << "Note: " << volumePath << " is stale (source content changed)\n";
+        valid = false;
+    }
+    if (valid) {
+        res = header.resolution;
+        brick = header.brickSize;
+        bricksPerAxis = (res + brick - 1) / brick;
+        side = brick + 1;
+        quantized = header.quantized != 0;
+        minBound = header.minBound;
+        maxBound = header.maxBound;
+        cellSize = (header.maxBound - header.minBound) / res;
+        band = header.band;
+        numStored = header.numStored;
+        brickBytes = size_t(side) * side * side * (quantized ? sizeof(int16_t) : sizeof(float));
+        const size_t tableBytes = totalBricks() * sizeof(int32_t);
+        valid = numStored <= totalBricks() &&
+                size == sizeof(header) + tableBytes + numStored * brickBytes;
+        brickSlot = reinterpret_cast<const int32_t*>(data + sizeof(header));
+        bricks = data + sizeof(header) + tableBytes;
+    }
+    // Every slot must name a stored brick or a far sign
+    for (size_t b = 0; valid && b < totalBricks(); ++b) {
+        valid = brickSlot[b] >= -2 && (brickSlot[b] < 0 || size_t(brickSlot[b]) < numStored);
+    }
+    if (!valid) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool SDFVolume::matches(const SDFBakeOptions& options) const {
+    return isOpen() && res == options.resolution && brick == options.brickSize &&
+           quantized == options.quantize && minBound == options.minBound &&
+           maxBound == options.maxBound && band == bandWidth(options);
+}
+
+void SDFVolume::close() {
+    file.close();
+    brickSlot = nullptr;
+    bricks = nullptr;
+    numStored = 0;
+}
+
+SDFVolume::Location SDFVolume::locate(float x, float y, float z) const {
+    Location loc;
+    const float p[3] = {x, y, z};
+    const float latticeMax = minBound + res * cellSize;
+    float outside2 = 0.0f;
+    int b[3];
+    for (int a = 0; a < 3; ++a) {
+        const float clamped = std::min(std::max(p[a], minBound), latticeMax);
+        outside2 += (p[a] - clamped) * (p[a] - clamped);
+        const float u = (clamped - minBound) / cellSize;
+        const int i0 = std::min(std::max(static_cast<int>(std::floor(u)), 0), res - 1);
+        loc.t[a] = std::min(u - i0, 1.0f);
+        b[a] = i0 / brick;
+        loc.base[a] = i0;
+        loc.l[a] = i0 - b[a] * brick;
+    }
+    loc.outside = std::sqrt(outside2);
+
+    const int32_t slot = brickSlot[b[0] + size_t(bricksPerAxis) * (b[1] + size_t(bricksPerAxis) * b[2])];
+    loc.brick = slot >= 0 ? bricks + slot * brickBytes : nullptr;
+    loc.far = slot == -2 ? -band : band;
+    return loc;
+}
+
+float SDFVolume::value(const char* brickData, int li, int lj, int lk) const {
+    const size_t idx = li + size_t(side) * (lj + size_t(side) * lk);
+    if (quantized) {
+        int16_t q;
+        std::memcpy(&q, brickData + idx * sizeof(int16_t), sizeof(q));
+        return q * (band / QUANT_SCALE);
+    }
+    float v;
+    std::memcpy(&v, brickData + idx * sizeof(float), sizeof(v));
+    return v;
+}
+
+float SDFVolume::sample(float x, float y, float z) const {
+    const Location loc = locate(x, y, z);
+    if (!loc.brick) return loc.far + loc.outside;
+    float result = 0.0f;
+    for (int c = 0; c < 8; ++c) {
+        const int dx = c & 1, dy = (c >> 1) & 1, dz = (c >> 2) & 1;
+        const float w = (dx ? loc.t[0] : 1.0f - loc.t[0]) *
+                        (dy ? loc.t[1] : 1.0f - loc.t[1]) *
+                        (dz ? loc.t[2] : 1.0f - loc.t[2]);
+        result += w * value(loc.brick, loc.l[0] + dx, loc.l[1] + dy, loc.l[2] + dz);
+    }
+    return result + loc.outside;
+}
+
+// Catmull-Rom weights of the samples at offsets -1, 0, 1, 2
+static void catmullRomWeights(float t, float w[4]) {
+    const float t2 = t * t, t3 = t2 * t;
+    w[0] = 0.5f * (-t3 + 2.0f * t2 - t);
+    w[1] = 0.5f * (3.0f * t3 - 5.0f * t2 + 2.0f);
+    w[2] = 0.5f * (-3.0f * t3 + 4.0f * t2 + t);
+    w[3] = 0.5f * (t3 - t2);
+}
+
+float SDFVolume::latticeValue(int i, int j, int k) const {
+    i = std::min(std::max(i, 0), res);
+    j = std::min(std::max(j, 0), res);
+    k = std::min(std::max(k, 0), res);
+    const int bi = std::min(i / brick, bricksPerAxis - 1);
+    const int bj = std::min(j / brick, bricksPerAxis - 1);
+    const int bk = std::min(k / brick, bricksPerAxis - 1);
+    const int32_t slot = brickSlot[bi + size_t(bricksPerAxis) * (bj + size_t(bricksPerAxis) * bk)];
+    if (slot < 0) return slot == -2 ? -band : band;
+    return value(bricks + slot * brickBytes, i - bi * brick, j - bj * brick, k - bk * brick);
+}
+
+float SDFVolume::sampleCubic(float x, float y, float z) const {
+    const Location loc = locate(x, y, z);
+    if (!loc.brick) return loc.far + loc.outside;
+
+    // The 4^3 stencil reaches into neighbouring bricks, so taps go through
+    // the global lattice
+    const int i0 = loc.base[0], j0 = loc.base[1], k0 = loc.base[2];
+    float w[3][4];
+    for (int a = 0; a < 3; ++a) catmullRomWeights(loc.t[a], w[a]);
+    float result = 0.0f;
+    for (int dz = 0; dz < 4; ++dz)
+        for (int dy = 0; dy < 4; ++dy)
+            for (int dx = 0; dx < 4; ++dx) {
+                result += w[0][dx] * w[1][dy] * w[2][dz] *
+                          latticeValue(i0 + dx - 1, j0 + dy - 1, k0 + dz - 1);
+            }
+    return result + loc.outside;
+}
+
+// Module-level volume behind the ScalarField binding
+static SDFVolume g_volume;
+
+bool loadCachedMeshSDF(const std::string& objPath, const std::string& volumePath,
+                       const SDFBakeOptions& options) {
+    const uint64_t hash = hashFileContents(objPath);
+    if (hash == 0) {
+        std::cerr << "Failed to read OBJ: " << objPath << std::endl;
+        return false;
+    }
+    if (g_volume.open(volumePath, hash)) {
+        if (g_volume.matches(options)) return true;
+        std::cerr << "Note: " << volumePath << " was baked with other options, baking again\n";
+        g_volume.close();
+    }
+    return bakeMeshSDFVolume(objPath, volumePath, options) && g_volume.open(volumePath, hash);
+}
+
+float implicitCachedMeshSDF(float x, float y, float z) {
+    if (!g_volume.isOpen()) {
+        std::cerr << "Error: loadCachedMeshSDF() must be called before implicitCachedMeshSDF()" << std::endl;
+        return 1.0f;
+    }
+    return g_volume.sample(x, y, z);
+}
+
+float implicitCachedMeshSDFCubic(float x, float y, float z) {
+    if (!g_volume.isOpen()) {
+        std::cerr << "Error: loadCachedMeshSDF() must be called before implicitCachedMeshSDFCubic()" << std::endl;
+        return 1.0f;
+    }
+    return g_volume.sampleCubic(x, y, z);
+}
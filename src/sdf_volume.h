@@ -0,0 +1,95 @@
+#pragma once
+#include "implicit.h"
+#include "mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Narrow-band SDF volume baked to disk and memory-mapped on later runs, so a
+// mesh shape can be sampled without loading the OBJ or building its AABB tree.
+//
+// The lattice has resolution^3 cells over [minBound, maxBound]^3, split into
+// bricks of brickSize^3 cells. Only bricks within the band of the surface are
+// stored; the others keep just their sign (a far value of +-band). A stored
+// brick holds its (brickSize+1)^3 corner samples, clamped to [-band, band], so
+// a trilinear lookup stays inside one brick. Samples are floats, or int16
+// fixed point over [-band, band] when quantized.
+struct SDFBakeOptions {
+    int   resolution = 128;
+    int   brickSize = 8;
+    float bandCells = 4.0f;  // narrow-band half-width, in cells
+    bool  quantize = false;
+    float minBound = -1.0f;
+    float maxBound = 1.0f;
+};
+
+// Bake f into a volume file tagged with contentHash. The file is written to a
+// temporary and renamed into place. Returns false and prints an error if it
+// cannot be written.
+bool bakeSDFVolume(const ImplicitField& f, uint64_t contentHash, const std::string& volumePath,
+                   const SDFBakeOptions& options = SDFBakeOptions(), int numThreads = 0);
+
+// Bake the pseudonormal SDF of an OBJ, normalised as by MeshSDF::load.
+bool bakeMeshSDFVolume(const std::string& objPath, const std::string& volumePath,
+                       const SDFBakeOptions& options = SDFBakeOptions(), int numThreads = 0);
+
+class SDFVolume {
+public:
+    SDFVolume() = default;
+    ~SDFVolume() { close(); }
+    SDFVolume(const SDFVolume&) = delete;
+    SDFVolume& operator=(const SDFVolume&) = delete;
+
+    // Map a volume file. Fails if the file is missing or malformed, or if its
+    // content hash differs from expectedHash (a stale bake).
+    bool open(const std::string& volumePath, uint64_t expectedHash);
+    void close();
+    // Whether the open volume was baked with these options (resolution, brick
+    // size, band, quantization and bounds).
+    bool matches(const SDFBakeOptions& options) const;
+    bool isOpen() const { return file.isOpen(); }
+
+    // Interpolated distance; points outside the lattice are clamped onto it
+    // and the distance to the lattice box is added.
+    float sample(float x, float y, float z) const;       // trilinear
+    float sampleCubic(float x, float y, float z) const;  // Catmull-Rom tricubic
+
+    int    resolution() const { return res; }
+    size_t storedBricks() const { return numStored; }
+    size_t totalBricks() const { return size_t(bricksPerAxis) * bricksPerAxis * bricksPerAxis; }
+    size_t fileBytes() const { return file.size(); }
+
+private:
+    // The brick holding a point (nullptr for a far brick, whose value is far),
+    // the lattice corner below it, globally and brick-local, and the fractions
+    // past it.
+    struct Location {
+        const char* brick;
+        float far;
+        int base[3];
+        int l[3];
+        float t[3];
+        float outside;  // distance from the point to the lattice box
+    };
+    Location locate(float x, float y, float z) const;
+    float value(const char* brick, int li, int lj, int lk) const;
+    float latticeValue(int i, int j, int k) const;  // clamped onto the lattice
+
+    MappedFile file;
+
+    int res = 0, brick = 0, bricksPerAxis = 0, side = 0;
+    bool quantized = false;
+    float minBound = 0.0f, maxBound = 0.0f, cellSize = 1.0f, band = 0.0f;
+    size_t numStored = 0, brickBytes = 0;
+    const int32_t* brickSlot = nullptr;  // >= 0 slot, -1 far outside, -2 far inside
+    const char* bricks = nullptr;
+};
+
+// ScalarField binding, in the style of loadMeshSDF/implicitMeshSDF: open the
+// volume cached at volumePath for objPath, (re)baking it first when it is
+// missing, stale or baked with other options. The cached field is meant for interactive previews; for an
+// exact final pass bind a MeshSDF of the same OBJ instead.
+bool loadCachedMeshSDF(const std::string& objPath, const std::string& volumePath,
+                       const SDFBakeOptions& options = SDFBakeOptions());
+float implicitCachedMeshSDF(float x, float y, float z);       // trilinear
+float implicitCachedMeshSDFCubic(float x, float y, float z);  // tricubic
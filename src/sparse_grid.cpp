@@ -0,0 +1,286 @@
+#include "sparse_grid.h"
+#include "parallel.h"
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static const int B = SparseDCGrid::BRICK;
+static const int BRICK_SAMPLES = (B + 1) * (B + 1) * (B + 1);
+
+// Work granularity for the list-based passes (edges / cells per task)
+static const size_t ITEMS_PER_TASK = 4096;
+
+static inline int64_t cornerKey(int i, int j, int k, int N) {
+    return i + int64_t(N + 1) * (j + int64_t(N + 1) * k);
+}
+
+static inline int64_t cellKey(int ci, int cj, int ck, int N) {
+    return ci + int64_t(N) * (cj + int64_t(N) * ck);
+}
+
+static inline int localIdx(int li, int lj, int lk) {
+    return li + (B + 1) * (lj + (B + 1) * lk);
+}
+
+// The brick that owns lattice coordinate c (the last brick also owns c == N)
+static inline int ownerBrick(int c, int bricksPerAxis) {
+    return std::min(c / B, bricksPerAxis - 1);
+}
+
+// Within one task, lookups arrive in ascending key order (the cell -> edge and
+// edge -> cell key offsets are constant), so each lookup gallops forward from
+// the previous result instead of bisecting the whole array.
+template <class It, class KeyOf>
+static It gallopTo(It first, It last, int64_t key, KeyOf keyOf) {
+    size_t step = 1;
+    It lo = first;
+    while (step < size_t(last - lo) && keyOf(lo[step]) < key) {
+        lo += step;
+        step *= 2;
+    }
+    It hi = lo + std::min(step, size_t(last - lo));
+    return std::lower_bound(lo, hi, key, [&](const auto& e, int64_t k) { return keyOf(e) < k; });
+}
+
+static int64_t edgeKeyOf(const SparseHermiteEdge& e) { return e.key; }
+static int64_t cellKeyOf(int64_t key) { return key; }
+
+float SparseDCGrid::value(int i, int j, int k) const {
+    const int bi = ownerBrick(i, bricksPerAxis);
+    const int bj = ownerBrick(j, bricksPerAxis);
+    const int bk = ownerBrick(k, bricksPerAxis);
+    const int brick = bi + bricksPerAxis * (bj + bricksPerAxis * bk);
+    const int slot = brickSlot[brick];
+    if (slot < 0) return brickFill[brick];
+    return values[size_t(slot) * BRICK_SAMPLES + localIdx(i - bi * B, j - bj * B, k - bk * B)];
+}
+
+size_t SparseDCGrid::memoryBytes() const {
+    size_t bytes = brickSlot.capacity() * sizeof(int) + brickFill.capacity() * sizeof(float) +
+                   slotBrick.capacity() * sizeof(int) + values.capacity() * sizeof(float) +
+                   activeCells.capacity() * sizeof(int64_t);
+    for (const auto& e : edges) bytes += e.capacity() * sizeof(SparseHermiteEdge);
+    return bytes;
+}
+
+SparseDCGrid buildSparseGrid(const ImplicitField& f, int N, float minBound, float maxBound,
+                             int numThreads, float safetyFactor) {
+    SparseDCGrid grid;
+    grid.N = N;
+    grid.minBound = minBound;
+    grid.maxBound = maxBound;
+    grid.cellSize = (maxBound - minBound) / N;
+    const int nb = (N + B - 1) / B;
+    grid.bricksPerAxis = nb;
+    const float cellSize = grid.cellSize;
+
+    // Coarse pass: one sample at every brick centre, one row of bricks per batch
+    const int numBricks = nb * nb * nb;
+    std::vector<float> centreValue(numBricks);
+    std::vector<float> xs(nb);
+    for (int bi = 0; bi < nb; ++bi) xs[bi] = minBound + (bi * B + 0.5f * B) * cellSize;
+    parallelFor(0, nb, numThreads, [&](int bk) {
+        std::vector<float> ys(nb), zs(nb, minBound + (bk * B + 0.5f * B) * cellSize);
+        for (int bj = 0; bj < nb; ++bj) {
+            std::fill(ys.begin(), ys.end(), minBound + (bj * B + 0.5f * B) * cellSize);
+            f.evaluate(xs.data(), ys.data(), zs.data(), &centreValue[nb * (bj + nb * bk)], nb);
+        }
+    });
+
+    // Occupancy: the surface can only cross a brick whose centre is within a
+    // half-diagonal of it. Slots are assigned in brick scan order.
+    const float halfDiagonal = 0.5f * std::sqrt(3.0f) * B * cellSize;
+    const float reach = std::max(safetyFactor, 1.0f) * halfDiagonal;
+    grid.brickSlot.assign(numBricks, -1);
+    grid.brickFill.assign(numBricks, 0.0f);
+    for (int b = 0; b < numBricks; ++b) {
+        const float fc = centreValue[b];
+        if (std::abs(fc) <= reach) {
+            grid.brickSlot[b] = static_cast<int>(grid.slotBrick.size());
+            grid.slotBrick.push_back(b);
+        } else {
+            // |f| >= |f(centre)| - halfDiagonal everywhere in the brick
+            const float bound = std::max(std::abs(fc) - halfDiagonal,
+                                         std::numeric_limits<float>::min());
+            grid.brickFill[b] = fc < 0.0f ? -bound : bound;
+        }
+    }
+
+    // Fine pass: all (B+1)^3 corners of every allocated brick, one row per batch
+    grid.values.resize(size_t(grid.slotBrick.size()) * BRICK_SAMPLES);
+    parallelFor(0, grid.allocatedBricks(), numThreads, [&](int slot) {
+        const int b = grid.slotBrick[slot];
+        const int bi = b % nb, bj = (b / nb) % nb, bk = b / (nb * nb);
+        float bx[B + 1], by[B + 1], bz[B + 1];
+        for (int l = 0; l <= B; ++l) bx[l] = minBound + (bi * B + l) * cellSize;
+        float* out = &grid.values[size_t(slot) * BRICK_SAMPLES];
+        for (int lk = 0; lk <= B; ++lk) {
+            std::fill(bz, bz + B + 1, minBound + (bk * B + lk) * cellSize);
+            for (int lj = 0; lj <= B; ++lj) {
+                std::fill(by, by + B + 1, minBound + (bj * B + lj) * cellSize);
+                f.evaluate(bx, by, bz, out + localIdx(0, lj, lk), B + 1);
+            }
+        }
+    });
+
+    return grid;
+}
+
+DCMesh dualContour(const ImplicitField& f, SparseDCGrid& grid, int numThreads) {
+    DCMesh mesh;
+    const int N = grid.N;
+    const int nb = grid.bricksPerAxis;
+    const float minBound = grid.minBound;
+    const float cellSize = grid.cellSize;
+
+    // Lattice range [lo, hi) owned by brick coordinate b; the last brick also owns N
+    auto ownedRange = [&](int b, int& lo, int& hi) {
+        lo = b * B;
+        hi = (b == nb - 1) ? N + 1 : lo + B;
+    };
+
+    // Pass 0: Hermite data for the sign-changing edges owned by each allocated
+    // brick. An empty brick has a single sign over its closed box, so every
+    // crossing edge is owned by an allocated brick and both of its corners are
+    // among that brick's samples.
+    for (int axis = 0; axis < 3; ++axis) {
+        auto& edges = grid.edges[axis];
+        edges.clear();
+        parallelGather(grid.allocatedBricks(), numThreads, edges,
+                       [&](int slot, std::vector<SparseHermiteEdge>& out) {
+            const int b = grid.slotBrick[slot];
+            const int bc[3] = {b % nb, (b / nb) % nb, b / (nb * nb)};
+            int lo[3], hi[3];
+            for (int a = 0; a < 3; ++a) ownedRange(bc[a], lo[a], hi[a]);
+            hi[axis] = std::min(hi[axis], N);  // the edge must end inside the lattice
+            const float* vals = &grid.values[size_t(slot) * BRICK_SAMPLES];
+            const int step = axis == 0 ? 1 : axis == 1 ? (B + 1) : (B + 1) * (B + 1);
+
+            for (int k = lo[2]; k < hi[2]; ++k) {
+                for (int j = lo[1]; j < hi[1]; ++j) {
+                    for (int i = lo[0]; i < hi[0]; ++i) {
+                        const int l = localIdx(i - lo[0], j - lo[1], k - lo[2]);
+                        const float f0 = vals[l];
+                        const float f1 = vals[l + step];
+                        if ((f0 < 0) == (f1 < 0)) continue;  // No sign change
+
+                        Eigen::Vector3f p0(minBound + i * cellSize,
+                                           minBound + j * cellSize,
+                                           minBound + k * cellSize);
+                        Eigen::Vector3f p1 = p0;
+                        p1[axis] = minBound + ((axis == 0 ? i : axis == 1 ? j : k) + 1) * cellSize;
+                        out.push_back({cornerKey(i, j, k, N), f1 > f0, edgeHermite(f, p0, p1, f0, f1)});
+                    }
+                }
+            }
+        });
+        // Dense scan order, so quads come out in the same order as the dense path
+        std::sort(edges.begin(), edges.end(),
+                  [](const SparseHermiteEdge& a, const SparseHermiteEdge& b) { return a.key < b.key; });
+    }
+
+    // Pass 1a: cells with mixed corner signs, sorted into dense scan order
+    grid.activeCells.clear();
+    parallelGather(grid.allocatedBricks(), numThreads, grid.activeCells,
+                   [&](int slot, std::vector<int64_t>& out) {
+        const int b = grid.slotBrick[slot];
+        const int bc[3] = {b % nb, (b / nb) % nb, b / (nb * nb)};
+        int lo[3], hi[3];
+        for (int a = 0; a < 3; ++a) {
+            ownedRange(bc[a], lo[a], hi[a]);
+            hi[a] = std::min(hi[a], N);
+        }
+        const float* vals = &grid.values[size_t(slot) * BRICK_SAMPLES];
+        for (int ck = lo[2]; ck < hi[2]; ++ck) {
+            for (int cj = lo[1]; cj < hi[1]; ++cj) {
+                for (int ci = lo[0]; ci < hi[0]; ++ci) {
+                    const int l = localIdx(ci - lo[0], cj - lo[1], ck - lo[2]);
+                    const bool inside = vals[l] < 0;
+                    for (int c = 1; c < 8; ++c) {
+                        const int lc = l + localIdx(c & 1, (c >> 1) & 1, (c >> 2) & 1);
+                        if ((vals[lc] < 0) != inside) {
+                            out.push_back(cellKey(ci, cj, ck, N));
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    });
+    std::sort(grid.activeCells.begin(), grid.activeCells.end());
+
+    // Pass 1b: one vertex per active cell; vertex v belongs to activeCells[v]
+    mesh.vertices.resize(grid.activeCells.size());
+    parallelFor(0, chunkCount(grid.activeCells.size(), ITEMS_PER_TASK), numThreads, [&](int task) {
+        const size_t end = std::min(grid.activeCells.size(), (task + 1) * ITEMS_PER_TASK);
+        std::vector<SparseHermiteEdge>::const_iterator cursor[12];
+        for (int e = 0; e < 12; ++e) cursor[e] = grid.edges[e / 4].begin();
+        for (size_t v = task * ITEMS_PER_TASK; v < end; ++v) {
+            const int64_t key = grid.activeCells[v];
+            const int ci = static_cast<int>(key % N);
+            const int cj = static_cast<int>((key / N) % N);
+            const int ck = static_cast<int>(key / (int64_t(N) * N));
+
+            // Accumulate the QEF in the same edge order as the dense path
+            QEF qef;
+            for (int e = 0; e < 12; ++e) {
+                const int c0 = EDGE_CORNERS[e][0];
+                const int64_t edgeKey = cornerKey(ci + (c0 & 1), cj + ((c0 >> 1) & 1),
+                                                  ck + ((c0 >> 2) & 1), N);
+                const auto& edges = grid.edges[e / 4];
+                cursor[e] = gallopTo(cursor[e], edges.end(), edgeKey, edgeKeyOf);
+                if (cursor[e] != edges.end() && cursor[e]->key == edgeKey) {
+                    qef.add(cursor[e]->hermite);
+                }
+            }
+
+            Eigen::Vector3f cellMin(minBound + ci * cellSize,
+                                    minBound + cj * cellSize,
+                                    minBound + ck * cellSize);
+            Eigen::Vector3f cellMax(minBound + (ci+1) * cellSize,
+                                    minBound + (cj+1) * cellSize,
+                                    minBound + (ck+1) * cellSize);
+            Eigen::Vector3f vertex = qef.solve(cellMin, cellMax);
+            mesh.vertices[v] = {vertex.x(), vertex.y(), vertex.z()};
+        }
+    });
+
+    // Pass 2: one quad per sign-changing edge, X then Y then Z, in key order
+    for (int axis = 0; axis < 3; ++axis) {
+        const auto& edges = grid.edges[axis];
+        parallelGather(chunkCount(edges.size(), ITEMS_PER_TASK), numThreads, mesh.triangles,
+                       [&](int task, std::vector<std::array<int,3>>& out) {
+            const size_t end = std::min(edges.size(), (task + 1) * ITEMS_PER_TASK);
+            const auto cellsBegin = grid.activeCells.cbegin(), cellsEnd = grid.activeCells.cend();
+            std::vector<int64_t>::const_iterator cursor[4] = {cellsBegin, cellsBegin, cellsBegin, cellsBegin};
+            for (size_t e = task * ITEMS_PER_TASK; e < end; ++e) {
+                const SparseHermiteEdge& edge = edges[e];
+                const int i = static_cast<int>(edge.key % (N + 1));
+                const int j = static_cast<int>((edge.key / (N + 1)) % (N + 1));
+                const int k = static_cast<int>(edge.key / (int64_t(N + 1) * (N + 1)));
+                int v[4];
+                bool complete = true;
+                for (int c = 0; c < 4 && complete; ++c) {
+                    const int ci = i + QUAD_CELLS[axis][c][0];
+                    const int cj = j + QUAD_CELLS[axis][c][1];
+                    const int ck = k + QUAD_CELLS[axis][c][2];
+                    if (ci < 0 || cj < 0 || ck < 0 || ci >= N || cj >= N || ck >= N) {
+                        complete = false;
+                        break;
+                    }
+                    const int64_t key = cellKey(ci, cj, ck, N);
+                    cursor[c] = gallopTo(cursor[c], cellsEnd, key, cellKeyOf);
+                    complete = cursor[c] != cellsEnd && *cursor[c] == key;
+                    if (complete) v[c] = static_cast<int>(cursor[c] - cellsBegin);
+                }
+                if (!complete) continue;
+
+                appendQuad(v, axis, edge.rising, out);
+            }
+        });
+    }
+
+    removeDegenerateTriangles(mesh, numThreads);
+    return mesh;
+}
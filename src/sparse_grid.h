@@ -0,0 +1,60 @@
+#pragma once
+#include "dual_contour.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One sign-changing edge of a SparseDCGrid, keyed by the linear index of its
+// lower corner (i + (N+1)*j + (N+1)^2*k).
+struct SparseHermiteEdge {
+    int64_t key;
+    bool rising;
+    HermiteSample hermite;
+};
+
+// Block-sparse alternative to DCGrid for high resolutions. The corner lattice
+// is split into bricks of BRICK^3 cells, and only bricks that may contain the
+// zero level set store their (BRICK+1)^3 corner samples. Every other brick
+// keeps one conservative value: the sign of the field there plus a lower bound
+// on its magnitude. That is all dualContour needs from a brick the surface
+// cannot cross.
+struct SparseDCGrid {
+    static const int BRICK = 8;
+
+    int N;
+    float minBound, maxBound, cellSize;
+    int bricksPerAxis;                 // ceil(N / BRICK)
+
+    // Coarse occupancy map, bricksPerAxis^3 in (bi, bj, bk) scan order:
+    // slot of the brick's samples, or -1 for an empty brick.
+    std::vector<int>   brickSlot;
+    std::vector<float> brickFill;      // per brick: sign-only fill used when empty
+    std::vector<int>   slotBrick;      // per slot: linear brick index
+    std::vector<float> values;         // per slot: (BRICK+1)^3 corner samples, x fastest
+
+    // Filled by dualContour. Edges are sorted by key per axis; activeCells holds
+    // the linear index (ci + N*cj + N*N*ck) of every cell with a vertex, in
+    // ascending order, and the vertex of activeCells[v] is mesh vertex v.
+    std::vector<SparseHermiteEdge> edges[3];
+    std::vector<int64_t>           activeCells;
+
+    int allocatedBricks() const { return static_cast<int>(slotBrick.size()); }
+
+    // Corner sample at lattice point (i, j, k), 0 <= i, j, k <= N. Corners of
+    // empty bricks return the brick's sign-only fill.
+    float value(int i, int j, int k) const;
+
+    // Bytes held by the grid (occupancy map, samples and contouring data).
+    size_t memoryBytes() const;
+};
+
+// Sample only the bricks near the zero level set. A brick is skipped when
+// |f(centre)| > safetyFactor * (brick half-diagonal), which is exact for a
+// signed distance field; safetyFactor > 1 covers fields that only bound the
+// distance loosely.
+SparseDCGrid buildSparseGrid(const ImplicitField& f, int N, float minBound=-1.f, float maxBound=1.f,
+                             int numThreads=0, float safetyFactor=1.f);
+
+// Dual contouring directly on the sparse grid. Produces the same vertices, in
+// the same order, and the same triangles as the dense path would.
+DCMesh dualContour(const ImplicitField& f, SparseDCGrid& grid, int numThreads=0);
@@ -0,0 +1,269 @@
+#include "streaming.h"
+#include "qef.h"
+#include "parallel.h"
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <future>
+
+// Work granularity for the list-based passes (edges per task)
+static const size_t ITEMS_PER_TASK = 4096;
+
+// Sign-changing edges of one slice along one axis, in (j, i) scan order, with
+// an (N+1)^2 lookup from the edge's lower corner to its slot (-1 = none).
+struct SliceEdges {
+    std::vector<HermiteEdge> list;
+    std::vector<int>         index;
+
+    size_t bytes() const { return list.capacity() * sizeof(HermiteEdge) + index.capacity() * sizeof(int); }
+};
+
+// Vertices of one cell layer: global vertex id per cell (-1 = none) and the
+// positions of the layer's vertices, whose ids start at base.
+struct CellLayer {
+    std::vector<int>                 vertexIndex;
+    std::vector<std::array<float,3>> positions;
+    int                              base = 0;
+
+    size_t bytes() const {
+        return vertexIndex.capacity() * sizeof(int) + positions.capacity() * sizeof(positions[0]);
+    }
+};
+
+struct StreamContext {
+    const ImplicitField& f;
+    int N;
+    float minBound, cellSize;
+    int numThreads;
+
+    int sliceIdx(int i, int j) const { return i + (N + 1) * j; }
+};
+
+static void sampleSlice(const StreamContext& ctx, int k, std::vector<float>& values, int numThreads) {
+    const int N = ctx.N;
+    values.resize(size_t(N + 1) * (N + 1));
+    std::vector<float> xs(N + 1);
+    for (int i = 0; i <= N; ++i) xs[i] = ctx.minBound + i * ctx.cellSize;
+
+    // Same row batches as buildGrid, so the samples are identical
+    parallelFor(0, N + 1, numThreads, [&](int j) {
+        std::vector<float> ys(N + 1, ctx.minBound + j * ctx.cellSize);
+        std::vector<float> zs(N + 1, ctx.minBound + k * ctx.cellSize);
+        ctx.f.evaluate(xs.data(), ys.data(), zs.data(), &values[ctx.sliceIdx(0, j)], N + 1);
+    });
+}
+
+// Edges along axis with lower corner in slice k. X/Y edges lie in `lower`;
+// Z edges run from `lower` (slice k) to `upper` (slice k+1).
+static void buildSliceEdges(const StreamContext& ctx, int axis, int k,
+                            const std::vector<float>& lower, const std::vector<float>& upper,
+                            SliceEdges& out) {
+    const int N = ctx.N;
+    const int iEnd = axis == 0 ? N : N + 1;
+    const int jEnd = axis == 1 ? N : N + 1;
+    const int step = axis == 0 ? 1 : axis == 1 ? N + 1 : 0;
+    const std::vector<float>& far = axis == 2 ? upper : lower;
+
+    out.list.clear();
+    parallelGather(jEnd, ctx.numThreads, out.list, [&](int j, std::vector<HermiteEdge>& edges) {
+        for (int i = 0; i < iEnd; ++i) {
+            const int idx = ctx.sliceIdx(i, j);
+            const float f0 = lower[idx];
+            const float f1 = far[idx + step];
+            if ((f0 < 0) == (f1 < 0)) continue;
+
+            // Same arithmetic as buildHermiteEdges
+            Eigen::Vector3f p0(ctx.minBound + i * ctx.cellSize,
+                               ctx.minBound + j * ctx.cellSize,
+                               ctx.minBound + k * ctx.cellSize);
+            Eigen::Vector3f p1 = p0;
+            p1[axis] = ctx.minBound + ((axis == 0 ? i : axis == 1 ? j : k) + 1) * ctx.cellSize;
+            edges.push_back({i, j, k, f1 > f0, edgeHermite(ctx.f, p0, p1, f0, f1)});
+        }
+    });
+
+    out.index.assign(size_t(N + 1) * (N + 1), -1);
+    for (size_t e = 0; e < out.list.size(); ++e) {
+        out.index[ctx.sliceIdx(out.list[e].i, out.list[e].j)] = static_cast<int>(e);
+    }
+}
+
+// One vertex per cell of layer ck with a sign change, numbered from base in
+// (cj, ci) order: rows are counted, prefix-summed, then solved in parallel.
+static void buildLayerVertices(const StreamContext& ctx, int ck,
+                               const std::vector<float>& lower, const std::vector<float>& upper,
+                               const SliceEdges lowerEdges[2], const SliceEdges upperEdges[2],
+                               const SliceEdges& zEdges, CellLayer& layer) {
+    const int N = ctx.N;
+    auto hasSignChange = [&](int ci, int cj) {
+        const bool inside = lower[ctx.sliceIdx(ci, cj)] < 0;
+        for (int c = 1; c < 8; ++c) {
+            const std::vector<float>& slice = (c >> 2) & 1 ? upper : lower;
+            if ((slice[ctx.sliceIdx(ci + (c & 1), cj + ((c >> 1) & 1))] < 0) != inside) return true;
+        }
+        return false;
+    };
+
+    std::vector<int> rowOffset(N + 1, 0);
+    parallelFor(0, N, ctx.numThreads, [&](int cj) {
+        int active = 0;
+        for (int ci = 0; ci < N; ++ci) {
+            if (hasSignChange(ci, cj)) ++active;
+        }
+        rowOffset[cj + 1] = active;
+    });
+    for (int cj = 0; cj < N; ++cj) rowOffset[cj + 1] += rowOffset[cj];
+
+    layer.vertexIndex.assign(size_t(N) * N, -1);
+    layer.positions.resize(rowOffset[N]);
+    parallelFor(0, N, ctx.numThreads, [&](int cj) {
+        int local = rowOffset[cj];
+        for (int ci = 0; ci < N; ++ci) {
+            if (!hasSignChange(ci, cj)) continue;
+
+            // Same edge order as dualContour's pass 1, so the vertex is identical
+            QEF qef;
+            for (int e = 0; e < 12; ++e) {
+                const int axis = e / 4;
+                const int c0 = EDGE_CORNERS[e][0];
+                const SliceEdges& edges = axis == 2 ? zEdges
+                                        : ((c0 >> 2) & 1 ? upperEdges[axis] : lowerEdges[axis]);
+                const int slot = edges.index[ctx.sliceIdx(ci + (c0 & 1), cj + ((c0 >> 1) & 1))];
+                if (slot >= 0) qef.add(edges.list[slot].hermite);
+            }
+
+            Eigen::Vector3f cellMin(ctx.minBound + ci * ctx.cellSize,
+                                    ctx.minBound + cj * ctx.cellSize,
+                                    ctx.minBound + ck * ctx.cellSize);
+            Eigen::Vector3f cellMax(ctx.minBound + (ci+1) * ctx.cellSize,
+                                    ctx.minBound + (cj+1) * ctx.cellSize,
+                                    ctx.minBound + (ck+1) * ctx.cellSize);
+            Eigen::Vector3f vertex = qef.solve(cellMin, cellMax);
+            layer.positions[local] = {vertex.x(), vertex.y(), vertex.z()};
+            layer.vertexIndex[ci + N * cj] = layer.base + local++;
+        }
+    });
+}
+
+// Quads of the edges in `edges`, whose cells lie in layers ck - 1 (prev) and
+// ck (cur). Degenerate triangles are dropped with removeDegenerateTriangles'
+// test, so the surviving set matches the in-memory path.
+static void appendLayerQuads(const StreamContext& ctx, int axis, int ck, const SliceEdges& edges,
+                             const CellLayer& prev, const CellLayer& cur,
+                             std::vector<std::array<int,3>>& triangles) {
+    const int N = ctx.N;
+    auto position = [&](int id) -> Eigen::Vector3f {
+        const auto& p = id >= cur.base ? cur.positions[id - cur.base] : prev.positions[id - prev.base];
+        return Eigen::Vector3f(p[0], p[1], p[2]);
+    };
+
+    const int numTasks = chunkCount(edges.list.size(), ITEMS_PER_TASK);
+    parallelGather(numTasks, ctx.numThreads, triangles,
+                   [&](int task, std::vector<std::array<int,3>>& out) {
+        const size_t end = std::min(edges.list.size(), size_t(task + 1) * ITEMS_PER_TASK);
+        std::vector<std::array<int,3>> quad;
+        for (size_t e = size_t(task) * ITEMS_PER_TASK; e < end; ++e) {
+            const HermiteEdge& edge = edges.list[e];
+            int v[4];
+            bool complete = true;
+            for (int c = 0; c < 4 && complete; ++c) {
+                const int ci = edge.i + QUAD_CELLS[axis][c][0];
+                const int cj = edge.j + QUAD_CELLS[axis][c][1];
+                const int layer = ck + QUAD_CELLS[axis][c][2];
+                if (ci < 0 || cj < 0 || layer < 0 || ci >= N || cj >= N || layer >= N) {
+                    complete = false;
+                    break;
+                }
+                v[c] = (layer == ck ? cur : prev).vertexIndex[ci + N * cj];
+                complete = v[c] >= 0;
+            }
+            if (!complete) continue;
+
+            quad.clear();
+            appendQuad(v, axis, edge.rising, quad);
+            for (const auto& tri : quad) {
+                const Eigen::Vector3f p0 = position(tri[0]);
+                const Eigen::Vector3f p1 = position(tri[1]);
+                const Eigen::Vector3f p2 = position(tri[2]);
+                Eigen::Vector3f n = (p1 - p0).cross(p2 - p0);
+                if (n.squaredNorm() < 1e-12f) continue;
+                out.push_back(tri);
+            }
+        }
+    });
+}
+
+DCStreamStats streamDualContour(const ImplicitField& f, int N, const DCMeshSink& sink,
+                                float minBound, float maxBound, int numThreads) {
+    DCStreamStats stats;
+
+    // Three corner slices rotate: the two around the current layer and the next
+    // one, sampled on a background task while the current layer is contoured.
+    // The background sampler and the contouring passes split the threads
+    // between them, so together they never run more than numThreads.
+    const int threads = resolveThreadCount(numThreads);
+    const bool overlap = threads > 1;
+    const int samplerThreads = overlap ? threads / 2 : threads;
+    StreamContext ctx{f, N, minBound, (maxBound - minBound) / N, overlap ? threads - samplerThreads : threads};
+    std::vector<float> slices[3];
+    std::future<void> pending;
+    auto startSampling = [&](int k) {
+        std::vector<float>& target = slices[k % 3];
+        if (overlap) {
+            pending = std::async(std::launch::async, [&ctx, k, &target, samplerThreads] {
+                sampleSlice(ctx, k, target, samplerThreads);
+            });
+        } else {
+            sampleSlice(ctx, k, target, threads);
+        }
+    };
+
+    SliceEdges lowerEdges[2], upperEdges[2], zEdges;
+    CellLayer prev, cur;
+    std::vector<std::array<int,3>> triangles;
+
+    sampleSlice(ctx, 0, slices[0], threads);
+    startSampling(1);
+    for (int axis = 0; axis < 2; ++axis) {
+        buildSliceEdges(ctx, axis, 0, slices[0], slices[0], lowerEdges[axis]);
+    }
+
+    for (int ck = 0; ck < N; ++ck) {
+        if (pending.valid()) pending.get();
+        const std::vector<float>& lower = slices[ck % 3];
+        const std::vector<float>& upper = slices[(ck + 1) % 3];
+        if (ck + 2 <= N) startSampling(ck + 2);
+
+        for (int axis = 0; axis < 2; ++axis) {
+            buildSliceEdges(ctx, axis, ck + 1, upper, upper, upperEdges[axis]);
+        }
+        buildSliceEdges(ctx, 2, ck, lower, upper, zEdges);
+
+        cur.base = prev.base + static_cast<int>(prev.positions.size());
+        buildLayerVertices(ctx, ck, lower, upper, lowerEdges, upperEdges, zEdges, cur);
+        if (sink.vertices && !cur.positions.empty()) sink.vertices(cur.positions);
+
+        // X/Y edges of slice ck join layers ck-1 and ck; Z edges lie in layer ck
+        triangles.clear();
+        if (ck > 0) {
+            for (int axis = 0; axis < 2; ++axis) {
+                appendLayerQuads(ctx, axis, ck, lowerEdges[axis], prev, cur, triangles);
+            }
+        }
+        appendLayerQuads(ctx, 2, ck, zEdges, prev, cur, triangles);
+        if (sink.triangles && !triangles.empty()) sink.triangles(triangles);
+
+        stats.vertices += cur.positions.size();
+        stats.triangles += triangles.size();
+        size_t bytes = prev.bytes() + cur.bytes() + zEdges.bytes() +
+                       triangles.capacity() * sizeof(triangles[0]);
+        for (const auto& s : slices) bytes += s.capacity() * sizeof(float);
+        for (int axis = 0; axis < 2; ++axis) bytes += lowerEdges[axis].bytes() + upperEdges[axis].bytes();
+        stats.peakBytes = std::max(stats.peakBytes, bytes);
+
+        std::swap(prev, cur);
+        std::swap(lowerEdges, upperEdges);
+    }
+    if (pending.valid()) pending.get();
+    return stats;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "dual_contour.h"
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// Receives a mesh as it is produced, one cell layer at a time. Vertices are
+// numbered in the order they arrive (starting at 0), and a triangle only
+// arrives after all of its vertices.
+struct DCMeshSink {
+    std::function<void(const std::vector<std::array<float,3>>&)> vertices;
+    std::function<void(const std::vector<std::array<int,3>>&)>   triangles;
+};
+
+struct DCStreamStats {
+    size_t vertices = 0;
+    size_t triangles = 0;
+    size_t peakBytes = 0;  // largest working set of the slice/layer buffers
+};
+
+// Sample and contour the grid z-slice by z-slice without ever holding the full
+// DCGrid or DCMesh: only three corner slices (the two around the current cell
+// layer plus the next one, which is sampled in the background on half of the
+// numThreads threads while the rest contour the current layer), the Hermite
+// edges between them and the vertex indices of the last two cell layers are
+// kept, O(N^2) in total.
+// The vertices equal dualContour's on the same grid, in the same order; the
+// triangles are the same set, emitted per layer rather than per axis.
+DCStreamStats streamDualContour(const ImplicitField& f, int N, const DCMeshSink& sink,
+                                float minBound=-1.f, float maxBound=1.f, int numThreads=0);
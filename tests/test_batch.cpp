@@ -0,0 +1,222 @@
+#include "batch.h"
+#include "dual_contour.h"
+#include "implicit.h"
+#include "mesh_io.h"
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static int g_pass = 0, g_fail = 0;
+
+static void check(const char* name, bool cond) {
+    if (cond) {
+        std::cout << "  PASS: " << name << "\n";
+        ++g_pass;
+    } else {
+        std::cout << "  FAIL: " << name << "\n";
+        ++g_fail;
+    }
+}
+
+// The torus as runBatchJob contours it
+static DCMesh torusMesh(int N) {
+    const ImplicitField torus(implicitTorus, implicitTorusBatch, implicitTorusGrad);
+    DCGrid grid = buildGrid(torus, N);
+    return dualContour(torus, grid);
+}
+
+static DCMesh readPLY(const std::string& path) {
+    DCMesh mesh;
+    std::ifstream in(path, std::ios::binary);
+    std::string line;
+    size_t numVertices = 0, numFaces = 0;
+    while (std::getline(in, line) && line != "end_header") {
+        std::istringstream tokens(line);
+        std::string word, element;
+        size_t count = 0;
+        if (tokens >> word >> element >> count && word == "element") {
+            (element == "vertex" ? numVertices : numFaces) = count;
+        }
+    }
+    mesh.vertices.resize(numVertices);
+    in.read(reinterpret_cast<char*>(mesh.vertices.data()), numVertices * sizeof(mesh.vertices[0]));
+    for (size_t t = 0; t < numFaces && in; ++t) {
+        unsigned char count = 0;
+        std::array<int,3> tri;
+        in.read(reinterpret_cast<char*>(&count), 1);
+        in.read(reinterpret_cast<char*>(tri.data()), sizeof(tri));
+        if (in && count == 3) mesh.triangles.push_back(tri);
+    }
+    if (!in || in.peek() != std::char_traits<char>::eof()) mesh.triangles.clear();
+    return mesh;
+}
+
+static DCMesh readOBJ(const std::string& path) {
+    DCMesh mesh;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream tokens(line);
+        std::string kind;
+        tokens >> kind;
+        if (kind == "v") {
+            std::array<std::string,3> text;
+            tokens >> text[0] >> text[1] >> text[2];
+            mesh.vertices.push_back({std::strtof(text[0].c_str(), nullptr), std::strtof(text[1].c_str(), nullptr),
+                                     std::strtof(text[2].c_str(), nullptr)});
+        } else if (kind == "f") {
+            std::array<int,3> tri;
+            tokens >> tri[0] >> tri[1] >> tri[2];
+            mesh.triangles.push_back({tri[0] - 1, tri[1] - 1, tri[2] - 1});
+        }
+    }
+    return mesh;
+}
+
+// ---- Test 1: Writers -----------------------------------------------------------------
+static void testWriters() {
+    std::cout << "Test 1: PLY, STL and OBJ writers\n";
+    const DCMesh mesh = torusMesh(48);
+
+    check("PLY written", writeMesh("test_batch.ply", mesh));
+    const DCMesh ply = readPLY("test_batch.ply");
+    check("PLY round trip", ply.vertices == mesh.vertices && ply.triangles == mesh.triangles);
+
+    check("OBJ written", writeMesh("test_batch.OBJ", mesh));
+    const DCMesh obj = readOBJ("test_batch.OBJ");
+    check("OBJ round trip (exact floats)", obj.vertices == mesh.vertices && obj.triangles == mesh.triangles);
+
+    check("STL written", writeMesh("test_batch.stl", mesh));
+    std::ifstream stl("test_batch.stl", std::ios::binary);
+    char header[80];
+    uint32_t count = 0;
+    stl.read(header, sizeof(header));
+    stl.read(reinterpret_cast<char*>(&count), sizeof(count));
+    bool corners = count == mesh.triangles.size(), normals = true;
+    for (uint32_t t = 0; t < count && stl; ++t) {
+        char record[50];
+        stl.read(record, sizeof(record));
+        float v[12];
+        std::memcpy(v, record, sizeof(v));
+        for (int k = 0; k < 3; ++k)
+            for (int a = 0; a < 3; ++a) corners = corners && v[3 + 3 * k + a] == mesh.vertices[mesh.triangles[t][k]][a];
+        const float len = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        normals = normals && (std::fabs(len - 1.0f) < 1e-4f || len == 0.0f);
+    }
+    check("STL triangles match", corners && stl && stl.peek() == std::char_traits<char>::eof());
+    check("STL normals are unit length", normals);
+
+    check("unknown extension refused", !writeMesh("test_batch.xyz", mesh) && !isMeshPath("test_batch.xyz"));
+    check("unwritable path fails", !writeMesh("no_such_directory/test_batch.ply", mesh));
+    std::remove("test_batch.ply");
+    std::remove("test_batch.OBJ");
+    std::remove("test_batch.stl");
+}
+
+// ---- Test 2: Job arguments and manifests ------------------------------------------------
+static void testParsing() {
+    std::cout << "Test 2: Job arguments and manifests\n";
+    BatchJob job;
+    std::string error;
+    check("full job parses",
+          parseBatchJob({"data/teapot.obj", "-n", "96", "-o", "t.stl", "--bounds", "-1.5", "1.5",
+                         "--threads", "3", "--winding"}, job, error) &&
+          job.shape == "data/teapot.obj" && job.N == 96 && job.output == "t.stl" && job.minBound == -1.5f &&
+          job.maxBound == 1.5f && job.threads == 3 && job.windingSign);
+    check("defaults", parseBatchJob({"torus", "-o", "t.ply"}, job, error) && job.N == 64 &&
+                      job.minBound == -1.f && job.maxBound == 1.f && job.threads == 0 && !job.windingSign);
+    check("cache directory", parseBatchJob({"torus", "-o", "t.ply", "--cache-dir", "meshes"}, job, error) &&
+                             job.cacheDir == "meshes");
+    check("cache directory defaults to the user's",
+          parseBatchJob({"torus", "-o", "t.ply"}, job, error) && job.cacheDir == userCacheDirectory());
+    check("cache directory needs a path", !parseBatchJob({"torus", "-o", "t.ply", "--cache-dir"}, job, error));
+    check("missing output", !parseBatchJob({"torus"}, job, error));
+    check("bad N", !parseBatchJob({"torus", "-o", "t.ply", "-n", "12x"}, job, error));
+    check("N below 1", !parseBatchJob({"torus", "-o", "t.ply", "-n", "0"}, job, error));
+    check("N up to the int-indexable limit",
+          parseBatchJob({"torus", "-o", "t.ply", "-n", std::to_string(MAX_GRID_N)}, job, error) &&
+          job.N == MAX_GRID_N);
+    check("N past it rejected with the limit named",
+          !parseBatchJob({"torus", "-o", "t.ply", "-n", "1300"}, job, error) &&
+          error.find(std::to_string(MAX_GRID_N)) != std::string::npos);
+    check("negative thread count", !parseBatchJob({"torus", "-o", "t.ply", "--threads", "-2"}, job, error));
+    int n = 7;
+    check("integers are whole strings in range",
+          parseInteger("12", 1, n) && n == 12 && !parseInteger("1e3", 1, n) && !parseInteger("", 1, n) &&
+          !parseInteger("0", 1, n) && !parseInteger("99999999999", 1, n) && n == 12);
+    check("unknown option", !parseBatchJob({"torus", "-o", "t.ply", "--fast"}, job, error));
+    check("unknown format", !parseBatchJob({"torus", "-o", "t.vtk"}, job, error));
+    check("empty bounds", !parseBatchJob({"torus", "-o", "t.ply", "--bounds", "1", "1"}, job, error));
+
+    {
+        std::ofstream manifest("test_batch_jobs.txt");
+        manifest << "# shapes\n"
+                    "sphere -n 32 -o a.ply\n"
+                    "\n"
+                    "torus -o b.obj --threads 2   # trailing comment\n";
+    }
+    std::vector<BatchJob> jobs;
+    check("manifest loads", loadBatchManifest("test_batch_jobs.txt", jobs, error) && jobs.size() == 2 &&
+                            jobs[0].shape == "sphere" && jobs[1].output == "b.obj" && jobs[1].threads == 2);
+    {
+        std::ofstream manifest("test_batch_jobs.txt");
+        manifest << "sphere -o a.ply\nsphere -n\n";
+    }
+    check("bad line is reported with its number",
+          !loadBatchManifest("test_batch_jobs.txt", jobs, error) && error.find(":2:") != std::string::npos);
+    std::remove("test_batch_jobs.txt");
+    check("missing manifest", !loadBatchManifest("test_batch_missing.txt", jobs, error));
+}
+
+// ---- Test 3: Running jobs --------------------------------------------------------------
+static void testRun(bool bench) {
+    std::cout << "Test 3: Concurrent jobs\n";
+    std::vector<BatchJob> jobs(5);
+    const char* shapes[] = {"sphere", "torus", "box", "no_such_mesh.obj", "sphere"};
+    const char* outputs[] = {"test_batch_a.ply", "test_batch_b.stl", "test_batch_c.obj", "test_batch_d.ply",
+                             "test_batch_e.ply"};
+    for (int i = 0; i < 5; ++i) {
+        jobs[i].shape = shapes[i];
+        jobs[i].output = outputs[i];
+        jobs[i].N = bench ? 256 : 48;
+    }
+    jobs[4].N = -2;  // not a job parseBatchJob accepts: the grid allocation throws
+
+    std::vector<size_t> order;
+    const std::vector<BatchResult> results =
+        runBatchJobs(jobs, 3, [&](size_t i, const BatchResult&) { order.push_back(i); });
+    check("every job reported once", order.size() == 5);
+
+    const int N = jobs[1].N;
+    const DCMesh reference = torusMesh(N);
+    const BatchResult& torus = results[1];
+    std::cout << "  torus N=" << N << ": sample " << torus.sampleMs << " ms, contour " << torus.contourMs
+              << " ms, write " << torus.writeMs << " ms (" << torus.bytes << " bytes)\n";
+    check("jobs succeed", results[0].ok && results[1].ok && results[2].ok);
+    check("sample count", torus.samples == static_cast<long long>(N + 1) * (N + 1) * (N + 1));
+    check("same mesh as dualContour", torus.vertices == reference.vertices.size() &&
+                                      torus.triangles == reference.triangles.size());
+    check("file size reported", torus.bytes == 84 + 50 * reference.triangles.size());
+    check("missing mesh fails alone", !results[3].ok && !results[3].error.empty());
+    check("throwing job fails alone", !results[4].ok && !results[4].error.empty());
+    for (const char* path : outputs) std::remove(path);
+}
+
+int main(int argc, char** argv) {
+    const bool bench = argc > 1 && std::strcmp(argv[1], "--bench") == 0;
+
+    testWriters();
+    testParsing();
+    testRun(bench);
+
+    std::cout << "\nResults: " << g_pass << " passed, " << g_fail << " failed\n";
+    return g_fail > 0 ? 1 : 0;
+}
@@ -0,0 +1,181 @@
+#include "build_worker.h"
+#include "dual_contour.h"
+#include "implicit.h"
+#include "parallel.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+static int g_pass = 0, g_fail = 0;
+
+static void check(const char* name, bool cond) {
+    if (cond) {
+        std::cout << "  PASS: " << name << "\n";
+        ++g_pass;
+    } else {
+        std::cout << "  FAIL: " << name << "\n";
+        ++g_fail;
+    }
+}
+
+// A torus that takes a while per sample, like a mesh SDF
+static float slowTorus(float x, float y, float z) {
+    std::this_thread::sleep_for(std::chrono::microseconds(20));
+    return implicitTorus(x, y, z);
+}
+
+// ---- Test 1: Exceptions out of parallelFor --------------------------------------------
+static void testParallelException() {
+    std::cout << "Test 1: parallelFor rethrows on the calling thread\n";
+    std::atomic<int> ran(0);
+    bool caught = false;
+    try {
+        parallelFor(0, 10000, 4, [&](int i) {
+            ++ran;
+            if (i == 100) throw std::runtime_error("stop");
+            std::this_thread::sleep_for(std::chrono::microseconds(10));
+        });
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    check("exception reaches the caller", caught);
+    check("remaining indices are skipped", ran < 10000);
+
+    caught = false;
+    try {
+        parallelFor(0, 10, 1, [&](int i) {
+            if (i == 3) throw std::runtime_error("stop");
+        });
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    check("inline run throws too", caught);
+}
+
+// ---- Test 2: Monitored fields --------------------------------------------------------
+static void testMonitoredField() {
+    std::cout << "Test 2: Monitored fields count and cancel\n";
+    const ImplicitField torus(implicitTorus, implicitTorusBatch, implicitTorusGrad);
+    BuildProgress progress;
+    const int N = 48;
+    progress.beginStage(static_cast<long long>(N + 1) * (N + 1) * (N + 1));
+    const ImplicitField monitored = monitoredField(torus, progress);
+    DCGrid grid = buildGrid(monitored, N);
+    check("grid identical to the plain field's", grid.values == buildGrid(torus, N).values);
+    check("corners counted", progress.fraction() == 1.0f && progress.stage() == 1);
+    DCGrid plain = buildGrid(torus, N);
+    const DCMesh a = dualContour(monitored, grid), b = dualContour(torus, plain);
+    check("mesh identical (gradients forwarded)", a.vertices == b.vertices && a.triangles == b.triangles);
+
+    // A field without a batch kernel is still sampled, and counted, per row;
+    // single scalar calls reach the progress a few thousand at a time
+    BuildProgress scalar;
+    scalar.beginStage(static_cast<long long>(N + 1) * (N + 1) * (N + 1));
+    const ImplicitField scalarOnly = monitoredField(ImplicitField(slowTorus), scalar);
+    buildGrid(scalarOnly, N);
+    check("scalar-only corners counted", scalar.fraction() == 1.0f);
+    BuildProgress calls;
+    calls.beginStage(8192);
+    const ImplicitField counted = monitoredField(ImplicitField(implicitTorus), calls);
+    for (int n = 0; n < 4095; ++n) counted(0.f, 0.f, 0.f);
+    const float before = calls.fraction();
+    counted(0.f, 0.f, 0.f);
+    check("scalar calls flushed in thousands", before == 0.0f && calls.fraction() == 0.5f);
+
+    BuildProgress cancelled;
+    const ImplicitField slow = monitoredField(ImplicitField(slowTorus), cancelled);
+    std::thread canceller([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        cancelled.cancel();
+    });
+    using Clock = std::chrono::steady_clock;
+    const auto t0 = Clock::now();
+    bool stopped = false;
+    try {
+        buildGrid(slow, 128);
+    } catch (const BuildCancelled&) {
+        stopped = true;
+    }
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    canceller.join();
+    std::cout << "  cancelled N=128 build returned after " << ms << " ms\n";
+    check("cancelled build throws BuildCancelled", stopped);
+    check("and stops early", ms < 1000.0);
+}
+
+// ---- Test 3: Worker ------------------------------------------------------------------
+static void testWorker() {
+    std::cout << "Test 3: Worker runs the newest job\n";
+    std::mutex resultsMutex;
+    std::vector<int> completed;
+    std::atomic<int> started(0);
+    {
+        BuildWorker worker;
+        auto job = [&](int id) {
+            return [&, id](BuildProgress& progress) {
+                ++started;
+                progress.beginStage(25LL * 25 * 25);
+                buildGrid(monitoredField(ImplicitField(slowTorus), progress), 24);
+                std::lock_guard<std::mutex> lock(resultsMutex);
+                completed.push_back(id);
+            };
+        };
+
+        // A dragged slider: every request supersedes the previous one
+        std::shared_ptr<const BuildProgress> first = worker.submit(job(0));
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        std::shared_ptr<const BuildProgress> last;
+        for (int id = 1; id <= 10; ++id) last = worker.submit(job(id));
+        worker.wait();
+        check("only the newest job completes", completed == std::vector<int>{10});
+        check("superseded jobs never start", started <= 2);
+        check("superseded progress is cancelled", first->isCancelled() && !last->isCancelled());
+        check("idle afterwards", worker.idle() && last->fraction() == 1.0f);
+
+        // Explicit cancel, and destruction with a job in flight
+        worker.submit(job(11));
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        worker.cancel();
+        worker.wait();
+        worker.submit(job(12));
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    check("cancelled and destroyed jobs do not complete", completed == std::vector<int>{10});
+}
+
+// ---- Test 4: Failing jobs -----------------------------------------------------------
+static void testFailingJob() {
+    std::cout << "Test 4: A failing job leaves the worker running\n";
+    BuildWorker worker;
+    std::shared_ptr<const BuildProgress> failing = worker.submit([](BuildProgress& progress) {
+        progress.beginStage(1);
+        throw std::runtime_error("out of samples");
+    });
+    worker.wait();
+    check("failure recorded in the job's progress",
+          failing->failed() && failing->error() == "out of samples" && !failing->isCancelled());
+
+    std::atomic<bool> ran(false);
+    std::shared_ptr<const BuildProgress> next = worker.submit([&](BuildProgress& progress) {
+        progress.beginStage(9LL * 9 * 9);
+        buildGrid(monitoredField(ImplicitField(implicitTorus), progress), 8);
+        ran = true;
+    });
+    worker.wait();
+    check("next job runs", ran && !next->failed() && next->error().empty());
+    check("idle afterwards", worker.idle());
+}
+
+int main() {
+    testParallelException();
+    testMonitoredField();
+    testWorker();
+    testFailingJob();
+
+    std::cout << "\nResults: " << g_pass << " passed, " << g_fail << " failed\n";
+    return g_fail > 0 ? 1 : 0;
+}
@@ -0,0 +1,92 @@
+#include "chunked.h"
+#include "dual_contour.h"
+#include "implicit.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static int g_pass = 0, g_fail = 0;
+
+static void check(const char* name, bool cond) {
+    if (cond) {
+        std::cout << "  PASS: " << name << "\n";
+        ++g_pass;
+    } else {
+        std::cout << "  FAIL: " << name << "\n";
+        ++g_fail;
+    }
+}
+
+struct Shape { const char* name; ScalarField f; };
+static const Shape g_shapes[] = {
+    {"sphere", implicitSphere}, {"box", implicitBox}, {"torus", implicitTorus}
+};
+
+// ---- Test 1: Chunked output equals the monolithic mesh ---------------------
+static void testEquivalence(int N, int chunkSize) {
+    std::cout << "Test 1: Chunked vs. monolithic, N=" << N << ", chunks of " << chunkSize << "\n";
+    for (const auto& shape : g_shapes) {
+        DCGrid grid = buildGrid(shape.f, N);
+        DCMesh reference = dualContour(shape.f, grid);
+        ChunkLayout layout = cubicChunkLayout(N, -1.f, 1.f, chunkSize);
+        for (int threads : {1, 4}) {
+            DCMesh mesh = dualContourChunked(shape.f, layout, threads);
+            const std::string label = std::string(shape.name) + (threads == 1 ? " serial" : " 4 threads");
+            check((label + " identical vertices").c_str(), mesh.vertices == reference.vertices);
+            check((label + " identical triangles").c_str(), mesh.triangles == reference.triangles);
+        }
+    }
+}
+
+// ---- Test 2: Merging is independent of chunk order -------------------------
+static void testMergeOrder() {
+    std::cout << "Test 2: Chunks meshed out of order\n";
+    const int N = 48;
+    ChunkLayout layout = cubicChunkLayout(N, -1.f, 1.f, 16);
+    std::vector<DCChunk> chunks;
+    for (int c = layout.numChunks() - 1; c >= 0; --c) {
+        const int nx = layout.chunksAlong(0), ny = layout.chunksAlong(1);
+        chunks.push_back(meshChunk(implicitTorus, layout, c % nx, (c / nx) % ny, c / (nx * ny)));
+    }
+    DCMesh mesh = mergeChunks(chunks);
+    DCGrid grid = buildGrid(implicitTorus, N);
+    DCMesh reference = dualContour(implicitTorus, grid);
+    check("reversed chunk list gives the same mesh",
+          mesh.vertices == reference.vertices && mesh.triangles == reference.triangles);
+
+    // Only owned vertices are emitted, so no cell appears in two chunks
+    size_t emitted = 0;
+    bool ascending = true;
+    for (const DCChunk& chunk : chunks) {
+        emitted += chunk.vertices.size();
+        ascending = ascending && std::is_sorted(chunk.vertexCells.begin(), chunk.vertexCells.end());
+    }
+    check("chunk vertex cells ascend", ascending);
+    check("no seam duplicates", emitted == reference.vertices.size());
+}
+
+// ---- Test 3: Larger, non-unit domain ---------------------------------------
+static void testLargeDomain() {
+    std::cout << "Test 3: Domain [-2, 2]^3, N=96, chunks of 32\n";
+    // Two tori side by side, which spill across several chunk seams
+    ScalarField twoTori = [](float x, float y, float z) {
+        return std::min(implicitTorus(x - 0.9f, y, z), implicitTorus(x + 0.9f, z, y));
+    };
+    DCGrid grid = buildGrid(twoTori, 96, -2.f, 2.f);
+    DCMesh reference = dualContour(twoTori, grid);
+    DCMesh mesh = dualContourChunked(twoTori, cubicChunkLayout(96, -2.f, 2.f, 32));
+    check("identical vertices", mesh.vertices == reference.vertices);
+    check("identical triangles", mesh.triangles == reference.triangles);
+}
+
+int main() {
+    testEquivalence(64, 16);
+    testEquivalence(64, 64);
+    testEquivalence(100, 24);
+    testMergeOrder();
+    testLargeDomain();
+
+    std::cout << "\nResults: " << g_pass << " passed, " << g_fail << " failed\n";
+    return g_fail > 0 ? 1 : 0;
+}
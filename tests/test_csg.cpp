@@ -0,0 +1,204 @@
+#include "csg.h"
+#include "dual_contour.h"
+#include "implicit.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+static int g_pass = 0, g_fail = 0;
+
+static void check(const char* name, bool cond) {
+    if (cond) {
+        std::cout << "  PASS: " << name << "\n";
+        ++g_pass;
+    } else {
+        std::cout << "  FAIL: " << name << "\n";
+        ++g_fail;
+    }
+}
+
+// Deterministic points in [-1, 1]^3
+static Eigen::Vector3f samplePoint(int i) {
+    return Eigen::Vector3f(-1.0f + 2.0f * ((i * 37) % 101) / 100.0f,
+                           -1.0f + 2.0f * ((i * 53) % 97) / 96.0f,
+                           -1.0f + 2.0f * ((i * 71) % 89) / 88.0f);
+}
+
+// A bracket: plate and boss blended, minus a bore, with a ring on top
+static auto makeBracket() {
+    auto plate = csgBox({0.0f, -0.3f, 0.0f}, {0.6f, 0.1f, 0.4f});
+    auto boss = csgSphere({0.0f, -0.1f, 0.0f}, 0.3f);
+    auto bore = csgBox({0.0f, 0.0f, 0.0f}, {0.12f, 0.5f, 0.12f});
+    auto ring = csgTranslate(csgTorus(0.25f, 0.06f), {0.0f, 0.25f, 0.0f});
+    return csgUnion(csgDifference(csgSmoothUnion(plate, boss, 0.1f), bore), csgScale(ring, 1.2f));
+}
+
+// 50 primitives: a plate and 48 parts scattered over it, blended, minus a bore
+template <size_t I>
+static auto modelPart() {
+    const float a = 2.399963f * I;  // golden angle spiral
+    const float r = 0.75f * std::sqrt((I + 0.5f) / 48.0f);
+    const Eigen::Vector3f c(r * std::cos(a), -0.25f + 0.1f * ((I * 7) % 5) / 4.0f, r * std::sin(a));
+    if constexpr (I % 3 == 0) {
+        return csgSphere(c, 0.07f + 0.01f * (I % 4));
+    } else if constexpr (I % 3 == 1) {
+        return csgBox(c, {0.05f, 0.12f, 0.05f});
+    } else {
+        return csgTorus(0.06f, 0.02f, c);
+    }
+}
+
+template <size_t... I>
+static auto makeModel(std::index_sequence<I...>) {
+    auto plate = csgBox({0.0f, -0.4f, 0.0f}, {0.85f, 0.06f, 0.85f});
+    auto bore = csgSphere({0.0f, -0.4f, 0.0f}, 0.2f);
+    return csgDifference(csgSmoothUnion(plate, csgUnion(modelPart<I>()...), 0.04f), bore);
+}
+
+// ---- Test 1: Operations --------------------------------------------------------
+static void testOperations() {
+    std::cout << "Test 1: CSG operations match their formulas\n";
+    auto s = csgSphere({0.1f, 0.0f, 0.0f}, 0.5f);
+    auto b = csgBox({0.0f, 0.2f, 0.0f}, {0.4f, 0.3f, 0.2f});
+    auto u = csgUnion(s, b);
+    auto in = csgIntersection(s, b);
+    auto d = csgDifference(s, b);
+    auto su = csgSmoothUnion(s, b, 0.2f);
+    auto t = csgTranslate(s, {0.3f, -0.2f, 0.1f});
+    auto sc = csgScale(csgSphere({0.0f, 0.0f, 0.0f}, 0.75f), 0.5f);
+    auto torus = csgTorus(0.6f, 0.25f);
+    bool ok = true, okTorus = true, okSmooth = true, okTransform = true;
+    for (int i = 0; i < 500; ++i) {
+        const Eigen::Vector3f p = samplePoint(i);
+        const float vs = s(p.x(), p.y(), p.z()), vb = b(p.x(), p.y(), p.z());
+        ok = ok && u(p.x(), p.y(), p.z()) == std::min(vs, vb) &&
+             in(p.x(), p.y(), p.z()) == std::max(vs, vb) &&
+             d(p.x(), p.y(), p.z()) == std::max(vs, -vb);
+        const float h = std::max(0.2f - std::abs(vs - vb), 0.0f) / 0.2f;
+        okSmooth = okSmooth && std::abs(su(p.x(), p.y(), p.z()) - (std::min(vs, vb) - h * h * 0.05f)) < 1e-6f;
+        okTransform = okTransform &&
+                      t(p.x(), p.y(), p.z()) == s(p.x() - 0.3f, p.y() + 0.2f, p.z() - 0.1f) &&
+                      std::abs(sc(p.x(), p.y(), p.z()) - (p.norm() - 0.375f)) < 1e-6f;
+        okTorus = okTorus && std::abs(torus(p.x(), p.y(), p.z()) - implicitTorus(p.x(), p.y(), p.z())) < 1e-6f;
+    }
+    check("union, intersection, difference", ok);
+    check("smooth union", okSmooth);
+    check("translate and scale", okTransform);
+    check("torus matches implicitTorus", okTorus);
+    check("node counts", decltype(u)::size == 3 && decltype(t)::size == 2 &&
+                         decltype(csgUnion(s, s, b, b, s))::size == 9);
+}
+
+// ---- Test 2: Interval bounds and pruning ------------------------------------------
+static void testBounds() {
+    std::cout << "Test 2: Bounds hold and pruned evaluation is exact\n";
+    auto bracket = makeBracket();
+    auto model = makeModel(std::make_index_sequence<48>());
+    using Model = decltype(model);
+    int outside = 0, mismatched = 0, pruned = 0, boxes = 0;
+    for (int n = 0; n < 400; ++n) {
+        const Eigen::Vector3f lo = samplePoint(n) * 0.9f;
+        const float size = 0.02f + 0.3f * ((n * 13) % 17) / 16.0f;
+        const CSGBounds box = {lo, lo + Eigen::Vector3f::Constant(size)};
+        std::array<uint8_t, Model::size> active;
+        active.fill(1);
+        std::array<uint8_t, decltype(bracket)::size> bracketActive;
+        bracketActive.fill(1);
+        const CSGInterval range = model.bound(box, active.data());
+        const CSGInterval bracketRange = bracket.bound(box, bracketActive.data());
+        for (uint8_t a : active) pruned += a == 0;
+        ++boxes;
+        for (int s = 0; s < 64; ++s) {
+            const Eigen::Vector3f p = box.lo + size * Eigen::Vector3f((s & 3) / 3.0f, ((s >> 2) & 3) / 3.0f,
+                                                                      (s >> 4) / 3.0f);
+            const float v = model(p.x(), p.y(), p.z()), vb = bracket(p.x(), p.y(), p.z());
+            if (v < range.lo || v > range.hi) ++outside;
+            if (vb < bracketRange.lo || vb > bracketRange.hi) ++outside;
+            if (model.eval(p.x(), p.y(), p.z(), active.data()) != v) ++mismatched;
+            if (bracket.eval(p.x(), p.y(), p.z(), bracketActive.data()) != vb) ++mismatched;
+        }
+    }
+    std::cout << "  " << double(pruned) / boxes << " subtrees of the " << Model::size
+              << "-node model pruned per box\n";
+    check("every value inside its box's bound", outside == 0);
+    check("pruned evaluation equals the full tree", mismatched == 0);
+    check("boxes prune subtrees", pruned > boxes * 10);
+}
+
+// ---- Test 3: buildGridCSG against buildGrid --------------------------------------
+static void testSampling() {
+    std::cout << "Test 3: buildGridCSG gives the buildGrid mesh\n";
+    auto bracket = makeBracket();
+    const int N = 64;
+    SamplingStats stats;
+    DCGrid pruned = buildGridCSG(bracket, N, -1.f, 1.f, 0, &stats);
+    DCGrid dense = buildGrid(bracket, N);
+    int wrongSigns = 0, wrongValues = 0;
+    for (size_t c = 0; c < dense.values.size(); ++c) {
+        if ((pruned.values[c] < 0) != (dense.values[c] < 0)) ++wrongSigns;
+        if (pruned.values[c] != dense.values[c] && std::abs(pruned.values[c]) > std::abs(dense.values[c]))
+            ++wrongValues;
+    }
+    check("corner signs match buildGrid", wrongSigns == 0);
+    check("fills never overstate |f|", wrongValues == 0);
+    DCMesh a = dualContour(bracket, pruned), b = dualContour(bracket, dense);
+    check("mesh identical to buildGrid", !a.triangles.empty() && a.vertices == b.vertices &&
+                                          a.triangles == b.triangles);
+    std::cout << "  " << stats.total() << " of " << stats.denseEvaluations << " evaluations\n";
+    check("skips most corners", stats.cornerEvaluations * 4 < stats.denseEvaluations);
+
+    DCGrid serial = buildGridCSG(bracket, N, -1.f, 1.f, 1);
+    DCGrid threaded = buildGridCSG(bracket, N, -1.f, 1.f, 4);
+    check("identical for 1 and 4 threads", serial.values == threaded.values);
+    DCGrid odd = buildGridCSG(bracket, 37);
+    DCGrid oddDense = buildGrid(bracket, 37);
+    check("mesh identical for N=37", dualContour(bracket, odd).triangles == dualContour(bracket, oddDense).triangles);
+}
+
+// ---- Test 4: 50-primitive model ------------------------------------------------------
+static void testModel(bool bench) {
+    std::cout << "Test 4: 50-primitive model\n";
+    auto model = makeModel(std::make_index_sequence<48>());
+    const int N = bench ? 256 : 96;
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point t0) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    };
+
+    ImplicitField wrapped;
+    wrapped.eval = model;
+    auto t0 = Clock::now();
+    DCGrid viaFunction = buildGrid(wrapped, N);
+    const double functionMs = ms(t0);
+    t0 = Clock::now();
+    DCGrid dense = buildGrid(model, N);
+    const double denseMs = ms(t0);
+    SamplingStats stats;
+    t0 = Clock::now();
+    DCGrid pruned = buildGridCSG(model, N, -1.f, 1.f, 0, &stats);
+    const double prunedMs = ms(t0);
+
+    std::cout << "  N=" << N << " sampling: " << functionMs << " ms std::function, " << denseMs
+              << " ms inlined, " << prunedMs << " ms pruned (" << stats.total() << " of "
+              << stats.denseEvaluations << " evaluations)\n";
+    check("std::function and inlined grids identical", viaFunction.values == dense.values);
+    DCMesh a = dualContour(model, pruned), b = dualContour(model, dense);
+    std::cout << "  " << a.vertices.size() << " vertices\n";
+    check("mesh identical to buildGrid", !a.triangles.empty() && a.vertices == b.vertices &&
+                                          a.triangles == b.triangles);
+}
+
+int main(int argc, char** argv) {
+    const bool bench = argc > 1 && std::strcmp(argv[1], "--bench") == 0;
+
+    testOperations();
+    testBounds();
+    testSampling();
+    testModel(bench);
+
+    std::cout << "\nResults: " << g_pass << " passed, " << g_fail << " failed\n";
+    return g_fail > 0 ? 1 : 0;
+}
@@ -2,8 +2,14 @@
 #include "implicit.h"
 #include <Eigen/Core>
 #include <Eigen/Geometry>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <iostream>
+#include <set>
+#include <string>
+#include <vector>
 #include <cassert>
 
 static int g_pass = 0, g_fail = 0;
@@ -18,6 +24,11 @@ static void check(const char* name, bool cond) {
     }
 }
 
+struct Shape { const char* name; ScalarField f; };
+static const Shape g_shapes[] = {
+    {"sphere", implicitSphere}, {"box", implicitBox}, {"torus", implicitTorus}
+};
+
 // Signed volume contribution of a triangle (divergence theorem)
 static double triSignedVolume(const std::array<float,3>& a,
                                const std::array<float,3>& b,
@@ -117,7 +128,22 @@ static void runTests(int N) {
             std::cout << "    (" << flipCount << " flip(s) detected)\n";
     }
 
-    // 5. Approximate volume check (only meaningful at higher res)
+    // 5. Edge lookup: every stored edge is found at its own slot, an edge
+    //    without a sign change is not, and the row table is (N+1)^2 per axis
+    {
+        bool found = true;
+        for (int axis = 0; axis < 3; ++axis) {
+            const auto& edges = grid.edges.edges[axis];
+            found = found && grid.edges.rowStart[axis].size() == size_t(N + 1) * (N + 1) + 1;
+            for (size_t e = 0; found && e < edges.size(); ++e) {
+                found = grid.edges.find(axis, edges[e].i, edges[e].j, edges[e].k) == static_cast<int>(e);
+            }
+        }
+        check("edge rows find every sign-changing edge", found);
+        check("no edge at the empty corner", grid.edges.find(0, 0, 0, 0) == -1);
+    }
+
+    // 6. Approximate volume check (only meaningful at higher res)
     if (N >= 32) {
         double vol = 0.0;
         for (const auto& tri : mesh.triangles) {
@@ -133,9 +159,338 @@ static void runTests(int N) {
     }
 }
 
+// The uniform path winds each quad from the sign change along its edge alone
+// (see appendQuad). Every triangle must then face along the field gradient,
+// and the mesh must be consistently oriented: each directed edge used once.
+static void testOutwardNormals(int N) {
+    std::cout << "\n=== Outward normals on the uniform path, N=" << N << " ===\n";
+    for (const Shape& shape : g_shapes) {
+        DCGrid grid = buildGrid(shape.f, N);
+        const DCMesh mesh = dualContour(shape.f, grid);
+
+        int inward = 0;
+        double volume = 0.0;
+        std::set<std::pair<int,int>> directed;
+        bool manifold = true;
+        for (const auto& tri : mesh.triangles) {
+            const Eigen::Vector3f a(mesh.vertices[tri[0]].data());
+            const Eigen::Vector3f b(mesh.vertices[tri[1]].data());
+            const Eigen::Vector3f c(mesh.vertices[tri[2]].data());
+            const Eigen::Vector3f centroid = (a + b + c) / 3.0f;
+            const Eigen::Vector3f n = (b - a).cross(c - a);
+            if (n.dot(gradient(shape.f, centroid.x(), centroid.y(), centroid.z())) <= 0.0f) ++inward;
+            volume += triSignedVolume(mesh.vertices[tri[0]], mesh.vertices[tri[1]], mesh.vertices[tri[2]]);
+            for (int e = 0; e < 3; ++e) {
+                manifold = directed.insert({tri[e], tri[(e + 1) % 3]}).second && manifold;
+            }
+        }
+        std::cout << "  " << shape.name << ": " << inward << " of " << mesh.triangles.size()
+                  << " triangles face inward\n";
+        check((std::string(shape.name) + " triangles face along the gradient").c_str(), inward == 0);
+        check((std::string(shape.name) + " positive enclosed volume").c_str(), volume > 0.0);
+        check((std::string(shape.name) + " each directed edge used once").c_str(), manifold);
+    }
+}
+
+// Parallel sampling must reproduce the serial grid exactly, for any thread count.
+static void testParallelGrid(int N) {
+    std::cout << "\n=== Parallel buildGrid, N=" << N << " ===\n";
+    using Clock = std::chrono::steady_clock;
+
+    auto t0 = Clock::now();
+    DCGrid serial = buildGrid(implicitTorus, N, -1.f, 1.f, 1);
+    double serialMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    std::cout << "  threads=1  " << serialMs << " ms\n";
+
+    for (int threads : {2, 4, 8}) {
+        t0 = Clock::now();
+        DCGrid par = buildGrid(implicitTorus, N, -1.f, 1.f, threads);
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        std::cout << "  threads=" << threads << "  " << ms << " ms  (speedup "
+                  << serialMs / ms << "x)\n";
+        std::string name = "values identical to serial (threads=" + std::to_string(threads) + ")";
+        check(name.c_str(), par.values == serial.values);
+    }
+}
+
+// SIMD batch kernels must agree with the scalar shapes, including the tail.
+static void testBatchKernels() {
+    std::cout << "\n=== Batch field kernels ===\n";
+    const int n = 1000 + 3;  // not a multiple of any lane width
+    std::vector<float> xs(n), ys(n), zs(n), out(n);
+    for (int i = 0; i < n; ++i) {
+        xs[i] = -1.0f + 2.0f * ((i * 37) % 101) / 100.0f;
+        ys[i] = -1.0f + 2.0f * ((i * 53) % 97) / 96.0f;
+        zs[i] = -1.0f + 2.0f * ((i * 71) % 89) / 88.0f;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    for (const auto& shape : g_shapes) {
+        ImplicitField field(shape.f);
+        check((std::string(shape.name) + " has a batch kernel").c_str(), bool(field.evalBatch));
+        field.evaluate(xs.data(), ys.data(), zs.data(), out.data(), n);
+        float maxErr = 0.0f;
+        for (int i = 0; i < n; ++i) {
+            maxErr = std::max(maxErr, std::abs(out[i] - shape.f(xs[i], ys[i], zs[i])));
+        }
+        check((std::string(shape.name) + " batch matches scalar").c_str(), maxErr < 1e-6f);
+
+        // Per-sample cost of the whole-grid sampler, batch vs. per-point adapter
+        ImplicitField pointOnly;
+        pointOnly.eval = shape.f;
+        const int N = 96;
+        auto t0 = Clock::now();
+        DCGrid gb = buildGrid(field, N, -1.f, 1.f, 1);
+        double batchNs = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+        t0 = Clock::now();
+        DCGrid gp = buildGrid(pointOnly, N, -1.f, 1.f, 1);
+        double pointNs = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+        const double samples = double(gb.values.size());
+        std::cout << "  " << shape.name << ": " << batchNs / samples << " ns/sample batched, "
+                  << pointNs / samples << " ns/sample per-point\n";
+    }
+}
+
+// Closed-form gradients must agree with central differences away from kinks,
+// and should cut the field evaluations dualContour spends per output vertex.
+static void testAnalyticGradients() {
+    std::cout << "\n=== Analytic gradients ===\n";
+    for (const auto& shape : g_shapes) {
+        ImplicitField field(shape.f);
+        check((std::string(shape.name) + " has a gradient evaluator").c_str(), bool(field.evalGrad));
+
+        // Compare on a near-surface shell where the finite differences are well defined
+        int compared = 0, agree = 0, valueMismatch = 0;
+        const int M = 24;
+        for (int ix = 0; ix <= M; ++ix)
+            for (int iy = 0; iy <= M; ++iy)
+                for (int iz = 0; iz <= M; ++iz) {
+                    float x = -1.0f + 2.0f * ix / M + 0.013f;
+                    float y = -1.0f + 2.0f * iy / M + 0.007f;
+                    float z = -1.0f + 2.0f * iz / M + 0.011f;
+                    Eigen::Vector3f ga;
+                    float v = field.evalGrad(x, y, z, ga);
+                    if (std::abs(v) > 0.1f) continue;
+                    if (std::abs(v - shape.f(x, y, z)) > 1e-6f) ++valueMismatch;
+                    ++compared;
+                    Eigen::Vector3f gf = gradient(shape.f, x, y, z, 1e-3f);
+                    if ((ga - gf).norm() < 2e-2f) ++agree;
+                }
+        std::cout << "  " << shape.name << ": " << agree << "/" << compared
+                  << " near-surface gradients agree with central differences\n";
+        check((std::string(shape.name) + " gradient evaluator returns the field value").c_str(),
+              valueMismatch == 0);
+        check((std::string(shape.name) + " gradients agree with finite differences").c_str(),
+              compared > 0 && agree >= compared * 95 / 100);
+
+        // Benchmark: field evaluations inside dualContour per output vertex
+        static std::atomic<long long> evals(0);
+        static ScalarField counted = nullptr;
+        counted = shape.f;
+        ImplicitField fd;
+        fd.eval = [](float x, float y, float z) { ++evals; return counted(x, y, z); };
+        ImplicitField analytic = fd;
+        analytic.evalGrad = [&field](float x, float y, float z, Eigen::Vector3f& g) {
+            ++evals;
+            return field.evalGrad(x, y, z, g);
+        };
+
+        const int N = 32;
+        DCGrid gridFD = buildGrid(field, N);
+        evals = 0;
+        DCMesh meshFD = dualContour(fd, gridFD);
+        const long long evalsFD = evals;
+
+        DCGrid gridA = buildGrid(field, N);
+        evals = 0;
+        DCMesh meshA = dualContour(analytic, gridA);
+        const long long evalsA = evals;
+
+        std::cout << "  " << shape.name << ": evaluations/vertex "
+                  << double(evalsFD) / meshFD.vertices.size() << " (finite differences) -> "
+                  << double(evalsA) / meshA.vertices.size() << " (analytic)\n";
+        check((std::string(shape.name) + " same vertex count with analytic gradients").c_str(),
+              meshFD.vertices.size() == meshA.vertices.size());
+        check((std::string(shape.name) + " analytic path evaluates the field 6x less").c_str(),
+              evalsA * 6 == evalsFD);
+        const size_t crossings = gridA.edges.edges[0].size() + gridA.edges.edges[1].size() +
+                                 gridA.edges.edges[2].size();
+        check((std::string(shape.name) + " one gradient per sign-changing edge").c_str(),
+              static_cast<size_t>(evalsA) == crossings);
+    }
+}
+
+// Parallel dualContour must number vertices and order triangles exactly as the
+// serial path does; prints a scaling report for the whole pipeline.
+static void testParallelContour() {
+    std::cout << "\n=== Parallel dualContour ===\n";
+    using Clock = std::chrono::steady_clock;
+
+    for (const auto& shape : g_shapes) {
+        DCGrid serialGrid = buildGrid(shape.f, 48, -1.f, 1.f, 1);
+        DCMesh serial = dualContour(shape.f, serialGrid, 1);
+        bool identical = true;
+        for (int threads : {2, 3, 8}) {
+            DCGrid grid = buildGrid(shape.f, 48, -1.f, 1.f, threads);
+            DCMesh mesh = dualContour(shape.f, grid, threads);
+            identical = identical && mesh.vertices == serial.vertices &&
+                        mesh.triangles == serial.triangles &&
+                        grid.vertexIndex == serialGrid.vertexIndex;
+        }
+        check((std::string(shape.name) + " mesh bit-identical for 1/2/3/8 threads").c_str(), identical);
+    }
+
+    std::cout << "  Scaling (sphere, buildGrid + dualContour):\n";
+    for (int N : {64, 128, 256}) {
+        double serialMs = 0.0;
+        for (int threads : {1, 2, 4, 8}) {
+            auto t0 = Clock::now();
+            DCGrid grid = buildGrid(implicitSphere, N, -1.f, 1.f, threads);
+            DCMesh mesh = dualContour(implicitSphere, grid, threads);
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+            if (threads == 1) serialMs = ms;
+            std::cout << "    N=" << N << " threads=" << threads << ": " << ms << " ms ("
+                      << serialMs / ms << "x), " << mesh.vertices.size() << " vertices\n";
+        }
+    }
+}
+
+// Coarse-to-fine sampling must give the same mesh as the full grid while
+// evaluating far fewer corners; prints the evaluation counts at N=256.
+static void testHierarchicalGrid() {
+    std::cout << "\n=== Hierarchical sampling ===\n";
+    for (const auto& shape : g_shapes) {
+        bool identical = true, signsMatch = true;
+        for (int N : {16, 45, 64}) {
+            DCGrid dense = buildGrid(shape.f, N);
+            DCMesh denseMesh = dualContour(shape.f, dense);
+            DCGrid grid = buildGridHierarchical(shape.f, N);
+            DCMesh mesh = dualContour(shape.f, grid);
+            identical = identical && mesh.vertices == denseMesh.vertices &&
+                        mesh.triangles == denseMesh.triangles;
+            for (size_t c = 0; c < dense.values.size(); ++c) {
+                signsMatch = signsMatch && (dense.values[c] < 0) == (grid.values[c] < 0);
+            }
+        }
+        check((std::string(shape.name) + " corner signs match full grid").c_str(), signsMatch);
+        check((std::string(shape.name) + " mesh identical to full grid").c_str(), identical);
+
+        SamplingStats stats;
+        buildGridHierarchical(shape.f, 256, -1.f, 1.f, 0, 1.f, &stats);
+        std::cout << "  " << shape.name << " N=256: " << stats.total() << " of "
+                  << stats.denseEvaluations << " evaluations ("
+                  << 100.0 * stats.total() / stats.denseEvaluations << "%)\n";
+        check((std::string(shape.name) + " saves evaluations at N=256").c_str(),
+              stats.total() < stats.denseEvaluations / 4);
+    }
+
+    // A larger safety factor only refines more
+    SamplingStats exact, safe;
+    buildGridHierarchical(implicitBox, 64, -1.f, 1.f, 0, 1.f, &exact);
+    DCGrid grid = buildGridHierarchical(implicitBox, 64, -1.f, 1.f, 0, 2.f, &safe);
+    DCGrid dense = buildGrid(implicitBox, 64);
+    check("safety factor 2 samples more corners", safe.total() > exact.total());
+    check("safety factor 2 mesh identical to full grid",
+          dualContour(implicitBox, grid).triangles == dualContour(implicitBox, dense).triangles);
+}
+
+// A field known at compile time (lambda or functor) must give exactly the grid
+// and mesh of the same field through ImplicitField; prints the per-sample cost
+// of both paths.
+struct SphereField {
+    float operator()(float x, float y, float z) const { return std::sqrt(x*x + y*y + z*z) - 0.75f; }
+    float operator()(float x, float y, float z, Eigen::Vector3f& grad) const {
+        return implicitSphereGrad(x, y, z, grad);
+    }
+};
+
+struct TorusField {
+    float major, minor;
+    float operator()(float x, float y, float z) const {
+        float qx = std::sqrt(x*x + z*z) - major;
+        return std::sqrt(qx*qx + y*y) - minor;
+    }
+};
+
+static void testCompileTimeFields() {
+    std::cout << "\n=== Compile-time fields ===\n";
+    const int N = 64;
+
+    // Functor with a closed-form gradient, against the sphere's kernels
+    DCGrid sphereA = buildGrid(implicitSphere, N);
+    DCGrid sphereB = buildGrid(SphereField(), N);
+    check("sphere functor grid identical", sphereA.values == sphereB.values);
+    DCMesh meshA = dualContour(implicitSphere, sphereA);
+    DCMesh meshB = dualContour(SphereField(), sphereB);
+    check("sphere functor mesh identical",
+          meshA.vertices == meshB.vertices && meshA.triangles == meshB.triangles);
+
+    // Stateful functor with finite-difference normals, against the same
+    // field through std::function (no batch kernel, no gradient)
+    const TorusField torus{0.6f, 0.25f};
+    ImplicitField wrapped;
+    wrapped.eval = torus;
+    DCGrid torusA = buildGrid(wrapped, N, -1.f, 1.f, 1);
+    DCGrid torusB = buildGrid(torus, N, -1.f, 1.f, 1);
+    check("torus functor grid identical", torusA.values == torusB.values);
+    DCMesh torusMeshA = dualContour(wrapped, torusA);
+    DCMesh torusMeshB = dualContour(torus, torusB);
+    check("torus functor mesh identical",
+          torusMeshA.vertices == torusMeshB.vertices && torusMeshA.triangles == torusMeshB.triangles);
+
+    // Capturing lambda
+    const float radius = 0.5f;
+    auto ball = [radius](float x, float y, float z) { return std::sqrt(x*x + y*y + z*z) - radius; };
+    DCGrid ballGrid = buildGrid(ball, 32);
+    DCMesh ballMesh = dualContour(ball, ballGrid);
+    float worst = 0.0f;
+    for (const auto& v : ballMesh.vertices) worst = std::max(worst, std::abs(ball(v[0], v[1], v[2])));
+    check("capturing lambda contoured", !ballMesh.triangles.empty() && worst < 0.01f);
+
+    // Per-sample cost of the whole-grid sampler and of the full pipeline
+    using Clock = std::chrono::steady_clock;
+    auto perSample = [](auto sample, double samples) {
+        auto t0 = Clock::now();
+        sample();
+        return std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / samples;
+    };
+    const int B = 128;
+    const double samples = double(B + 1) * (B + 1) * (B + 1);
+    ImplicitField sphereFn;
+    sphereFn.eval = implicitSphere;
+    ImplicitField torusFn;
+    torusFn.eval = implicitTorus;
+    const double sphereFnNs = perSample([&] { buildGrid(sphereFn, B, -1.f, 1.f, 1); }, samples);
+    const double sphereBatchNs = perSample([&] { buildGrid(implicitSphere, B, -1.f, 1.f, 1); }, samples);
+    const double sphereTplNs = perSample([&] { buildGrid(SphereField(), B, -1.f, 1.f, 1); }, samples);
+    const double torusFnNs = perSample([&] { buildGrid(torusFn, B, -1.f, 1.f, 1); }, samples);
+    const double torusBatchNs = perSample([&] { buildGrid(implicitTorus, B, -1.f, 1.f, 1); }, samples);
+    const double torusTplNs = perSample([&] { buildGrid(torus, B, -1.f, 1.f, 1); }, samples);
+    std::cout << "  sphere: " << sphereFnNs << " ns/sample std::function, " << sphereBatchNs
+              << " SIMD batch, " << sphereTplNs << " functor\n";
+    std::cout << "  torus:  " << torusFnNs << " ns/sample std::function, " << torusBatchNs
+              << " SIMD batch, " << torusTplNs << " functor\n";
+
+    auto pipeline = [](const auto& f) {
+        DCGrid grid = buildGrid(f, 128, -1.f, 1.f, 1);
+        return dualContour(f, grid, 1);
+    };
+    const double torusFnMs = perSample([&] { pipeline(torusFn); }, 1e6);
+    const double torusTplMs = perSample([&] { pipeline(torus); }, 1e6);
+    std::cout << "  torus N=128 pipeline, 1 thread: " << torusFnMs << " ms std::function, "
+              << torusTplMs << " ms functor\n";
+}
+
 int main() {
     runTests(16);
     runTests(32);
+    testOutwardNormals(32);
+    testParallelGrid(128);
+    testBatchKernels();
+    testAnalyticGradients();
+    testParallelContour();
+    testHierarchicalGrid();
+    testCompileTimeFields();
 
     std::cout << "\nResults: " << g_pass << " passed, " << g_fail << " failed\n";
     return g_fail > 0 ? 1 : 0;
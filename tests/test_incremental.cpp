@@ -0,0 +1,192 @@
+#include "incremental.h"
+#include "dual_contour.h"
+#include "implicit.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+static int g_pass = 0, g_fail = 0;
+
+static void check(const char* name, bool cond) {
+    if (cond) {
+        std::cout << "  PASS: " << name << "\n";
+        ++g_pass;
+    } else {
+        std::cout << "  FAIL: " << name << "\n";
+        ++g_fail;
+    }
+}
+
+// A brush stamp: pushes the surface out by up to depth within radius of centre
+struct Stamp {
+    Eigen::Vector3f centre;
+    float radius, depth;
+
+    float operator()(float x, float y, float z) const {
+        const float d2 = (Eigen::Vector3f(x, y, z) - centre).squaredNorm() / (radius * radius);
+        const float w = std::max(1.0f - d2, 0.0f);
+        return -depth * w * w;
+    }
+};
+
+static ImplicitField stampedSphere(const std::vector<Stamp>& stamps) {
+    ImplicitField f;
+    f.eval = [stamps](float x, float y, float z) {
+        float v = implicitSphere(x, y, z);
+        for (const Stamp& s : stamps) v += s(x, y, z);
+        return v;
+    };
+    return f;
+}
+
+// Triangles as vertex positions, rotated to start at the smallest corner, sorted
+static std::vector<std::array<float,9>> triangleSoup(const DCMesh& mesh) {
+    std::vector<std::array<float,9>> soup;
+    for (const auto& t : mesh.triangles) {
+        int first = 0;
+        for (int c = 1; c < 3; ++c) {
+            if (mesh.vertices[t[c]] < mesh.vertices[t[first]]) first = c;
+        }
+        std::array<float,9> tri;
+        for (int c = 0; c < 3; ++c)
+            for (int a = 0; a < 3; ++a) tri[3 * c + a] = mesh.vertices[t[(first + c) % 3]][a];
+        soup.push_back(tri);
+    }
+    std::sort(soup.begin(), soup.end());
+    return soup;
+}
+
+// Same cell vertices, the same edge store (in scan order, with the same row
+// table) and the same triangles as a full rebuild
+static bool matchesRebuild(const IncrementalDC& dc, const ImplicitField& f) {
+    const DCGrid& grid = dc.grid();
+    DCGrid full = buildGrid(f, grid.N, grid.minBound, grid.maxBound);
+    DCMesh mesh = dualContour(f, full);
+    if (full.values != grid.values) return false;
+    for (int axis = 0; axis < 3; ++axis) {
+        const auto& a = grid.edges.edges[axis];
+        const auto& b = full.edges.edges[axis];
+        if (a.size() != b.size() || grid.edges.rowStart[axis] != full.edges.rowStart[axis]) return false;
+        for (size_t e = 0; e < a.size(); ++e) {
+            if (a[e].i != b[e].i || a[e].j != b[e].j || a[e].k != b[e].k || a[e].rising != b[e].rising ||
+                a[e].hermite.point != b[e].hermite.point || a[e].hermite.normal != b[e].hermite.normal) {
+                return false;
+            }
+        }
+    }
+    for (size_t c = 0; c < full.vertexIndex.size(); ++c) {
+        const int a = grid.vertexIndex[c], b = full.vertexIndex[c];
+        if ((a < 0) != (b < 0)) return false;
+        if (a >= 0 && dc.mesh().vertices[a] != mesh.vertices[b]) return false;
+    }
+    return triangleSoup(dc.mesh()) == triangleSoup(mesh);
+}
+
+// ---- Test 1: Build matches dualContour -------------------------------------------
+static void testBuild() {
+    std::cout << "Test 1: build() gives the dualContour mesh\n";
+    IncrementalDC dc;
+    dc.build(implicitTorus, 48);
+    DCGrid grid = buildGrid(implicitTorus, 48);
+    DCMesh mesh = dualContour(implicitTorus, grid);
+    check("same vertices", dc.mesh().vertices == mesh.vertices);
+    check("same triangles in the same order", dc.mesh().triangles == mesh.triangles);
+}
+
+// ---- Test 2: Brush stamps --------------------------------------------------------
+static void testStamps() {
+    std::cout << "Test 2: Brush stamps update like a full rebuild\n";
+    const int N = 64;
+    std::vector<Stamp> stamps;
+    IncrementalDC dc;
+    dc.build(stampedSphere(stamps), N);
+    const DCMesh original = dc.mesh();
+    const DCGrid originalGrid = dc.grid();
+
+    const Stamp strokes[] = {
+        {{0.75f, 0.0f, 0.0f}, 0.2f, 0.1f},
+        {{0.7f, 0.2f, 0.1f}, 0.15f, 0.08f},
+        {{0.0f, 0.0f, 0.75f}, 0.3f, -0.15f},   // carve
+        {{0.0f, 0.0f, 0.7f}, 0.3f, 0.3f},      // and fill back past it
+        {{-0.5f, 0.55f, 0.0f}, 0.1f, 0.12f},
+        {{0.98f, 0.0f, 0.0f}, 0.3f, 0.25f},    // reaches the grid boundary
+    };
+    bool allMatch = true;
+    for (const Stamp& s : strokes) {
+        stamps.push_back(s);
+        const Eigen::Vector3f reach = Eigen::Vector3f::Constant(s.radius);
+        dc.update(stampedSphere(stamps), s.centre - reach, s.centre + reach);
+        allMatch = allMatch && matchesRebuild(dc, stampedSphere(stamps));
+    }
+    check("every update matches a full rebuild", allMatch);
+
+    // Unreferenced slots are exactly the free ones
+    size_t cellVertices = 0;
+    for (int v : dc.grid().vertexIndex) cellVertices += v >= 0;
+    check("every vertex slot belongs to a cell or the free list",
+          cellVertices + dc.freeVertexCount() == dc.mesh().vertices.size());
+
+    // Cells away from every stroke keep their vertex index and position
+    int moved = 0, kept = 0;
+    for (int ck = 0; ck < N; ++ck)
+        for (int cj = 0; cj < N; ++cj)
+            for (int ci = 0; ci < N; ++ci) {
+                const int cell = ci + N * cj + N * N * ck;
+                const int v = originalGrid.vertexIndex[cell];
+                if (v < 0) continue;
+                const Eigen::Vector3f p(original.vertices[v][0], original.vertices[v][1], original.vertices[v][2]);
+                bool far = true;
+                for (const Stamp& s : strokes) far = far && (p - s.centre).norm() > s.radius + 0.1f;
+                if (!far) continue;
+                ++kept;
+                if (dc.grid().vertexIndex[cell] != v || dc.mesh().vertices[v] != original.vertices[v]) ++moved;
+            }
+    std::cout << "  " << kept << " vertices away from the strokes\n";
+    check("untouched vertices keep their index", kept > 0 && moved == 0);
+
+    // A box outside the grid is a no-op
+    const DCUpdateStats none = dc.update(stampedSphere(stamps), {2.f, 2.f, 2.f}, {3.f, 3.f, 3.f});
+    check("edit outside the grid does nothing", none.corners == 0 && none.cells == 0);
+}
+
+// ---- Test 3: Latency scales with the edit ------------------------------------------
+static void testLatency() {
+    std::cout << "Test 3: Update cost scales with the edit size\n";
+    const int N = 128;
+    using Clock = std::chrono::steady_clock;
+    std::vector<Stamp> stamps;
+    IncrementalDC dc;
+    auto t0 = Clock::now();
+    dc.build(stampedSphere(stamps), N);
+    const double buildMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    std::cout << "  N=" << N << " full build: " << buildMs << " ms\n";
+
+    long long previousCells = 0;
+    bool grows = true;
+    for (float radius : {0.05f, 0.1f, 0.2f}) {
+        stamps.push_back({{0.0f, 0.75f, 0.0f}, radius, 0.05f});
+        const Eigen::Vector3f reach = Eigen::Vector3f::Constant(radius);
+        t0 = Clock::now();
+        const DCUpdateStats stats = dc.update(stampedSphere(stamps), stamps.back().centre - reach,
+                                              stamps.back().centre + reach);
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        std::cout << "  radius " << radius << ": " << ms << " ms, " << stats.corners << " corners, "
+                  << stats.cells << " cells, " << stats.triangles << " triangles\n";
+        grows = grows && stats.cells > previousCells;
+        previousCells = stats.cells;
+        check("touches a small fraction of the grid", stats.corners * 20 < (N + 1) * (N + 1) * (N + 1));
+    }
+    check("work grows with the brush", grows);
+    check("large update still matches a full rebuild", matchesRebuild(dc, stampedSphere(stamps)));
+}
+
+int main() {
+    testBuild();
+    testStamps();
+    testLatency();
+
+    std::cout << "\nResults: " << g_pass << " passed, " << g_fail << " failed\n";
+    return g_fail > 0 ? 1 : 0;
+}
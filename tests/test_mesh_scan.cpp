@@ -0,0 +1,242 @@
+#include "mesh_scan.h"
+#include "mesh_sdf.h"
+#include "dual_contour.h"
+#include "implicit.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+static int g_pass = 0, g_fail = 0;
+
+static void check(const char* name, bool cond) {
+    if (cond) {
+        std::cout << "  PASS: " << name << "\n";
+        ++g_pass;
+    } else {
+        std::cout << "  FAIL: " << name << "\n";
+        ++g_fail;
+    }
+}
+
+// Closed UV sphere, wound outward
+static DCMesh makeSphereMesh(float radius, const float centre[3], int slices, int stacks) {
+    DCMesh mesh;
+    const float pi = 3.14159265358979f;
+    mesh.vertices.push_back({centre[0], centre[1], centre[2] + radius});
+    for (int s = 1; s < stacks; ++s) {
+        const float theta = pi * s / stacks;
+        for (int l = 0; l < slices; ++l) {
+            const float phi = 2.0f * pi * l / slices;
+            mesh.vertices.push_back({centre[0] + radius * std::sin(theta) * std::cos(phi),
+                                     centre[1] + radius * std::sin(theta) * std::sin(phi),
+                                     centre[2] + radius * std::cos(theta)});
+        }
+    }
+    mesh.vertices.push_back({centre[0], centre[1], centre[2] - radius});
+    const int south = static_cast<int>(mesh.vertices.size()) - 1;
+    auto ring = [&](int s, int l) { return 1 + (s - 1) * slices + (l % slices); };
+    for (int l = 0; l < slices; ++l) {
+        mesh.triangles.push_back({0, ring(1, l), ring(1, l + 1)});
+        mesh.triangles.push_back({south, ring(stacks - 1, l + 1), ring(stacks - 1, l)});
+        for (int s = 1; s < stacks - 1; ++s) {
+            mesh.triangles.push_back({ring(s, l), ring(s + 1, l), ring(s + 1, l + 1)});
+            mesh.triangles.push_back({ring(s, l), ring(s + 1, l + 1), ring(s, l + 1)});
+        }
+    }
+    return mesh;
+}
+
+// Axis-aligned cube [-half, half]^3 as 12 triangles, wound outward
+static DCMesh makeCubeMesh(float half) {
+    DCMesh mesh;
+    for (int c = 0; c < 8; ++c) {
+        mesh.vertices.push_back({c & 1 ? half : -half, c & 2 ? half : -half, c & 4 ? half : -half});
+    }
+    const int quads[6][4] = {{0, 4, 6, 2}, {1, 3, 7, 5}, {0, 1, 5, 4},
+                             {2, 6, 7, 3}, {0, 2, 3, 1}, {4, 5, 7, 6}};
+    for (const auto& q : quads) {
+        mesh.triangles.push_back({q[0], q[1], q[2]});
+        mesh.triangles.push_back({q[0], q[2], q[3]});
+    }
+    return mesh;
+}
+
+static const float CENTRE[3] = {0.013f, -0.021f, 0.007f};
+
+static float sphereDistance(float x, float y, float z) {
+    return std::sqrt((x - CENTRE[0]) * (x - CENTRE[0]) + (y - CENTRE[1]) * (y - CENTRE[1]) +
+                     (z - CENTRE[2]) * (z - CENTRE[2])) - 0.6f;
+}
+
+// ---- Test 1: Sphere mesh ---------------------------------------------------
+static void testSphere() {
+    std::cout << "Test 1: Scan-converted sphere mesh, N=48\n";
+    const DCMesh sphere = makeSphereMesh(0.6f, CENTRE, 64, 32);
+    const int N = 48;
+    ScanStats stats;
+    DCGrid grid = scanConvertMesh(sphere, N, -1.f, 1.f, 0, &stats);
+    std::cout << "  " << stats.lineHits << " line crossings\n";
+    check("every sign change has its own crossing", stats.inferredEdges == 0);
+
+    // Signs agree with the sphere away from the facets (sagitta < 0.003)
+    int wrongSigns = 0;
+    for (int k = 0; k <= N; ++k)
+        for (int j = 0; j <= N; ++j)
+            for (int i = 0; i <= N; ++i) {
+                const float d = sphereDistance(-1.f + i * grid.cellSize, -1.f + j * grid.cellSize,
+                                               -1.f + k * grid.cellSize);
+                const float v = grid.values[i + (N + 1) * (j + (N + 1) * k)];
+                if (std::abs(d) > 0.005f && (d < 0) != (v < 0)) ++wrongSigns;
+            }
+    check("corner signs match the sphere", wrongSigns == 0);
+
+    bool onSurface = true, unitNormals = true;
+    for (int axis = 0; axis < 3; ++axis) {
+        for (const HermiteEdge& e : grid.edges.edges[axis]) {
+            const Eigen::Vector3f& p = e.hermite.point;
+            onSurface = onSurface && std::abs(sphereDistance(p.x(), p.y(), p.z())) < 0.005f;
+            unitNormals = unitNormals && std::abs(e.hermite.normal.norm() - 1.f) < 1e-4f;
+        }
+    }
+    check("edge crossings lie on the sphere", onSurface);
+    check("edge normals have unit length", unitNormals);
+
+    DCMesh mesh = dualContourHermite(grid);
+    float worst = 0.f;
+    for (const auto& v : mesh.vertices) worst = std::max(worst, std::abs(sphereDistance(v[0], v[1], v[2])));
+    check("contoured", !mesh.vertices.empty() && !mesh.triangles.empty());
+    check("vertices on the sphere", worst < 0.1f * grid.cellSize + 0.005f);
+
+    // Same active cells as sampling the analytic sphere
+    ScalarField exact = sphereDistance;
+    DCGrid sampled = buildGrid(exact, N);
+    DCMesh reference = dualContour(exact, sampled);
+    std::cout << "  " << mesh.vertices.size() << " vertices, " << reference.vertices.size()
+              << " from the sampled sphere\n";
+    check("vertex count within 1% of the sampled sphere",
+          std::abs(int(mesh.vertices.size()) - int(reference.vertices.size())) * 100 <=
+              int(reference.vertices.size()));
+}
+
+// ---- Test 2: Lattice-aligned cube (ties everywhere) -------------------------
+static void testCube() {
+    std::cout << "Test 2: Cube with faces, edges and vertices on the lattice\n";
+    const DCMesh cube = makeCubeMesh(0.5f);  // 0.5 = -1 + 24 cells of 1/16
+    const int N = 32;
+    ScanStats stats;
+    DCGrid grid = scanConvertMesh(cube, N, -1.f, 1.f, 0, &stats);
+    check("every sign change has its own crossing", stats.inferredEdges == 0);
+
+    int wrongSigns = 0;
+    for (int k = 0; k <= N; ++k)
+        for (int j = 0; j <= N; ++j)
+            for (int i = 0; i <= N; ++i) {
+                const int m = std::max({std::abs(i - 16), std::abs(j - 16), std::abs(k - 16)});
+                const float v = grid.values[i + (N + 1) * (j + (N + 1) * k)];
+                if (m < 8 && v > 0) ++wrongSigns;
+                if (m > 8 && v < 0) ++wrongSigns;
+            }
+    check("corners off the faces have the right sign", wrongSigns == 0);
+
+    DCMesh mesh = dualContourHermite(grid);
+    float worst = 0.f;
+    for (const auto& v : mesh.vertices) {
+        const float m = std::max({std::abs(v[0]), std::abs(v[1]), std::abs(v[2])});
+        worst = std::max(worst, std::abs(m - 0.5f));
+    }
+    check("contoured", !mesh.triangles.empty());
+    check("vertices on the cube", worst < 1e-4f);
+
+    // Closed: every undirected edge is shared by exactly two triangles
+    std::vector<std::pair<int, int>> halfEdges;
+    for (const auto& t : mesh.triangles)
+        for (int e = 0; e < 3; ++e)
+            halfEdges.push_back({std::min(t[e], t[(e + 1) % 3]), std::max(t[e], t[(e + 1) % 3])});
+    std::sort(halfEdges.begin(), halfEdges.end());
+    bool closed = !halfEdges.empty();
+    for (size_t e = 0; e < halfEdges.size(); e += 2) {
+        closed = closed && e + 1 < halfEdges.size() && halfEdges[e] == halfEdges[e + 1] &&
+                 (e + 2 >= halfEdges.size() || halfEdges[e + 2] != halfEdges[e]);
+    }
+    check("mesh is closed", closed);
+}
+
+// ---- Test 3: Deterministic across thread counts ----------------------------
+static void testThreads() {
+    std::cout << "Test 3: Identical output for 1 and 4 threads\n";
+    const DCMesh sphere = makeSphereMesh(0.6f, CENTRE, 48, 24);
+    DCGrid a = scanConvertMesh(sphere, 40, -1.f, 1.f, 1);
+    DCGrid b = scanConvertMesh(sphere, 40, -1.f, 1.f, 4);
+    check("same corner signs", a.values == b.values);
+    bool sameEdges = true;
+    for (int axis = 0; axis < 3; ++axis) {
+        sameEdges = sameEdges && a.edges.edges[axis].size() == b.edges.edges[axis].size();
+        for (size_t e = 0; sameEdges && e < a.edges.edges[axis].size(); ++e) {
+            sameEdges = a.edges.edges[axis][e].hermite.point == b.edges.edges[axis][e].hermite.point &&
+                        a.edges.edges[axis][e].hermite.normal == b.edges.edges[axis][e].hermite.normal;
+        }
+    }
+    check("same Hermite edges", sameEdges);
+    DCMesh ma = dualContourHermite(a, 1), mb = dualContourHermite(b, 4);
+    check("same mesh", ma.vertices == mb.vertices && ma.triangles == mb.triangles);
+}
+
+// ---- Test 4: Cost scales with surface area ---------------------------------
+static void testScaling() {
+    std::cout << "Test 4: Line crossings grow with N^2, not N^3\n";
+    const DCMesh sphere = makeSphereMesh(0.6f, CENTRE, 64, 32);
+    ScanStats coarse, fine;
+    scanConvertMesh(sphere, 32, -1.f, 1.f, 0, &coarse);
+    scanConvertMesh(sphere, 64, -1.f, 1.f, 0, &fine);
+    const double ratio = double(fine.lineHits) / coarse.lineHits;
+    std::cout << "  crossings at N=32: " << coarse.lineHits << ", N=64: " << fine.lineHits << "\n";
+    check("doubling N quadruples the crossings", ratio > 3.5 && ratio < 4.5);
+}
+
+// With --bench: the teapot through scan conversion vs. sampling its MeshSDF
+static void benchTeapot() {
+    std::cout << "Bench: teapot, scan conversion vs. MeshSDF sampling\n";
+    std::shared_ptr<const MeshSDF> teapot = MeshSDF::load(DATA_DIR "/teapot.obj");
+    if (!teapot) {
+        std::cout << "  teapot not available\n";
+        return;
+    }
+    const DCMesh surface = teapot->surface();
+    ImplicitField field = meshSDFField(teapot);
+    using Clock = std::chrono::steady_clock;
+    for (int N : {64, 128, 256}) {
+        auto t0 = Clock::now();
+        DCGrid scanned = scanConvertMesh(surface, N);
+        DCMesh a = dualContourHermite(scanned);
+        auto t1 = Clock::now();
+        DCGrid sampled = buildGrid(field, N);
+        DCMesh b = dualContour(field, sampled);
+        auto t2 = Clock::now();
+        size_t agree = 0;
+        for (size_t c = 0; c < scanned.values.size(); ++c) {
+            if ((scanned.values[c] < 0) == (sampled.values[c] < 0)) ++agree;
+        }
+        std::cout << "  N=" << N << ": scan " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+                  << " ms (" << a.vertices.size() << " vertices), SDF "
+                  << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms ("
+                  << b.vertices.size() << " vertices), signs agree at "
+                  << 100.0 * agree / scanned.values.size() << "% of corners\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    const bool bench = argc > 1 && std::strcmp(argv[1], "--bench") == 0;
+
+    testSphere();
+    testCube();
+    testThreads();
+    testScaling();
+    if (bench) benchTeapot();
+
+    std::cout << "\nResults: " << g_pass << " passed, " << g_fail << " failed\n";
+    return g_fail > 0 ? 1 : 0;
+}
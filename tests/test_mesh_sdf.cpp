@@ -1,9 +1,26 @@
 #include "mesh_sdf.h"
+#include "sdf_volume.h"
+#include "mapped_file.h"
 #include "implicit.h"
+#include "dual_contour.h"
+#include "parallel.h"
+#include <igl/AABB.h>
 #include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
 #include <string>
+#include <vector>
 
 static int g_pass = 0, g_fail = 0;
 
@@ -17,7 +34,784 @@ static void check(const char* name, bool cond) {
     }
 }
 
-int main() {
+// Coherent (hinted) queries may settle on another of several equally close
+// faces than distance() does, which moves the result by rounding only
+static bool sameDistance(float a, float b) {
+    return std::abs(a - b) <= 1e-6f;
+}
+
+// Write a UV sphere OBJ with about `faces` triangles
+static void writeSphereOBJ(const std::string& path, int faces) {
+    const int rings = static_cast<int>(std::sqrt(faces / 2.0)), segments = rings;
+    std::ofstream out(path);
+    out << "v 0 0 1\nv 0 0 -1\n";
+    for (int r = 1; r < rings; ++r) {
+        const double theta = M_PI * r / rings;
+        for (int s = 0; s < segments; ++s) {
+            const double phi = 2.0 * M_PI * s / segments;
+            out << "v " << std::sin(theta) * std::cos(phi) << " " << std::sin(theta) * std::sin(phi)
+                << " " << std::cos(theta) << "\n";
+        }
+    }
+    auto ring = [&](int r, int s) { return 3 + (r - 1) * segments + (s % segments); };
+    for (int s = 0; s < segments; ++s) {
+        out << "f 1 " << ring(1, s) << " " << ring(1, s + 1) << "\n";
+        out << "f 2 " << ring(rings - 1, s + 1) << " " << ring(rings - 1, s) << "\n";
+    }
+    for (int r = 1; r + 1 < rings; ++r)
+        for (int s = 0; s < segments; ++s)
+            out << "f " << ring(r, s) << " " << ring(r + 1, s) << " " << ring(r + 1, s + 1) << " "
+                << ring(r, s + 1) << "\n";
+}
+
+// Parallel meshing of the teapot must be bit-identical to the serial path.
+// With --bench, also prints a scaling report at N=64/128/256.
+static void testParallelTeapot(bool bench) {
+    std::cout << "Test 6: Parallel teapot meshing\n";
+    DCGrid serialGrid = buildGrid(implicitMeshSDF, 32, -1.f, 1.f, 1);
+    DCMesh serial = dualContour(implicitMeshSDF, serialGrid, 1);
+    DCGrid grid = buildGrid(implicitMeshSDF, 32, -1.f, 1.f, 4);
+    DCMesh mesh = dualContour(implicitMeshSDF, grid, 4);
+    check("teapot mesh bit-identical for 1 and 4 threads",
+          mesh.vertices == serial.vertices && mesh.triangles == serial.triangles);
+
+    if (!bench) return;
+    using Clock = std::chrono::steady_clock;
+    for (int N : {64, 128, 256}) {
+        double serialMs = 0.0;
+        for (int threads : {1, 2, 4, 8}) {
+            auto t0 = Clock::now();
+            DCGrid g = buildGrid(implicitMeshSDF, N, -1.f, 1.f, threads);
+            DCMesh m = dualContour(implicitMeshSDF, g, threads);
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+            if (threads == 1) serialMs = ms;
+            std::cout << "  N=" << N << " threads=" << threads << ": " << ms << " ms ("
+                      << serialMs / ms << "x), " << m.vertices.size() << " vertices\n";
+        }
+    }
+}
+
+// The batch query must match the point query, both for one large
+// (multi-task) batch and through buildGrid, and must not depend on the thread
+// count. With --bench, compares sampling the teapot at N=128 point by point on
+// one thread with the batched field on 1, 2, 4 and 8 threads.
+static void testBatchQuery(bool bench) {
+    std::cout << "Test 7: Batched mesh SDF queries\n";
+    const int n = 5000;
+    std::vector<float> xs(n), ys(n), zs(n), out(n);
+    for (int i = 0; i < n; ++i) {
+        xs[i] = -1.f + 2.f * ((i * 37) % n) / n;
+        ys[i] = -1.f + 2.f * ((i * 61) % n) / n;
+        zs[i] = -1.f + 2.f * ((i * 89) % n) / n;
+    }
+    implicitMeshSDFBatch(xs.data(), ys.data(), zs.data(), out.data(), n);
+    bool identical = true;
+    for (int i = 0; i < n; ++i) {
+        if (!sameDistance(out[i], implicitMeshSDF(xs[i], ys[i], zs[i]))) identical = false;
+    }
+    check("batch equals point queries", identical);
+
+    DCGrid pointGrid = buildGrid(implicitMeshSDF, 32);
+    DCGrid batchGrid = buildGrid(meshSDFField(), 32);
+    bool samples = pointGrid.values.size() == batchGrid.values.size();
+    for (size_t i = 0; samples && i < pointGrid.values.size(); ++i) {
+        samples = sameDistance(pointGrid.values[i], batchGrid.values[i]);
+    }
+    check("buildGrid samples match with the batch kernel", samples);
+
+    // The batch runs on the threads it is given, with the same result
+    std::shared_ptr<const MeshSDF> teapot = MeshSDF::load(DATA_DIR "/teapot.obj");
+    std::vector<float> serial(n);
+    teapot->distanceBatch(xs.data(), ys.data(), zs.data(), serial.data(), n, 1);
+    teapot->distanceBatch(xs.data(), ys.data(), zs.data(), out.data(), n, 4);
+    check("batch identical on 1 and 4 threads", serial == out);
+
+    if (!bench) return;
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+    buildGrid(implicitMeshSDF, 128, -1.f, 1.f, 1);
+    double pointMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    std::cout << "  N=128: point queries on 1 thread " << pointMs << " ms\n";
+    for (int threads : {1, 2, 4, 8}) {
+        t0 = Clock::now();
+        buildGrid(meshSDFField(teapot, threads), 128, -1.f, 1.f, threads);
+        double batchMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        std::cout << "  N=128: batched on " << threads << " threads " << batchMs << " ms ("
+                  << pointMs / batchMs << "x; target 8x on 8 cores)\n";
+    }
+}
+
+// Coarse-to-fine sampling of a closed mesh's SDF must reproduce the full-grid
+// mesh. The teapot is open: its pseudonormal sign also flips across sheets away
+// from the surface, where a skipped block keeps one sign, so it is only checked
+// for the evaluations saved. With --bench, also reports the evaluations saved
+// at N=256 for the teapot and the gear (when its OBJ is present).
+static void testHierarchicalMeshSDF(bool bench) {
+    std::cout << "Test 8: Hierarchical mesh SDF sampling\n";
+    const std::string spherePath = "test_mesh_sdf_closed.obj";
+    writeSphereOBJ(spherePath, 5000);
+    std::shared_ptr<const MeshSDF> closed = MeshSDF::load(spherePath);
+    std::remove(spherePath.c_str());
+    if (!closed) {
+        check("closed sphere loads", false);
+        return;
+    }
+    const ImplicitField sphere = meshSDFField(closed);
+    DCGrid dense = buildGrid(sphere, 48);
+    DCMesh denseMesh = dualContour(sphere, dense);
+    SamplingStats stats;
+    DCGrid grid = buildGridHierarchical(sphere, 48, -1.f, 1.f, 0, 1.f, &stats);
+    DCMesh mesh = dualContour(sphere, grid);
+    std::cout << "  closed sphere N=48: " << stats.total() << " of " << stats.denseEvaluations
+              << " evaluations\n";
+    check("closed mesh hierarchical mesh identical to full grid",
+          mesh.vertices == denseMesh.vertices && mesh.triangles == denseMesh.triangles);
+
+    buildGridHierarchical(implicitMeshSDF, 48, -1.f, 1.f, 0, 1.f, &stats);
+    std::cout << "  teapot N=48: " << stats.total() << " of " << stats.denseEvaluations << " evaluations\n";
+    check("teapot hierarchical sampling saves evaluations", stats.total() < stats.denseEvaluations);
+
+    if (!bench) return;
+    using Clock = std::chrono::steady_clock;
+    for (const char* path : {DATA_DIR "/teapot.obj", DATA_DIR "/GEAR.obj"}) {
+        if (!std::ifstream(path) || !loadMeshSDF(path)) {
+            std::cout << "  " << path << " not available, skipped\n";
+            continue;
+        }
+        auto t0 = Clock::now();
+        buildGridHierarchical(implicitMeshSDF, 256, -1.f, 1.f, 0, 1.f, &stats);
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        std::cout << "  " << path << " N=256: " << stats.total() << " of " << stats.denseEvaluations
+                  << " evaluations (" << 100.0 * stats.total() / stats.denseEvaluations
+                  << "%), " << ms << " ms\n";
+    }
+}
+
+// Independent MeshSDF instances, concurrent queries and the LRU registry.
+static void testInstances() {
+    std::cout << "Test 10: MeshSDF instances\n";
+    const std::string teapotPath = DATA_DIR "/teapot.obj";
+    const std::string cubePath = "test_mesh_sdf_cube.obj";
+    {
+        std::ofstream cube(cubePath);
+        cube << "v -1 -1 -1\nv 1 -1 -1\nv 1 1 -1\nv -1 1 -1\n"
+                "v -1 -1 1\nv 1 -1 1\nv 1 1 1\nv -1 1 1\n"
+                "f 1 4 3 2\nf 5 6 7 8\nf 1 2 6 5\nf 2 3 7 6\nf 3 4 8 7\nf 4 1 5 8\n";
+    }
+
+    MeshSDFCache cache(1);
+    std::shared_ptr<const MeshSDF> teapot = cache.get(teapotPath);
+    check("teapot instance loads", teapot != nullptr);
+    if (!teapot) return;
+    check("repeated get returns the cached instance", cache.get(teapotPath) == teapot);
+    std::shared_ptr<const MeshSDF> cube = cache.get(cubePath);
+    check("cube instance loads", cube != nullptr && cube->numTriangles() == 12);
+    check("capacity 1 evicts the teapot", cache.size() == 1 && cache.get(teapotPath) != teapot);
+    check("evicted instance stays usable", teapot->distance(0.f, 0.f, 0.f) < 0.f);
+
+    // Both meshes answer side by side
+    check("cube centre at -0.9", std::abs(cube->distance(0.f, 0.f, 0.f) + 0.9f) < 1e-5f);
+    loadMeshSDF(teapotPath);
+    check("teapot instance matches implicitMeshSDF",
+          teapot->distance(0.3f, 0.2f, -0.1f) == implicitMeshSDF(0.3f, 0.2f, -0.1f));
+
+    // Concurrent queries on one instance
+    const int n = 4000;
+    std::vector<float> expected(n), parallel(n);
+    auto point = [](int i, int axis) { return -1.f + 2.f * ((i * (31 + 26 * axis)) % n) / n; };
+    for (int i = 0; i < n; ++i) expected[i] = teapot->distance(point(i, 0), point(i, 1), point(i, 2));
+    parallelFor(0, n, 4, [&](int i) {
+        parallel[i] = teapot->distance(point(i, 0), point(i, 1), point(i, 2));
+    });
+    check("concurrent queries match serial ones", parallel == expected);
+
+    // Bound into the field interface
+    DCGrid bound = buildGrid(meshSDFField(cube), 24);
+    ScalarField cubeField = [](float x, float y, float z) {
+        return std::max(std::abs(x), std::max(std::abs(y), std::abs(z))) - 0.9f;
+    };
+    DCGrid reference = buildGrid(cubeField, 24);
+    bool signsAgree = true;
+    for (size_t v = 0; v < bound.values.size(); ++v) {
+        if ((bound.values[v] < 0) != (reference.values[v] < 0)) signsAgree = false;
+    }
+    check("bound cube field samples the cube", signsAgree);
+    std::remove(cubePath.c_str());
+}
+
+// A second load must map the existing bake instead of baking again, and other
+// bake options must bake again. The volume must agree with the exact SDF near
+// the surface of a closed mesh. The teapot is open, so its pseudonormal sign
+// jumps across sheets leaving the boundary; no interpolated lattice follows
+// that, so it is only used for the caching.
+static void testCachedVolumes() {
+    std::cout << "Test 9: Baked SDF volumes\n";
+    const std::string objPath = DATA_DIR "/teapot.obj";
+    const std::string volumePath = "test_mesh_sdf_teapot.sdfv";
+    std::remove(volumePath.c_str());
+    check("first load bakes the volume", loadCachedMeshSDF(objPath, volumePath));
+
+    SDFVolume volume;
+    check("bake keyed by the OBJ contents", volume.open(volumePath, hashFileContents(objPath)));
+    check("stale key rejected", !volume.open(volumePath, hashFileContents(objPath) + 1));
+    check("second load maps the existing bake", loadCachedMeshSDF(objPath, volumePath));
+    check("centre inside", implicitCachedMeshSDF(0.f, 0.f, 0.f) < 0.f);
+
+    SDFBakeOptions coarse;
+    coarse.resolution = 64;
+    check("other options bake again", loadCachedMeshSDF(objPath, volumePath, coarse) &&
+                                      volume.open(volumePath, hashFileContents(objPath)) &&
+                                      volume.resolution() == 64 && volume.matches(coarse));
+    volume.close();
+    std::remove(volumePath.c_str());
+
+    const std::string spherePath = "test_mesh_sdf_sphere.obj";
+    const std::string sphereVolumePath = "test_mesh_sdf_sphere.sdfv";
+    writeSphereOBJ(spherePath, 20000);
+    check("closed sphere bakes", loadCachedMeshSDF(spherePath, sphereVolumePath));
+    std::shared_ptr<const MeshSDF> sphere = MeshSDF::load(spherePath);
+    const float cellSize = 2.0f / SDFBakeOptions().resolution;
+    float worst = 0.0f;
+    int nearSurface = 0;
+    for (int i = 0; i < 4000; ++i) {
+        const float x = -0.9f + 1.8f * ((i * 37) % 4000) / 4000.f;
+        const float y = -0.9f + 1.8f * ((i * 61) % 4000) / 4000.f;
+        const float z = -0.9f + 1.8f * ((i * 89) % 4000) / 4000.f;
+        const float exact = sphere->distance(x, y, z);
+        if (std::abs(exact) > cellSize) continue;
+        ++nearSurface;
+        worst = std::max(worst, std::abs(implicitCachedMeshSDF(x, y, z) - exact));
+    }
+    std::cout << "  max error over " << nearSurface << " near-surface points: " << worst << "\n";
+    check("volume within half a cell of the exact SDF", nearSurface > 0 && worst < 0.5f * cellSize);
+    std::remove(spherePath.c_str());
+    std::remove(sphereVolumePath.c_str());
+}
+
+// The binary mesh cache must reproduce the OBJ-built MeshSDF exactly. With
+// --bench, compares OBJ and cached startup on the teapot and a 1M-face sphere.
+static void testBinaryCache(bool bench) {
+    std::cout << "Test 11: Binary mesh cache\n";
+    const std::string objPath = DATA_DIR "/teapot.obj";
+    const std::string binaryPath = "test_mesh_sdf_teapot.meshbin";
+    const uint64_t hash = hashFileContents(objPath);
+
+    std::shared_ptr<const MeshSDF> parsed = MeshSDF::load(objPath);
+    check("binary written", parsed && parsed->writeBinary(binaryPath, hash));
+    std::shared_ptr<const MeshSDF> mapped = MeshSDF::loadBinary(binaryPath, hash);
+    check("binary loads", mapped != nullptr);
+    if (!parsed || !mapped) return;
+    check("stale binary rejected", MeshSDF::loadBinary(binaryPath, hash + 1) == nullptr);
+
+    bool identical = mapped->numTriangles() == parsed->numTriangles();
+    for (int i = 0; i < 3000 && identical; ++i) {
+        const float x = -1.f + 2.f * ((i * 37) % 3000) / 3000.f;
+        const float y = -1.f + 2.f * ((i * 61) % 3000) / 3000.f;
+        const float z = -1.f + 2.f * ((i * 89) % 3000) / 3000.f;
+        identical = mapped->distance(x, y, z) == parsed->distance(x, y, z);
+    }
+    check("cached mesh gives identical distances", identical);
+
+    std::vector<char> bytes;
+    {
+        std::ifstream in(binaryPath, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    // 2^60 more vertices add 48 * 2^60 = 0 (mod 2^64) bytes to a size
+    // computed without overflow checks
+    std::vector<char> wrapped = bytes;
+    uint64_t numVertices = 0;
+    std::memcpy(&numVertices, &wrapped[16], sizeof(numVertices));
+    numVertices += uint64_t(1) << 60;
+    std::memcpy(&wrapped[16], &numVertices, sizeof(numVertices));
+    std::ofstream(binaryPath, std::ios::binary).write(wrapped.data(), wrapped.size());
+    check("vertex count wrapping the file size rejected", MeshSDF::loadBinary(binaryPath, hash) == nullptr);
+
+    // The last pre-order node is a leaf; point it past the last triangle
+    const int32_t badFace = parsed->numTriangles();
+    const size_t nodeBytes = 6 * sizeof(double) + 2 * sizeof(int32_t);
+    std::memcpy(&bytes[bytes.size() - nodeBytes + 6 * sizeof(double)], &badFace, sizeof(badFace));
+    std::ofstream(binaryPath, std::ios::binary).write(bytes.data(), bytes.size());
+    check("out-of-range leaf triangle rejected", MeshSDF::loadBinary(binaryPath, hash) == nullptr);
+    std::remove(binaryPath.c_str());
+
+    // load() only caches when given a directory, and never beside the OBJ
+    const std::string cachePath = MeshSDF::binaryCachePath(".", hash);
+    std::remove(cachePath.c_str());
+    MeshSDF::load(objPath);
+    check("no cache without a cache directory",
+          !std::ifstream(cachePath) && !std::ifstream(objPath + ".meshbin"));
+    std::shared_ptr<const MeshSDF> first = MeshSDF::load(objPath, MeshSign::Pseudonormal, ".");
+    std::shared_ptr<const MeshSDF> second = MeshSDF::load(objPath, MeshSign::Pseudonormal, ".");
+    check("cache written to the cache directory",
+          std::ifstream(cachePath) && !std::ifstream(objPath + ".meshbin"));
+    check("cached load matches", first && second &&
+                                 second->distance(0.3f, 0.2f, -0.1f) == parsed->distance(0.3f, 0.2f, -0.1f));
+    std::remove(cachePath.c_str());
+    const std::string nestedPath = MeshSDF::binaryCachePath("test_mesh_sdf_cache/nested", hash);
+    MeshSDF::load(objPath, MeshSign::Pseudonormal, "test_mesh_sdf_cache/nested");
+    check("missing cache directory created", std::ifstream(nestedPath).good());
+    std::remove(nestedPath.c_str());
+    std::remove("test_mesh_sdf_cache/nested");
+    std::remove("test_mesh_sdf_cache");
+
+    if (!bench) return;
+    using Clock = std::chrono::steady_clock;
+    const std::string spherePath = "test_mesh_sdf_sphere_1m.obj";
+    writeSphereOBJ(spherePath, 1000000);
+    for (const std::string& path : {objPath, spherePath}) {
+        const std::string pathCache = MeshSDF::binaryCachePath(".", hashFileContents(path));
+        std::remove(pathCache.c_str());
+        auto t0 = Clock::now();
+        // Parses and writes the cache
+        std::shared_ptr<const MeshSDF> first = MeshSDF::load(path, MeshSign::Pseudonormal, ".");
+        double objMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        t0 = Clock::now();
+        std::shared_ptr<const MeshSDF> second = MeshSDF::load(path, MeshSign::Pseudonormal, ".");
+        double cachedMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        std::cout << "  " << path << ": " << (first ? first->numTriangles() : 0) << " triangles, OBJ "
+                  << objMs << " ms, binary cache " << cachedMs << " ms (" << objMs / cachedMs << "x)\n";
+        std::remove(pathCache.c_str());
+    }
+    std::remove(spherePath.c_str());
+}
+
+// One query yields distance, closest point and normal. With --bench, compares
+// dualContour on the teapot at N=128 with central-difference normals and with
+// the combined query.
+static void testCombinedQuery(bool bench) {
+    std::cout << "Test 12: Combined distance/closest-point/normal query\n";
+    std::shared_ptr<const MeshSDF> teapot = MeshSDF::load(DATA_DIR "/teapot.obj");
+    if (!teapot) {
+        check("teapot loads", false);
+        return;
+    }
+
+    int samples = 0, sameDistance = 0, unitNormal = 0, closestOnSurface = 0, matchesDifferences = 0;
+    for (int i = 0; i < 3000; ++i) {
+        const float x = -0.95f + 1.9f * ((i * 37) % 3000) / 3000.f;
+        const float y = -0.95f + 1.9f * ((i * 61) % 3000) / 3000.f;
+        const float z = -0.95f + 1.9f * ((i * 89) % 3000) / 3000.f;
+        const float d = teapot->distance(x, y, z);
+        if (std::abs(d) > 0.1f) continue;
+        ++samples;
+        Eigen::Vector3f normal, closest;
+        if (teapot->query(x, y, z, normal, &closest) == d) ++sameDistance;
+        if (std::abs(normal.norm() - 1.0f) < 1e-4f) ++unitNormal;
+        if (std::abs(teapot->distance(closest.x(), closest.y(), closest.z())) < 1e-4f) ++closestOnSurface;
+
+        // Off the surface, the gradient equals central differences of the field
+        const float eps = 1e-3f;
+        Eigen::Vector3f fd(teapot->distance(x + eps, y, z) - teapot->distance(x - eps, y, z),
+                           teapot->distance(x, y + eps, z) - teapot->distance(x, y - eps, z),
+                           teapot->distance(x, y, z + eps) - teapot->distance(x, y, z - eps));
+        if (fd.normalized().dot(normal) > 0.98f) ++matchesDifferences;
+    }
+    std::cout << "  " << samples << " near-surface samples, " << matchesDifferences
+              << " with normals within ~11 degrees of central differences\n";
+    check("found near-surface samples", samples > 0);
+    check("query distance equals distance()", sameDistance == samples);
+    check("normals have unit length", unitNormal == samples);
+    check("closest points lie on the surface", closestOnSurface == samples);
+    check("normals agree with central differences (>= 95%)", matchesDifferences >= samples * 95 / 100);
+
+    // The bound field uses the query for Hermite normals, on the same sign grid
+    ImplicitField combined = meshSDFField(teapot);
+    ImplicitField differences;
+    differences.eval = combined.eval;
+    differences.evalBatch = combined.evalBatch;
+    DCGrid gridA = buildGrid(combined, 48);
+    DCGrid gridB = buildGrid(differences, 48);
+    DCMesh meshA = dualContour(combined, gridA);
+    DCMesh meshB = dualContour(differences, gridB);
+    check("same active cells with either normal source", meshA.vertices.size() == meshB.vertices.size());
+
+    if (!bench) return;
+    using Clock = std::chrono::steady_clock;
+    for (const ImplicitField* field : {&differences, &combined}) {
+        DCGrid grid = buildGrid(*field, 128);
+        auto t0 = Clock::now();
+        DCMesh mesh = dualContour(*field, grid);
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        std::cout << "  N=128 dualContour with " << (field == &combined ? "combined query" : "central differences")
+                  << ": " << ms << " ms, " << mesh.vertices.size() << " vertices\n";
+    }
+}
+
+// ---- Test 13: Spatially coherent queries ----------------------------------
+// Scan-order queries seeded from the previous result match distance(), and a
+// hint that is too tight falls back to the unbounded query. A copy of the
+// bounded descent counts the AABB nodes a query visits with and without the
+// hint. With --bench, times the seeded and unseeded queries and buildGrid at
+// N=128 with and without the hints.
+
+using MeshTree = igl::AABB<Eigen::MatrixXd, 3>;
+
+// MeshTree::squared_distance(V, F, p, 0, upSqr, face, closest), counting the
+// nodes it visits: children whose box holds p first, then the others, nearer
+// box first, while their box could still hold a closer triangle. Leaves
+// measure their triangle with the library's own query. face is left alone
+// unless a triangle closer than upSqr is found.
+static double countedSquaredDistance(const MeshTree& node, const Eigen::MatrixXd& V, const Eigen::MatrixXi& F,
+                                     const Eigen::RowVector3d& p, double upSqr, int& face, long long& visited) {
+    ++visited;
+    if (node.is_leaf()) {
+        int leafFace = -1;
+        Eigen::RowVector3d closest;
+        const double d = node.squared_distance(V, F, p, 0.0, upSqr, leafFace, closest);
+        if (leafFace < 0 || !(d < upSqr)) return upSqr;
+        face = leafFace;
+        return d;
+    }
+    double best = upSqr;
+    bool lookedLeft = false, lookedRight = false;
+    auto look = [&](const MeshTree& child, bool& looked) {
+        best = countedSquaredDistance(child, V, F, p, best, face, visited);
+        looked = true;
+    };
+    if (node.m_left->m_box.contains(p.transpose())) look(*node.m_left, lookedLeft);
+    if (node.m_right->m_box.contains(p.transpose())) look(*node.m_right, lookedRight);
+    const double left = node.m_left->m_box.squaredExteriorDistance(p.transpose());
+    const double right = node.m_right->m_box.squaredExteriorDistance(p.transpose());
+    if (left < right) {
+        if (!lookedLeft && left < best) look(*node.m_left, lookedLeft);
+        if (!lookedRight && right < best) look(*node.m_right, lookedRight);
+    } else {
+        if (!lookedRight && right < best) look(*node.m_right, lookedRight);
+        if (!lookedLeft && left < best) look(*node.m_left, lookedLeft);
+    }
+    return best;
+}
+
+static void testCoherentQuery(bool bench) {
+    std::cout << "Test 13: Coherent queries with per-thread hints\n";
+    std::shared_ptr<const MeshSDF> teapot = MeshSDF::load(DATA_DIR "/teapot.obj");
+    if (!teapot) {
+        check("teapot loads", false);
+        return;
+    }
+
+    // One 64^2 slab per thread in the order buildGrid walks it
+    const int N = 64;
+    const float cellSize = 2.0f / N;
+    MeshSDFQueryState coherent, cold;
+    int queries = 0, same = 0, exact = 0;
+    for (int k = 20; k < 24; ++k)
+        for (int j = 0; j <= N; ++j)
+            for (int i = 0; i <= N; ++i) {
+                const float x = -1.f + i * cellSize, y = -1.f + j * cellSize, z = -1.f + k * cellSize;
+                cold.mesh = nullptr;  // forget the hint: a plain unbounded query
+                const float d = teapot->distanceCoherent(x, y, z, coherent);
+                const float reference = teapot->distance(x, y, z);
+                if (sameDistance(d, reference) && teapot->distanceCoherent(x, y, z, cold) == reference) ++same;
+                exact += d == reference;
+                ++queries;
+            }
+    std::cout << "  " << exact << " of " << queries << " seeded distances bit-identical to distance()\n";
+    check("coherent distances equal distance()", same == queries && coherent.queries == queries);
+
+    // Nodes visited along the same slabs, over a tree of the same triangles,
+    // with distanceCoherent's bound and its unbounded fallback
+    const DCMesh surface = teapot->surface();
+    Eigen::MatrixXd V(surface.vertices.size(), 3);
+    Eigen::MatrixXi F(surface.triangles.size(), 3);
+    for (size_t v = 0; v < surface.vertices.size(); ++v)
+        for (int a = 0; a < 3; ++a) V(v, a) = surface.vertices[v][a];
+    for (size_t t = 0; t < surface.triangles.size(); ++t)
+        for (int a = 0; a < 3; ++a) F(t, a) = surface.triangles[t][a];
+    MeshTree tree;
+    tree.init(V, F);
+    const double unbounded = std::numeric_limits<double>::infinity();
+    long long unseededNodes = 0, seededNodes = 0;
+    int descentSame = 0;
+    Eigen::RowVector3d last = Eigen::RowVector3d::Zero();
+    double lastDistance = -1.0;
+    for (int k = 20; k < 24; ++k)
+        for (int j = 0; j <= N; ++j)
+            for (int i = 0; i <= N; ++i) {
+                const Eigen::RowVector3d p(-1.f + i * cellSize, -1.f + j * cellSize, -1.f + k * cellSize);
+                int face = -1, seededFace = -1;
+                const double plain = countedSquaredDistance(tree, V, F, p, unbounded, face, unseededNodes);
+                double seeded = unbounded;
+                if (lastDistance >= 0.0) {
+                    const double bound = lastDistance + (p - last).norm();
+                    const double boundSqr = bound * bound * (1.0 + 1e-9);
+                    seeded = countedSquaredDistance(tree, V, F, p, boundSqr, seededFace, seededNodes);
+                }
+                if (seededFace < 0) seeded = countedSquaredDistance(tree, V, F, p, unbounded, seededFace, seededNodes);
+                Eigen::RowVector3d closest;
+                int libraryFace = -1;
+                const double library = tree.squared_distance(V, F, p, libraryFace, closest);
+                if (plain == library && std::abs(seeded - library) <= 1e-12) ++descentSame;
+                last = p;
+                lastDistance = std::sqrt(seeded);
+            }
+    std::cout << "  AABB nodes visited per query: " << double(unseededNodes) / queries << " unseeded, "
+              << double(seededNodes) / queries << " seeded\n";
+    check("counted descent finds the library's distance", descentSame == queries);
+    check("hints visit fewer nodes", seededNodes < unseededNodes);
+
+    // A wrong hint only costs a restart
+    MeshSDFQueryState stale;
+    stale.mesh = teapot.get();
+    stale.lastPoint[1] = 5.0;  // claims (0,5,0) lies on the surface
+    stale.lastDistance = 0.0;
+    check("too-tight hint still gives the exact distance",
+          teapot->distanceCoherent(0.f, 5.f, 0.f, stale) == teapot->distance(0.f, 5.f, 0.f));
+
+    // Batches start each run from a fresh hint
+    std::vector<float> xs(N + 1), ys(N + 1, 0.1f), zs(N + 1, -0.2f), out(N + 1);
+    for (int i = 0; i <= N; ++i) xs[i] = -1.f + i * cellSize;
+    teapot->distanceBatch(xs.data(), ys.data(), zs.data(), out.data(), N + 1);
+    bool batchSame = true;
+    for (int i = 0; i <= N; ++i) {
+        batchSame = batchSame && sameDistance(out[i], teapot->distance(xs[i], ys[i], zs[i]));
+    }
+    check("batched coherent distances equal distance()", batchSame);
+
+    if (!bench) return;
+    using Clock = std::chrono::steady_clock;
+    for (bool seeded : {false, true}) {
+        MeshSDFQueryState state;
+        auto t0 = Clock::now();
+        for (int k = 0; k <= N; ++k)
+            for (int j = 0; j <= N; ++j)
+                for (int i = 0; i <= N; ++i) {
+                    if (!seeded) state.mesh = nullptr;
+                    teapot->distanceCoherent(-1.f + i * cellSize, -1.f + j * cellSize, -1.f + k * cellSize, state);
+                }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / state.queries;
+        std::cout << "  " << (seeded ? "seeded" : "unseeded") << " queries in scan order: " << ns << " ns each\n";
+    }
+    ImplicitField plain;
+    plain.eval = meshSDFField(teapot).eval;
+    ImplicitField batched = meshSDFField(teapot);
+    for (const ImplicitField* field : {&plain, &batched}) {
+        auto t0 = Clock::now();
+        DCGrid grid = buildGrid(*field, 128);
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        std::cout << "  N=128 buildGrid " << (field == &batched ? "with" : "without")
+                  << " coherent hints: " << ms << " ms\n";
+    }
+}
+
+// ---- Test 14: Winding-number signs on an open mesh --------------------------
+// The teapot with every 20th face removed: winding-number signs stay close to
+// those of the intact mesh, pseudonormal signs do not. Without its lid, batched
+// signs across the one large hole still equal distance(). On both, contouring
+// with signs from the coarse winding pass away from the surface matches a dense
+// grid of exact winding numbers. With --bench, compares batched throughput of
+// the two sign modes on random points and in buildGrid's scan order, and
+// buildGrid with near-surface against dense exact winding numbers.
+static void testWindingNumber(bool bench) {
+    std::cout << "Test 14: Winding-number sign on a holed teapot\n";
+    const std::string holedPath = "test_mesh_sdf_holed.obj";
+    {
+        std::ifstream in(DATA_DIR "/teapot.obj");
+        std::ofstream out(holedPath);
+        std::string line;
+        int face = 0;
+        while (std::getline(in, line)) {
+            // Vertices are all kept, so the normalisation matches the intact mesh
+            if (line.rfind("f ", 0) == 0 && face++ % 20 == 0) continue;
+            out << line << "\n";
+        }
+    }
+    std::shared_ptr<MeshSDF> intact = MeshSDF::load(DATA_DIR "/teapot.obj", MeshSign::WindingNumber);
+    std::shared_ptr<MeshSDF> holed = MeshSDF::load(holedPath, MeshSign::WindingNumber);
+    std::shared_ptr<MeshSDF> holedPseudo = MeshSDF::load(holedPath);
+    std::remove(holedPath.c_str());
+    if (!intact || !holed || !holedPseudo) {
+        check("teapots load", false);
+        return;
+    }
+    check("sign modes reported", holed->sign() == MeshSign::WindingNumber &&
+                                 holedPseudo->sign() == MeshSign::Pseudonormal);
+    check("winding number needs the dipole tree", holedPseudo->windingNumber(0.f, 0.f, 0.f) == -1.0);
+    check("winding number ~1 inside", std::abs(intact->windingNumber(0.f, 0.f, 0.f) - 1.0) < 0.05);
+    check("winding number ~0 outside", std::abs(intact->windingNumber(0.f, 0.95f, 0.f)) < 0.05);
+
+    // The dipole tree against the exact sum of solid angles; only w = 0.5 matters
+    // for the sign, so a few hundredths is plenty
+    const DCMesh surface = holed->surface();
+    double worst = 0.0, total = 0.0;
+    for (int i = 0; i < 20; ++i) {
+        const Eigen::Vector3d q(-0.8 + 0.08 * i, 0.3 - 0.03 * i, 0.05 * (i % 7) - 0.15);
+        double exact = 0.0;
+        for (const auto& t : surface.triangles) {
+            Eigen::Vector3d a, b, c;
+            for (int k = 0; k < 3; ++k) {
+                a[k] = surface.vertices[t[0]][k] - q[k];
+                b[k] = surface.vertices[t[1]][k] - q[k];
+                c[k] = surface.vertices[t[2]][k] - q[k];
+            }
+            const double la = a.norm(), lb = b.norm(), lc = c.norm();
+            exact += std::atan2(a.dot(b.cross(c)), la * lb * lc + a.dot(b) * lc + a.dot(c) * lb + b.dot(c) * la);
+        }
+        exact /= 2.0 * 3.14159265358979323846;
+        const double error = std::abs(holed->windingNumber(float(q[0]), float(q[1]), float(q[2])) - exact);
+        worst = std::max(worst, error);
+        total += error;
+    }
+    std::cout << "  dipole-tree error: mean " << total / 20 << ", largest " << worst << "\n";
+    check("dipole tree within 0.02 of the exact winding number on average", total / 20 < 0.02);
+    check("dipole tree within 0.05 everywhere", worst < 0.05);
+
+    // Corner signs away from the surface, against the intact mesh
+    const int N = 40;
+    const float cellSize = 2.0f / N;
+    int corners = 0, windingAgrees = 0, pseudoAgrees = 0, same = 0;
+    std::vector<float> xs(N + 1), ys(N + 1), zs(N + 1), batch(N + 1);
+    for (int i = 0; i <= N; ++i) xs[i] = -1.f + i * cellSize;
+    for (int k = 0; k <= N; ++k)
+        for (int j = 0; j <= N; ++j) {
+            std::fill(ys.begin(), ys.end(), -1.f + j * cellSize);
+            std::fill(zs.begin(), zs.end(), -1.f + k * cellSize);
+            holed->distanceBatch(xs.data(), ys.data(), zs.data(), batch.data(), N + 1);
+            for (int i = 0; i <= N; ++i) {
+                const float reference = intact->distance(xs[i], ys[i], zs[i]);
+                const float d = holed->distance(xs[i], ys[i], zs[i]);
+                if (sameDistance(batch[i], d)) ++same;
+                if (std::abs(reference) < cellSize) continue;
+                ++corners;
+                if ((d < 0) == (reference < 0)) ++windingAgrees;
+                if ((holedPseudo->distance(xs[i], ys[i], zs[i]) < 0) == (reference < 0)) ++pseudoAgrees;
+            }
+        }
+    std::cout << "  signs matching the intact teapot: winding number " << windingAgrees << ", pseudonormal "
+              << pseudoAgrees << " of " << corners << "\n";
+    check("batched distances equal distance()", same == (N + 1) * (N + 1) * (N + 1));
+    check("winding-number signs survive the holes (>= 99.5%)", windingAgrees >= corners * 995 / 1000);
+    check("winding number beats the pseudonormal", windingAgrees > pseudoAgrees);
+
+    // Without its lid the teapot has one hole about 0.8 wide, whose w = 0.5
+    // surface bulges far from any face: batched signs must still be exact
+    const std::string lidlessPath = "test_mesh_sdf_lidless.obj";
+    {
+        std::ifstream in(DATA_DIR "/teapot.obj");
+        std::vector<std::string> lines;
+        std::vector<std::array<double, 2>> xy;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.rfind("v ", 0) == 0) {
+                std::istringstream v(line.substr(2));
+                double x = 0, y = 0;
+                v >> x >> y;
+                xy.push_back({x, y});
+            }
+            lines.push_back(line);
+        }
+        std::ofstream out(lidlessPath);
+        for (const std::string& l : lines) {
+            if (l.rfind("f ", 0) == 0) {
+                // The lid: faces entirely above the rim (y = 2.25), away from the spout
+                std::istringstream f(l.substr(2));
+                std::string corner;
+                bool lid = true;
+                while (f >> corner) {
+                    const auto& v = xy[std::stoi(corner) - 1];
+                    lid = lid && v[1] > 2.25 && std::abs(v[0]) < 1.6;
+                }
+                if (lid) continue;
+            }
+            out << l << "\n";
+        }
+    }
+    std::shared_ptr<MeshSDF> lidless = MeshSDF::load(lidlessPath, MeshSign::WindingNumber);
+    std::remove(lidlessPath.c_str());
+    check("lidless teapot loads", lidless && lidless->numTriangles() < intact->numTriangles() - 1000);
+    if (lidless) {
+        int lidSame = 0, lidCorners = 0;
+        for (int k = 0; k <= N; ++k)
+            for (int j = 0; j <= N; ++j) {
+                std::fill(ys.begin(), ys.end(), -1.f + j * cellSize);
+                std::fill(zs.begin(), zs.end(), -1.f + k * cellSize);
+                lidless->distanceBatch(xs.data(), ys.data(), zs.data(), batch.data(), N + 1);
+                for (int i = 0; i <= N; ++i) {
+                    ++lidCorners;
+                    if (sameDistance(batch[i], lidless->distance(xs[i], ys[i], zs[i]))) ++lidSame;
+                }
+            }
+        check("lidless batched distances equal distance()", lidSame == lidCorners);
+    }
+
+    // Near-surface winding numbers against exact ones at every corner: the
+    // lattice interpolant only moves the caps across holes by a fraction of
+    // a cell, so the two meshes agree
+    auto exactWinding = [](const std::shared_ptr<MeshSDF>& mesh) {
+        return [mesh](float x, float y, float z) {
+            const float d = std::abs(mesh->distance(x, y, z));
+            return mesh->windingNumber(x, y, z) >= 0.5 ? -d : d;
+        };
+    };
+    auto volume = [](const DCMesh& m) {
+        double v = 0.0;
+        for (const auto& t : m.triangles) {
+            const Eigen::Vector3d a(m.vertices[t[0]][0], m.vertices[t[0]][1], m.vertices[t[0]][2]);
+            const Eigen::Vector3d b(m.vertices[t[1]][0], m.vertices[t[1]][1], m.vertices[t[1]][2]);
+            const Eigen::Vector3d c(m.vertices[t[2]][0], m.vertices[t[2]][1], m.vertices[t[2]][2]);
+            v += a.dot(b.cross(c)) / 6.0;
+        }
+        return v;
+    };
+    for (const std::shared_ptr<MeshSDF>& mesh : {holed, lidless}) {
+        if (!mesh) continue;
+        const ImplicitField nearSurface = meshSDFField(mesh);
+        DCGrid fast = buildGrid(nearSurface, 64);
+        DCGrid dense = buildGrid(exactWinding(mesh), 64);
+        size_t flipped = 0;
+        for (size_t c = 0; c < fast.values.size(); ++c) flipped += (fast.values[c] < 0) != (dense.values[c] < 0);
+        const DCMesh a = dualContour(nearSurface, fast), b = dualContour(exactWinding(mesh), dense);
+        const double va = volume(a), vb = volume(b);
+        const char* name = mesh == holed ? "holed" : "lidless";
+        std::cout << "  " << name << " N=64: " << flipped << " corner signs differ, triangles " << a.triangles.size()
+                  << " vs " << b.triangles.size() << ", volume " << va << " vs " << vb << "\n";
+        check(mesh == holed ? "holed: near-surface signs match dense (>= 99.8%)"
+                            : "lidless: near-surface signs match dense (>= 99.8%)",
+              flipped * 500 <= fast.values.size());
+        check(mesh == holed ? "holed: same mesh within 1% of volume and 2% of triangles"
+                            : "lidless: same mesh within 1% of volume and 2% of triangles",
+              std::abs(va - vb) <= 0.01 * std::abs(vb) &&
+              std::abs(double(a.triangles.size()) - double(b.triangles.size())) <= 0.02 * b.triangles.size());
+    }
+
+    if (!bench) return;
+    using Clock = std::chrono::steady_clock;
+    const int count = 1 << 20;
+    std::vector<float> px(count), py(count), pz(count), out(count);
+    uint32_t state = 7;
+    auto next = [&]() {
+        state = state * 1664525u + 1013904223u;
+        return -1.f + 2.f * (state >> 8) / float(1u << 24);
+    };
+    for (int i = 0; i < count; ++i) {
+        px[i] = next();
+        py[i] = next();
+        pz[i] = next();
+    }
+    for (const MeshSDF* mesh : {holedPseudo.get(), holed.get()}) {
+        auto t0 = Clock::now();
+        mesh->distanceBatch(px.data(), py.data(), pz.data(), out.data(), count);
+        double s = std::chrono::duration<double>(Clock::now() - t0).count();
+        std::cout << "  " << (mesh == holed.get() ? "winding number" : "pseudonormal  ") << ": "
+                  << count / s / 1e6 << " M points/s\n";
+    }
+    for (const std::shared_ptr<MeshSDF>& mesh : {holedPseudo, holed}) {
+        auto t0 = Clock::now();
+        buildGrid(meshSDFField(mesh), 128);
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        std::cout << "  N=128 buildGrid, " << (mesh == holed ? "winding number" : "pseudonormal") << ": "
+                  << ms << " ms\n";
+    }
+    auto t0 = Clock::now();
+    buildGrid(exactWinding(holed), 128);
+    std::cout << "  N=128 buildGrid, exact winding number at every corner: "
+              << std::chrono::duration<double, std::milli>(Clock::now() - t0).count() << " ms\n";
+}
+
+int main(int argc, char** argv) {
+    const bool bench = argc > 1 && std::strcmp(argv[1], "--bench") == 0;
+
     // --- Test 1: Load ---
     std::cout << "Test 1: Load teapot OBJ\n";
     std::string path = DATA_DIR "/teapot.obj";
@@ -97,6 +891,16 @@ int main() {
             }
     check("all SDF values finite", allFinite);
 
+    testParallelTeapot(bench);
+    testBatchQuery(bench);
+    testHierarchicalMeshSDF(bench);
+    testCachedVolumes();
+    testInstances();
+    testBinaryCache(bench);
+    testCombinedQuery(bench);
+    testCoherentQuery(bench);
+    testWindingNumber(bench);
+
     std::cout << "\nResults: " << g_pass << " passed, " << g_fail << " failed\n";
     return g_fail > 0 ? 1 : 0;
 }
@@ -0,0 +1,258 @@
+#include "dual_contour.h"
+#include "implicit.h"
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <cassert>
+
+static int g_pass = 0, g_fail = 0;
+
+static void check(const char* name, bool cond) {
+    if (cond) {
+        std::cout << "  PASS: " << name << "\n";
+        ++g_pass;
+    } else {
+        std::cout << "  FAIL: " << name << "\n";
+        ++g_fail;
+    }
+}
+
+struct Shape { const char* name; ScalarField f; };
+static const Shape g_shapes[] = {
+    {"sphere", implicitSphere}, {"box", implicitBox}, {"torus", implicitTorus}
+};
+
+// Rotate a triangle so its smallest index comes first (keeps the winding)
+static std::array<int,3> canonical(std::array<int,3> t) {
+    while (t[0] > t[1] || t[0] > t[2]) t = {t[1], t[2], t[0]};
+    return t;
+}
+
+static std::vector<std::array<int,3>> sortedTriangles(const std::vector<std::array<int,3>>& tris) {
+    std::vector<std::array<int,3>> out;
+    for (const auto& t : tris) out.push_back(canonical(t));
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+static Eigen::Vector3f toVec(const std::array<float,3>& v) {
+    return Eigen::Vector3f(v[0], v[1], v[2]);
+}
+
+static float pointTriangleDistance(const Eigen::Vector3f& p, const Eigen::Vector3f& a,
+                                   const Eigen::Vector3f& b, const Eigen::Vector3f& c) {
+    // Closest point on triangle (Ericson, Real-Time Collision Detection 5.1.5)
+    const Eigen::Vector3f ab = b - a, ac = c - a, ap = p - a;
+    const float d1 = ab.dot(ap), d2 = ac.dot(ap);
+    if (d1 <= 0 && d2 <= 0) return (p - a).norm();
+    const Eigen::Vector3f bp = p - b;
+    const float d3 = ab.dot(bp), d4 = ac.dot(bp);
+    if (d3 >= 0 && d4 <= d3) return (p - b).norm();
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) return (p - (a + ab * (d1 / (d1 - d3)))).norm();
+    const Eigen::Vector3f cp = p - c;
+    const float d5 = ab.dot(cp), d6 = ac.dot(cp);
+    if (d6 >= 0 && d5 <= d6) return (p - c).norm();
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) return (p - (a + ac * (d2 / (d2 - d6)))).norm();
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+        return (p - (b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))))).norm();
+    const float denom = 1.0f / (va + vb + vc);
+    return (p - (a + ab * (vb * denom) + ac * (vc * denom))).norm();
+}
+
+// Two-sided Hausdorff distance between the mesh and the zero set of an exact
+// SDF: mesh -> surface from |f| at points spread over every triangle, and
+// surface -> mesh from the grid's edge crossings to the nearest triangle.
+static float hausdorff(const DCMesh& mesh, const DCGrid& grid, ScalarField f) {
+    float meshToSurface = 0.0f;
+    for (const auto& t : mesh.triangles) {
+        const Eigen::Vector3f a = toVec(mesh.vertices[t[0]]);
+        const Eigen::Vector3f b = toVec(mesh.vertices[t[1]]);
+        const Eigen::Vector3f c = toVec(mesh.vertices[t[2]]);
+        for (int u = 0; u <= 4; ++u)
+            for (int v = 0; u + v <= 4; ++v) {
+                const Eigen::Vector3f p = a + (b - a) * (u / 4.0f) + (c - a) * (v / 4.0f);
+                meshToSurface = std::max(meshToSurface, std::abs(f(p.x(), p.y(), p.z())));
+            }
+    }
+
+    // Bucket triangles by the grid cells their bounding boxes overlap
+    const int M = 16;
+    const float span = grid.maxBound - grid.minBound;
+    auto bucketOf = [&](float x) {
+        return std::min(M - 1, std::max(0, int((x - grid.minBound) / span * M)));
+    };
+    std::vector<std::vector<int>> buckets(M * M * M);
+    for (size_t t = 0; t < mesh.triangles.size(); ++t) {
+        Eigen::Vector3f lo = toVec(mesh.vertices[mesh.triangles[t][0]]), hi = lo;
+        for (int c = 1; c < 3; ++c) {
+            lo = lo.cwiseMin(toVec(mesh.vertices[mesh.triangles[t][c]]));
+            hi = hi.cwiseMax(toVec(mesh.vertices[mesh.triangles[t][c]]));
+        }
+        for (int k = bucketOf(lo.z()); k <= bucketOf(hi.z()); ++k)
+            for (int j = bucketOf(lo.y()); j <= bucketOf(hi.y()); ++j)
+                for (int i = bucketOf(lo.x()); i <= bucketOf(hi.x()); ++i)
+                    buckets[i + M * (j + M * k)].push_back(static_cast<int>(t));
+    }
+
+    float surfaceToMesh = 0.0f;
+    for (int axis = 0; axis < 3; ++axis) {
+        for (const HermiteEdge& e : grid.edges.edges[axis]) {
+            const Eigen::Vector3f& p = e.hermite.point;
+            // Search the surrounding buckets; crossings are within a cell of the mesh
+            float best = 1e30f;
+            for (int k = bucketOf(p.z()) - 1; k <= bucketOf(p.z()) + 1; ++k)
+                for (int j = bucketOf(p.y()) - 1; j <= bucketOf(p.y()) + 1; ++j)
+                    for (int i = bucketOf(p.x()) - 1; i <= bucketOf(p.x()) + 1; ++i) {
+                        if (i < 0 || j < 0 || k < 0 || i >= M || j >= M || k >= M) continue;
+                        for (int t : buckets[i + M * (j + M * k)]) {
+                            const auto& tri = mesh.triangles[t];
+                            best = std::min(best, pointTriangleDistance(
+                                p, toVec(mesh.vertices[tri[0]]), toVec(mesh.vertices[tri[1]]),
+                                toVec(mesh.vertices[tri[2]])));
+                        }
+                    }
+            surfaceToMesh = std::max(surfaceToMesh, best);
+        }
+    }
+    return std::max(meshToSurface, surfaceToMesh);
+}
+
+// ---- Test 1: A negative tolerance reproduces the uniform mesh --------------
+static void testUniformEquivalence(int N) {
+    std::cout << "Test 1: No simplification matches dualContour, N=" << N << "\n";
+    for (const auto& shape : g_shapes) {
+        DCGrid uniformGrid = buildGrid(shape.f, N);
+        DCMesh uniform = dualContour(shape.f, uniformGrid);
+        DCGrid grid = buildGrid(shape.f, N);
+        DCMesh adaptive = dualContourAdaptive(shape.f, grid, -1.0f);
+
+        // Translate adaptive vertex ids to uniform ones through the active cells
+        std::vector<int> toUniform(adaptive.vertices.size(), -1);
+        bool samePositions = adaptive.vertices.size() == uniform.vertices.size();
+        for (size_t c = 0; c < grid.vertexIndex.size() && samePositions; ++c) {
+            const int a = grid.vertexIndex[c], u = uniformGrid.vertexIndex[c];
+            if ((a < 0) != (u < 0)) samePositions = false;
+            if (a < 0 || u < 0) continue;
+            toUniform[a] = u;
+            samePositions = adaptive.vertices[a] == uniform.vertices[u];
+        }
+        check((std::string(shape.name) + " identical vertices").c_str(), samePositions);
+
+        std::vector<std::array<int,3>> mapped;
+        for (const auto& t : adaptive.triangles) {
+            mapped.push_back({toUniform[t[0]], toUniform[t[1]], toUniform[t[2]]});
+        }
+        check((std::string(shape.name) + " identical triangles").c_str(),
+              samePositions && sortedTriangles(mapped) == sortedTriangles(uniform.triangles));
+    }
+}
+
+// ---- Test 2: Recursion emits exactly one polygon per minimal edge ----------
+// Reference: every sign-changing fine edge, with its four cells replaced by the
+// leaves that cover them, gives the polygon of the minimal edge it lies on.
+static void testMinimalEdges(int N, float tolerance) {
+    std::cout << "Test 2: Cell/face/edge recursion vs. fine edges, N=" << N
+              << " tolerance=" << tolerance << "\n";
+    for (const auto& shape : g_shapes) {
+        DCGrid grid = buildGrid(shape.f, N);
+        DCMesh mesh = dualContourAdaptive(shape.f, grid, tolerance);
+
+        DCMesh reference;
+        reference.vertices = mesh.vertices;
+        std::map<std::array<int,4>, int> seen;
+        bool duplicates = false;
+        for (int axis = 0; axis < 3; ++axis) {
+            for (const HermiteEdge& e : grid.edges.edges[axis]) {
+                int v[4];
+                bool complete = true;
+                for (int q = 0; q < 4; ++q) {
+                    const int ci = e.i + QUAD_CELLS[axis][q][0];
+                    const int cj = e.j + QUAD_CELLS[axis][q][1];
+                    const int ck = e.k + QUAD_CELLS[axis][q][2];
+                    if (ci < 0 || cj < 0 || ck < 0 || ci >= N || cj >= N || ck >= N) {
+                        complete = false;
+                        break;
+                    }
+                    v[q] = grid.vertexIndex[ci + N * cj + N * N * ck];
+                }
+                if (!complete) continue;
+                // Polygons that collapse to fewer than 3 leaves are not emitted
+                std::array<int,4> key = {v[0], v[1], v[2], v[3]};
+                std::sort(key.begin(), key.end());
+                const int distinct = static_cast<int>(std::unique(key.begin(), key.end()) - key.begin());
+                if (distinct >= 3 && seen[{v[0], v[1], v[2], v[3]}]++ > 0) duplicates = true;
+                appendPolygon(v, axis, e.rising, reference.triangles);
+            }
+        }
+        removeDegenerateTriangles(reference);
+
+        check((std::string(shape.name) + " each minimal edge crossed once").c_str(), !duplicates);
+        check((std::string(shape.name) + " triangles match fine-edge reference").c_str(),
+              sortedTriangles(mesh.triangles) == sortedTriangles(reference.triangles));
+    }
+}
+
+// ---- Test 3: Simplified meshes stay closed and consistently oriented -------
+static void testWatertight(int N, float tolerance) {
+    std::cout << "Test 3: Closed simplified meshes, N=" << N << " tolerance=" << tolerance << "\n";
+    for (const auto& shape : g_shapes) {
+        DCGrid grid = buildGrid(shape.f, N);
+        DCMesh mesh = dualContourAdaptive(shape.f, grid, tolerance);
+
+        // Every directed edge appears once and its reverse once
+        std::map<std::pair<int,int>, int> directed;
+        for (const auto& t : mesh.triangles) {
+            for (int c = 0; c < 3; ++c) ++directed[{t[c], t[(c + 1) % 3]}];
+        }
+        bool closed = !mesh.triangles.empty();
+        for (const auto& d : directed) {
+            const auto rev = directed.find({d.first.second, d.first.first});
+            if (d.second != 1 || rev == directed.end() || rev->second != 1) closed = false;
+        }
+        check((std::string(shape.name) + " closed and consistently oriented").c_str(), closed);
+    }
+}
+
+// ---- Test 4: Fewer triangles for similar error -----------------------------
+static void testReduction(int N, float tolerance) {
+    std::cout << "Test 4: Size and Hausdorff error, N=" << N << " tolerance=" << tolerance << "\n";
+    for (const auto& shape : g_shapes) {
+        DCGrid uniformGrid = buildGrid(shape.f, N);
+        DCMesh uniform = dualContour(shape.f, uniformGrid);
+        DCGrid grid = buildGrid(shape.f, N);
+        DCMesh adaptive = dualContourAdaptive(shape.f, grid, tolerance);
+
+        const float uniformError = hausdorff(uniform, uniformGrid, shape.f);
+        const float adaptiveError = hausdorff(adaptive, grid, shape.f);
+        std::cout << "  " << shape.name << ": " << uniform.triangles.size() << " -> "
+                  << adaptive.triangles.size() << " triangles, Hausdorff "
+                  << uniformError << " -> " << adaptiveError
+                  << " (cell size " << grid.cellSize << ")\n";
+        check((std::string(shape.name) + " fewer triangles").c_str(),
+              adaptive.triangles.size() < uniform.triangles.size());
+        check((std::string(shape.name) + " error within half a cell").c_str(),
+              adaptiveError < 0.5f * grid.cellSize);
+    }
+}
+
+int main() {
+    testUniformEquivalence(32);
+    testUniformEquivalence(45);
+    testMinimalEdges(32, 1e-3f);
+    testMinimalEdges(45, 1e-3f);
+    testMinimalEdges(64, 1e-2f);
+    testWatertight(64, 1e-3f);
+    testReduction(64, 1e-3f);
+
+    std::cout << "\nResults: " << g_pass << " passed, " << g_fail << " failed\n";
+    return g_fail > 0 ? 1 : 0;
+}
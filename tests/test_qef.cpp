@@ -1,6 +1,10 @@
 #include "qef.h"
+#include <Eigen/SVD>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <iostream>
+#include <random>
 #include <cassert>
 
 static int g_pass = 0, g_fail = 0;
@@ -109,6 +113,155 @@ static void testClamping() {
     check("z clamped to hi.z", std::abs(v.z() - 0.6f) < 1e-4f);
 }
 
+// Reference: the original per-cell dynamic JacobiSVD solve, kept here to check
+// that the fixed-size accumulator places vertices the same way.
+static Eigen::Vector3f referenceSolveQEF(const std::vector<HermiteSample>& samples,
+                                         const Eigen::Vector3f& cellMin,
+                                         const Eigen::Vector3f& cellMax,
+                                         float svdThreshold = 1e-3f) {
+    if (samples.empty()) {
+        return ((cellMin + cellMax) * 0.5f).cwiseMax(cellMin).cwiseMin(cellMax);
+    }
+    Eigen::Vector3d massPoint = Eigen::Vector3d::Zero();
+    for (const auto& sample : samples) massPoint += sample.point.cast<double>();
+    massPoint /= static_cast<double>(samples.size());
+
+    const int sampleCount = static_cast<int>(samples.size());
+    Eigen::MatrixXd A(sampleCount, 3);
+    Eigen::VectorXd b(sampleCount);
+    for (int i = 0; i < sampleCount; ++i) {
+        const Eigen::Vector3d p = samples[i].point.cast<double>() - massPoint;
+        Eigen::Vector3d normal = samples[i].normal.cast<double>();
+        const double nNorm = normal.norm();
+        normal = nNorm > 1e-12 ? Eigen::Vector3d(normal / nNorm) : Eigen::Vector3d::UnitX();
+        A.row(i) = normal.transpose();
+        b(i) = normal.dot(p);
+    }
+    Eigen::JacobiSVD<Eigen::MatrixXd> svd(A, Eigen::ComputeThinU | Eigen::ComputeThinV);
+    const auto& svals = svd.singularValues();
+    const double maxSV = svals.size() > 0 ? svals(0) : 1.0;
+    svd.setThreshold(static_cast<double>(svdThreshold) * std::max(1.0, maxSV));
+    Eigen::Vector3d x = svd.solve(b) + massPoint;
+    if (!x.allFinite()) x = massPoint;
+
+    Eigen::Vector3f xf = x.cast<float>();
+    const bool inside = (xf.array() >= cellMin.array()).all() &&
+                        (xf.array() <= cellMax.array()).all();
+    if (!inside) xf = massPoint.cast<float>().cwiseMax(cellMin).cwiseMin(cellMax);
+    return xf;
+}
+
+// Random cells in the style dualContour produces: a few planes (or one curved
+// patch) crossing a small cell, sampled at up to 12 edge points.
+static std::vector<HermiteSample> randomCellSamples(std::mt19937& rng,
+                                                    const Eigen::Vector3f& lo, float size) {
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    std::uniform_int_distribution<int> planeCount(1, 3), sampleCount(1, 12);
+    std::vector<Eigen::Vector3f> planeP, planeN;
+    const int np = planeCount(rng);
+    for (int i = 0; i < np; ++i) {
+        planeP.push_back(lo + size * Eigen::Vector3f(u(rng), u(rng), u(rng)));
+        planeN.push_back(Eigen::Vector3f(u(rng) - 0.5f, u(rng) - 0.5f, u(rng) - 0.5f).normalized());
+    }
+    std::vector<HermiteSample> samples;
+    const int ns = sampleCount(rng);
+    for (int i = 0; i < ns; ++i) {
+        const int pl = i % np;
+        // Point on plane pl near the cell, plus a little normal noise
+        Eigen::Vector3f q = lo + size * Eigen::Vector3f(u(rng), u(rng), u(rng));
+        q -= planeN[pl] * planeN[pl].dot(q - planeP[pl]);
+        Eigen::Vector3f n = planeN[pl] + 0.05f * Eigen::Vector3f(u(rng) - 0.5f, u(rng) - 0.5f, u(rng) - 0.5f);
+        samples.push_back({q, n});
+    }
+    return samples;
+}
+
+// ---- Test 7: Accumulator matches the dynamic-SVD reference ----------------
+static void testEquivalence() {
+    std::cout << "Test 7: QEF accumulator vs. dynamic JacobiSVD reference\n";
+    std::mt19937 rng(1234);
+    const float size = 1.0f / 64.0f;
+    int mismatches = 0;
+    float maxDiff = 0.0f;
+    const int trials = 20000;
+    for (int t = 0; t < trials; ++t) {
+        Eigen::Vector3f lo(-0.5f + (t % 17) * size, 0.25f - (t % 5) * size, (t % 11) * size);
+        Eigen::Vector3f hi = lo + Eigen::Vector3f::Constant(size);
+        auto samples = randomCellSamples(rng, lo, size);
+        Eigen::Vector3f ref = referenceSolveQEF(samples, lo, hi);
+        Eigen::Vector3f v = solveQEF(samples, lo, hi);
+        float d = (v - ref).norm();
+        maxDiff = std::max(maxDiff, d);
+        if (d > 1e-3f * size) ++mismatches;
+    }
+    std::cout << "  max |new - reference| = " << maxDiff << " over " << trials << " cells\n";
+    check("vertex placement matches reference within 1e-3 cell", mismatches == 0);
+
+    // The explicit cases above, including the out-of-cell fallback
+    Eigen::Vector3f lo(0.4f,0.4f,0.4f), hi(0.6f,0.6f,0.6f);
+    std::vector<HermiteSample> outside;
+    for (float x : {0.45f, 0.55f})
+        for (float y : {0.45f, 0.55f})
+            outside.push_back({{x, y, 0.9f}, {0,0,1}});
+    check("out-of-cell fallback matches reference",
+          (solveQEF(outside, lo, hi) - referenceSolveQEF(outside, lo, hi)).norm() < 1e-6f);
+}
+
+// ---- Test 8: Merging QEFs equals accumulating all samples -----------------
+static void testMerge() {
+    std::cout << "Test 8: QEF merge\n";
+    std::mt19937 rng(99);
+    Eigen::Vector3f lo(0,0,0), hi(1,1,1);
+    auto a = randomCellSamples(rng, lo, 1.0f);
+    auto b = randomCellSamples(rng, lo, 1.0f);
+
+    QEF qa, qb, all;
+    for (const auto& s : a) { qa.add(s); all.add(s); }
+    for (const auto& s : b) { qb.add(s); all.add(s); }
+    qa.merge(qb);
+
+    check("merged count", qa.count == all.count);
+    check("merged solve matches", (qa.solve(lo, hi) - all.solve(lo, hi)).norm() < 1e-5f);
+    Eigen::Vector3f x = qa.solve(lo, hi);
+    check("merged error matches", std::abs(qa.error(x) - all.error(x)) < 1e-9);
+
+    // error() is the sum of squared plane distances
+    double direct = 0.0;
+    for (const auto* set : {&a, &b})
+        for (const auto& s : *set) {
+            double d = s.normal.normalized().cast<double>().dot((x - s.point).cast<double>());
+            direct += d * d;
+        }
+    check("error() equals sum of squared plane distances", std::abs(qa.error(x) - direct) < 1e-6);
+}
+
+// ---- Benchmark: solves per second ----------------------------------------
+static void benchSolves() {
+    std::cout << "Benchmark: QEF solves per second\n";
+    std::mt19937 rng(7);
+    Eigen::Vector3f lo(0,0,0), hi(1,1,1);
+    std::vector<std::vector<HermiteSample>> cells;
+    for (int i = 0; i < 20000; ++i) cells.push_back(randomCellSamples(rng, lo, 1.0f));
+
+    using Clock = std::chrono::steady_clock;
+    float sink = 0.0f;
+    auto t0 = Clock::now();
+    for (const auto& c : cells) sink += referenceSolveQEF(c, lo, hi).x();
+    double refSec = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    t0 = Clock::now();
+    for (const auto& c : cells) {
+        QEF qef;
+        for (const auto& s : c) qef.add(s);
+        sink += qef.solve(lo, hi).x();
+    }
+    double newSec = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    std::cout << "  dynamic JacobiSVD: " << cells.size() / refSec << " solves/s\n"
+              << "  QEF accumulator:   " << cells.size() / newSec << " solves/s  ("
+              << refSec / newSec << "x)  [" << sink << "]\n";
+}
+
 int main() {
     testEmpty();
     testSinglePlane();
@@ -116,6 +269,9 @@ int main() {
     testCornerFeature();
     testDegenerate();
     testClamping();
+    testEquivalence();
+    testMerge();
+    benchSolves();
 
     std::cout << "\nResults: " << g_pass << " passed, " << g_fail << " failed\n";
     return g_fail > 0 ? 1 : 0;
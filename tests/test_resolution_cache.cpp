@@ -0,0 +1,156 @@
+#include "resolution_cache.h"
+#include "dual_contour.h"
+#include "implicit.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+static int g_pass = 0, g_fail = 0;
+
+static void check(const char* name, bool cond) {
+    if (cond) {
+        std::cout << "  PASS: " << name << "\n";
+        ++g_pass;
+    } else {
+        std::cout << "  FAIL: " << name << "\n";
+        ++g_fail;
+    }
+}
+
+// Torus that counts its evaluations
+static ImplicitField countingTorus(std::shared_ptr<std::atomic<long long>> count) {
+    ImplicitField f;
+    f.eval = [count](float x, float y, float z) {
+        ++*count;
+        return implicitTorus(x, y, z);
+    };
+    return f;
+}
+
+static long long corners(int N) {
+    return static_cast<long long>(N + 1) * (N + 1) * (N + 1);
+}
+
+// ---- Test 1: Dyadic refinement -----------------------------------------------------
+static void testRefinement() {
+    std::cout << "Test 1: N -> 2N samples only the new corners\n";
+    auto count = std::make_shared<std::atomic<long long>>(0);
+    const ImplicitField f = countingTorus(count);
+    ResolutionCache cache;
+
+    bool identical = true;
+    for (int N : {16, 32, 64}) {
+        *count = 0;
+        DCGrid grid = cache.grid("torus", f, N);
+        const long long expected = N == 16 ? corners(16) : corners(N) - corners(N / 2);
+        std::cout << "  N=" << N << ": " << count->load() << " evaluations\n";
+        identical = identical && grid.values == buildGrid(implicitTorus, N).values && *count == expected;
+    }
+    check("refined grids match buildGrid, new corners only", identical);
+
+    *count = 0;
+    DCGrid coarse = cache.grid("torus", f, 32);
+    check("coarser resolution is read from the lattice", *count == 0 &&
+                                                        coarse.values == buildGrid(implicitTorus, 32).values);
+
+    // Other families and domains keep their own lattices
+    *count = 0;
+    DCGrid odd = cache.grid("torus", f, 24);
+    check("N=24 does not reuse the power-of-two lattice", *count == corners(24));
+    *count = 0;
+    DCGrid odd2 = cache.grid("torus", f, 48);
+    check("N=48 reuses N=24", *count == corners(48) - corners(24) &&
+                              odd2.values == buildGrid(implicitTorus, 48).values);
+    *count = 0;
+    DCGrid shifted = cache.grid("torus", f, 32, -1.5f, 1.5f);
+    check("another domain is sampled afresh", *count == corners(32) &&
+                                              shifted.values == buildGrid(implicitTorus, 32, -1.5f, 1.5f).values);
+
+    const ResolutionCacheStats stats = cache.stats();
+    std::cout << "  reuse " << stats.cornerReuseRate() * 100 << "%, " << stats.latticeBytes / 1024
+              << " KiB of lattices\n";
+    check("reused corners counted", stats.reusedCorners == corners(16) + 2 * corners(32) + corners(24));
+    check("lattice memory reported", stats.latticeBytes >= (corners(64) + corners(48) + corners(32)) * sizeof(float));
+}
+
+// ---- Test 2: Mesh LRU ---------------------------------------------------------------
+static void testMeshes() {
+    std::cout << "Test 2: Revisited resolutions come from the mesh LRU\n";
+    auto count = std::make_shared<std::atomic<long long>>(0);
+    const ImplicitField f = countingTorus(count);
+    ResolutionCache cache(2);
+
+    auto a = cache.mesh("torus", f, 32);
+    DCGrid grid = buildGrid(f, 32);
+    DCMesh direct = dualContour(f, grid);
+    check("mesh matches dualContour", a->vertices == direct.vertices && a->triangles == direct.triangles);
+
+    *count = 0;
+    auto again = cache.mesh("torus", f, 32);
+    check("hit returns the cached mesh without sampling", again == a && *count == 0);
+    check("another key misses", cache.mesh("sphere", implicitSphere, 32) != a);
+
+    cache.mesh("torus", f, 64);  // evicts torus/32 (sphere/32 is newer)
+    const long long sampled = cache.stats().sampledCorners;
+    auto rebuilt = cache.mesh("torus", f, 32);
+    check("evicted mesh is rebuilt from the lattice", rebuilt != a && cache.stats().sampledCorners == sampled &&
+                                                      rebuilt->triangles == direct.triangles);
+
+    const ResolutionCacheStats stats = cache.stats();
+    std::cout << "  " << stats.meshHits << " hits, " << stats.meshMisses << " misses, "
+              << stats.meshBytes / 1024 << " KiB of meshes\n";
+    check("hit rate", stats.meshHits == 1 && stats.meshMisses == 4 && stats.meshHitRate() == 0.2);
+    check("mesh memory reported", stats.meshBytes > 0);
+
+    cache.clear();
+    const ResolutionCacheStats cleared = cache.stats();
+    check("clear drops everything", cleared.latticeBytes == 0 && cleared.meshBytes == 0 &&
+                                    cleared.meshHits == 0 && cleared.sampledCorners == 0);
+}
+
+// ---- Test 3: Slider sweep -----------------------------------------------------------
+static void testSweep(bool bench) {
+    std::cout << "Test 3: Resolution sweep up and back down\n";
+    const int top = bench ? 256 : 128;
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point t0) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    };
+
+    auto t0 = Clock::now();
+    for (int N = 16; N <= top; N *= 2) {
+        DCGrid grid = buildGrid(implicitTorus, N);
+        dualContour(implicitTorus, grid);
+    }
+    for (int N = top / 2; N >= 16; N /= 2) {
+        DCGrid grid = buildGrid(implicitTorus, N);
+        dualContour(implicitTorus, grid);
+    }
+    const double plainMs = ms(t0);
+
+    ResolutionCache cache;
+    t0 = Clock::now();
+    for (int N = 16; N <= top; N *= 2) cache.mesh("torus", implicitTorus, N);
+    for (int N = top / 2; N >= 16; N /= 2) cache.mesh("torus", implicitTorus, N);
+    const double cachedMs = ms(t0);
+
+    const ResolutionCacheStats stats = cache.stats();
+    std::cout << "  16..." << top << "...16: " << plainMs << " ms rebuilding, " << cachedMs << " ms cached ("
+              << stats.meshHitRate() * 100 << "% mesh hits, " << stats.cornerReuseRate() * 100
+              << "% corners reused)\n";
+    check("every corner sampled once", stats.sampledCorners == corners(top));
+    check("way down is all hits", stats.meshMisses == stats.meshHits + 1);
+}
+
+int main(int argc, char** argv) {
+    const bool bench = argc > 1 && std::strcmp(argv[1], "--bench") == 0;
+
+    testRefinement();
+    testMeshes();
+    testSweep(bench);
+
+    std::cout << "\nResults: " << g_pass << " passed, " << g_fail << " failed\n";
+    return g_fail > 0 ? 1 : 0;
+}
@@ -0,0 +1,219 @@
+#include "sdf_volume.h"
+#include "dual_contour.h"
+#include "implicit.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static int g_pass = 0, g_fail = 0;
+
+static void check(const char* name, bool cond) {
+    if (cond) {
+        std::cout << "  PASS: " << name << "\n";
+        ++g_pass;
+    } else {
+        std::cout << "  FAIL: " << name << "\n";
+        ++g_fail;
+    }
+}
+
+static const uint64_t SPHERE_HASH = 0x5a5a1234u;
+
+// Largest |volume - sphere| over pseudo-random points within distance `near`
+// of the surface
+template <class Sample>
+static float maxError(Sample sample, float near) {
+    float worst = 0.0f;
+    uint32_t state = 12345;
+    auto next = [&]() {
+        state = state * 1664525u + 1013904223u;
+        return -1.f + 2.f * (state >> 8) / float(1u << 24);
+    };
+    for (int n = 0; n < 20000; ++n) {
+        const float x = next(), y = next(), z = next();
+        const float exact = implicitSphere(x, y, z);
+        if (std::abs(exact) > near) continue;
+        worst = std::max(worst, std::abs(sample(x, y, z) - exact));
+    }
+    return worst;
+}
+
+// ---- Test 1: Bake and sample a float volume --------------------------------
+static void testFloatVolume() {
+    std::cout << "Test 1: Float volume of the sphere, resolution 128\n";
+    const std::string path = "test_sdf_volume_sphere.sdfv";
+    SDFBakeOptions options;
+    check("bake succeeded", bakeSDFVolume(implicitSphere, SPHERE_HASH, path, options));
+
+    SDFVolume volume;
+    check("volume opens", volume.open(path, SPHERE_HASH));
+    std::cout << "  " << volume.storedBricks() << " of " << volume.totalBricks() << " bricks stored, "
+              << volume.fileBytes() << " bytes\n";
+    check("only narrow-band bricks stored", volume.storedBricks() < volume.totalBricks() / 2);
+    check("smaller than a dense float grid", volume.fileBytes() < size_t(129) * 129 * 129 * sizeof(float));
+
+    // Lattice points reproduce the samples
+    const float cellSize = 2.0f / 128;
+    float latticeError = 0.0f;
+    for (int k = 0; k <= 128; k += 3)
+        for (int j = 0; j <= 128; j += 5)
+            for (int i = 0; i <= 128; ++i) {
+                const float x = -1.f + i * cellSize, y = -1.f + j * cellSize, z = -1.f + k * cellSize;
+                const float exact = implicitSphere(x, y, z);
+                if (std::abs(exact) > 2.0f * cellSize) continue;
+                latticeError = std::max(latticeError, std::abs(volume.sample(x, y, z) - exact));
+            }
+    check("trilinear matches the lattice samples", latticeError < 1e-5f);
+
+    const float linear = maxError([&](float x, float y, float z) { return volume.sample(x, y, z); },
+                                  2.0f * cellSize);
+    const float cubic = maxError([&](float x, float y, float z) { return volume.sampleCubic(x, y, z); },
+                                 2.0f * cellSize);
+    std::cout << "  max error near the surface: trilinear " << linear << ", tricubic " << cubic << "\n";
+    check("trilinear error well below a cell", linear < 0.02f * cellSize);
+    check("tricubic error well below a cell", cubic < 0.02f * cellSize);
+    check("outside the band the far value keeps the sign",
+          volume.sample(0.f, 0.f, 0.f) < 0.f && volume.sample(0.99f, 0.99f, 0.99f) > 0.f);
+    check("outside the lattice the distance keeps growing",
+          volume.sample(3.f, 0.f, 0.f) > volume.sample(1.f, 0.f, 0.f));
+
+    // Contouring the volume reproduces the sphere
+    ImplicitField field;
+    field.eval = [&](float x, float y, float z) { return volume.sample(x, y, z); };
+    DCGrid grid = buildGrid(field, 128);
+    DCMesh mesh = dualContour(field, grid);
+    DCGrid exactGrid = buildGrid(implicitSphere, 128);
+    DCMesh exactMesh = dualContour(implicitSphere, exactGrid);
+    float vertexError = 0.0f;
+    for (const auto& v : mesh.vertices) {
+        vertexError = std::max(vertexError, std::abs(implicitSphere(v[0], v[1], v[2])));
+    }
+    check("same active cells as the exact field", mesh.vertices.size() == exactMesh.vertices.size());
+    check("vertices on the sphere", vertexError < 0.1f * cellSize);
+
+    volume.close();
+    std::remove(path.c_str());
+}
+
+// ---- Test 2: Quantized bricks ----------------------------------------------
+static void testQuantized() {
+    std::cout << "Test 2: Quantized volume\n";
+    const std::string floatPath = "test_sdf_volume_f.sdfv", quantPath = "test_sdf_volume_q.sdfv";
+    SDFBakeOptions options;
+    bakeSDFVolume(implicitSphere, SPHERE_HASH, floatPath, options);
+    options.quantize = true;
+    bakeSDFVolume(implicitSphere, SPHERE_HASH, quantPath, options);
+
+    SDFVolume full, quantized;
+    check("both volumes open", full.open(floatPath, SPHERE_HASH) && quantized.open(quantPath, SPHERE_HASH));
+    check("quantized file about half the size", quantized.fileBytes() < full.fileBytes() * 6 / 10);
+    const float band = options.bandCells * 2.0f / 128;
+    const float error = maxError([&](float x, float y, float z) { return quantized.sample(x, y, z); },
+                                 band);
+    const float floatError = maxError([&](float x, float y, float z) { return full.sample(x, y, z); },
+                                      band);
+    std::cout << "  max error within the band: quantized " << error << ", float " << floatError << "\n";
+    check("quantization adds at most one step", error < floatError + 2.0f * band / 32767.0f);
+
+    full.close();
+    quantized.close();
+    std::remove(floatPath.c_str());
+    std::remove(quantPath.c_str());
+}
+
+// ---- Test 3: Stale, missing and damaged files are rejected -----------------
+static void testValidation() {
+    std::cout << "Test 3: Cache validation\n";
+    const std::string path = "test_sdf_volume_v.sdfv";
+    SDFBakeOptions options;
+    options.resolution = 32;
+    bakeSDFVolume(implicitTorus, SPHERE_HASH, path, options);
+
+    SDFVolume volume;
+    check("matching hash opens", volume.open(path, SPHERE_HASH));
+    check("baked options recorded", volume.matches(options));
+    SDFBakeOptions other = options;
+    other.resolution = 64;
+    bool differ = !volume.matches(other);
+    other = options;
+    other.bandCells = 2.0f;
+    differ = differ && !volume.matches(other);
+    other = options;
+    other.quantize = true;
+    differ = differ && !volume.matches(other);
+    other = options;
+    other.maxBound = 2.0f;
+    check("other options do not match", differ && !volume.matches(other));
+    const size_t stored = volume.storedBricks(), total = volume.totalBricks();
+    check("different hash is stale", !volume.open(path, SPHERE_HASH + 1) && !volume.isOpen());
+    check("missing file fails", !volume.open("no_such_volume.sdfv", SPHERE_HASH));
+
+    std::vector<char> bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    // A slot past the stored bricks, in the table in front of them
+    {
+        const size_t brickBytes = size_t(9) * 9 * 9 * sizeof(float);
+        const size_t table = bytes.size() - stored * brickBytes - total * sizeof(int32_t);
+        std::vector<char> damaged = bytes;
+        const int32_t slot = static_cast<int32_t>(stored);
+        std::memcpy(&damaged[table + 5 * sizeof(int32_t)], &slot, sizeof(slot));
+        std::ofstream out(path, std::ios::binary);
+        out.write(damaged.data(), damaged.size());
+    }
+    check("out-of-range brick slot fails", !volume.open(path, SPHERE_HASH));
+    // Truncate the bricks
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(bytes.data(), bytes.size() - 100);
+    }
+    check("truncated file fails", !volume.open(path, SPHERE_HASH));
+    std::remove(path.c_str());
+
+    // Content hashes
+    const std::string a = "test_sdf_volume_a.txt", b = "test_sdf_volume_b.txt";
+    std::ofstream(a) << "v 0 0 0\n";
+    std::ofstream(b) << "v 0 0 1\n";
+    check("different contents hash differently", hashFileContents(a) != hashFileContents(b));
+    check("same contents hash alike", hashFileContents(a) == hashFileContents(a));
+    check("unreadable file hashes to 0", hashFileContents("no_such_file.obj") == 0);
+    std::remove(a.c_str());
+    std::remove(b.c_str());
+
+#ifndef _WIN32
+    // Cache directory
+    const char* xdg = std::getenv("XDG_CACHE_HOME");
+    const std::string savedXdg = xdg ? xdg : "";
+    setenv("XDG_CACHE_HOME", "test_sdf_volume_cache", 1);
+    check("cache directory under XDG_CACHE_HOME", userCacheDirectory() == "test_sdf_volume_cache/dualcontour");
+    unsetenv("XDG_CACHE_HOME");
+    const char* home = std::getenv("HOME");
+    check("else under ~/.cache", !home || userCacheDirectory() == std::string(home) + "/.cache/dualcontour");
+    if (xdg) setenv("XDG_CACHE_HOME", savedXdg.c_str(), 1);
+    check("missing parents created", createDirectories("test_sdf_volume_cache/dualcontour") &&
+                                     createDirectories("test_sdf_volume_cache/dualcontour"));
+    std::ofstream("test_sdf_volume_cache/file") << "x";
+    check("a file is not a directory", !createDirectories("test_sdf_volume_cache/file"));
+    std::remove("test_sdf_volume_cache/file");
+    std::remove("test_sdf_volume_cache/dualcontour");
+    std::remove("test_sdf_volume_cache");
+#endif
+}
+
+int main() {
+    testFloatVolume();
+    testQuantized();
+    testValidation();
+
+    std::cout << "\nResults: " << g_pass << " passed, " << g_fail << " failed\n";
+    return g_fail > 0 ? 1 : 0;
+}
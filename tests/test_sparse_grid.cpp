@@ -0,0 +1,130 @@
+#include "sparse_grid.h"
+#include "dual_contour.h"
+#include "implicit.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/resource.h>
+
+static int g_pass = 0, g_fail = 0;
+
+static void check(const char* name, bool cond) {
+    if (cond) {
+        std::cout << "  PASS: " << name << "\n";
+        ++g_pass;
+    } else {
+        std::cout << "  FAIL: " << name << "\n";
+        ++g_fail;
+    }
+}
+
+struct Shape { const char* name; ScalarField f; };
+static const Shape g_shapes[] = {
+    {"sphere", implicitSphere}, {"box", implicitBox}, {"torus", implicitTorus}
+};
+
+// High-water mark of the process's resident memory, in bytes. It covers every
+// transient buffer (per-task gathers, edge lists) that memoryBytes() misses.
+static double peakResidentBytes() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return double(usage.ru_maxrss);           // bytes
+#else
+    return double(usage.ru_maxrss) * 1024.0;  // kilobytes
+#endif
+}
+
+// ---- Test 1: Sparse samples agree with the dense grid ---------------------
+static void testValues(int N) {
+    std::cout << "Test 1: Sparse corner values, N=" << N << "\n";
+    for (const auto& shape : g_shapes) {
+        DCGrid dense = buildGrid(shape.f, N);
+        SparseDCGrid sparse = buildSparseGrid(shape.f, N);
+
+        int signMismatch = 0, valueMismatch = 0;
+        for (int k = 0; k <= N; ++k)
+            for (int j = 0; j <= N; ++j)
+                for (int i = 0; i <= N; ++i) {
+                    const float d = dense.values[i + (N+1)*j + (N+1)*(N+1)*k];
+                    const float s = sparse.value(i, j, k);
+                    if ((d < 0) != (s < 0)) ++signMismatch;
+                    // Allocated bricks must hold the exact samples
+                    const int nb = sparse.bricksPerAxis;
+                    const int b = std::min(i / SparseDCGrid::BRICK, nb - 1) +
+                                  nb * (std::min(j / SparseDCGrid::BRICK, nb - 1) +
+                                        nb * std::min(k / SparseDCGrid::BRICK, nb - 1));
+                    if (sparse.brickSlot[b] >= 0 && s != d) ++valueMismatch;
+                }
+        std::cout << "  " << shape.name << ": " << sparse.allocatedBricks() << " of "
+                  << sparse.brickSlot.size() << " bricks allocated\n";
+        check((std::string(shape.name) + " corner signs match dense").c_str(), signMismatch == 0);
+        check((std::string(shape.name) + " allocated samples match dense").c_str(), valueMismatch == 0);
+        check((std::string(shape.name) + " skips some bricks").c_str(),
+              sparse.allocatedBricks() < static_cast<int>(sparse.brickSlot.size()));
+    }
+}
+
+// ---- Test 2: Sparse contouring reproduces the dense mesh ------------------
+static void testMeshEquivalence(int N) {
+    std::cout << "Test 2: Sparse vs. dense mesh, N=" << N << "\n";
+    for (const auto& shape : g_shapes) {
+        DCGrid dense = buildGrid(shape.f, N);
+        DCMesh denseMesh = dualContour(shape.f, dense);
+        SparseDCGrid sparse = buildSparseGrid(shape.f, N);
+        DCMesh sparseMesh = dualContour(shape.f, sparse);
+
+        check((std::string(shape.name) + " identical vertices").c_str(),
+              sparseMesh.vertices == denseMesh.vertices);
+        check((std::string(shape.name) + " identical triangles").c_str(),
+              sparseMesh.triangles == denseMesh.triangles);
+    }
+}
+
+// ---- Test 3: High resolution in bounded memory ----------------------------
+static void testHighResolution(int N) {
+    std::cout << "Test 3: Sphere at N=" << N << "\n";
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+    SparseDCGrid grid = buildSparseGrid(implicitSphere, N);
+    double sampleMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    t0 = Clock::now();
+    DCMesh mesh = dualContour(implicitSphere, grid);
+    double contourMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+    const double mb = 1024.0 * 1024.0;
+    // A DCGrid holds one float per corner and one vertex index per cell
+    const double denseMB = (double(N+1)*(N+1)*(N+1) * sizeof(float) + double(N)*N*N * sizeof(int)) / mb;
+    const double meshMB = (mesh.vertices.size() * sizeof(mesh.vertices[0]) +
+                           mesh.triangles.size() * sizeof(mesh.triangles[0])) / mb;
+    std::cout << "  bricks: " << grid.allocatedBricks() << " of " << grid.brickSlot.size()
+              << "\n  sampling " << sampleMs << " ms, contouring " << contourMs << " ms"
+              << "\n  vertices: " << mesh.vertices.size() << "  triangles: " << mesh.triangles.size()
+              << "\n  sparse grid: " << grid.memoryBytes() / mb << " MB, mesh: " << meshMB
+              << " MB (dense grid would need ~" << denseMB << " MB)"
+              << "\n  peak resident memory: " << peakResidentBytes() / mb << " MB\n";
+
+    check("non-empty mesh", !mesh.vertices.empty() && !mesh.triangles.empty());
+    // The whole process peak, so it also bounds the build's transient buffers
+    check("peak memory of grid + mesh build under 1 GB", peakResidentBytes() / mb < 1024.0);
+
+    // Every vertex should sit close to the sphere surface
+    float maxDev = 0.0f;
+    for (const auto& v : mesh.vertices) {
+        maxDev = std::max(maxDev, std::abs(implicitSphere(v[0], v[1], v[2])));
+    }
+    check("vertices within one cell of the surface", maxDev < grid.cellSize);
+}
+
+int main() {
+    testValues(45);
+    testMeshEquivalence(32);
+    testMeshEquivalence(45);
+    testMeshEquivalence(64);
+    testHighResolution(1024);
+
+    std::cout << "\nResults: " << g_pass << " passed, " << g_fail << " failed\n";
+    return g_fail > 0 ? 1 : 0;
+}
@@ -0,0 +1,151 @@
+#include "streaming.h"
+#include "mesh_io.h"
+#include "dual_contour.h"
+#include "implicit.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cassert>
+
+static int g_pass = 0, g_fail = 0;
+
+static void check(const char* name, bool cond) {
+    if (cond) {
+        std::cout << "  PASS: " << name << "\n";
+        ++g_pass;
+    } else {
+        std::cout << "  FAIL: " << name << "\n";
+        ++g_fail;
+    }
+}
+
+struct Shape { const char* name; ScalarField f; };
+static const Shape g_shapes[] = {
+    {"sphere", implicitSphere}, {"box", implicitBox}, {"torus", implicitTorus}
+};
+
+static std::vector<std::array<int,3>> sortedTriangles(std::vector<std::array<int,3>> tris) {
+    std::sort(tris.begin(), tris.end());
+    return tris;
+}
+
+// Collect a streamed mesh back into memory
+static DCMesh streamToMesh(ScalarField f, int N, int numThreads) {
+    DCMesh mesh;
+    DCMeshSink sink;
+    sink.vertices = [&](const std::vector<std::array<float,3>>& v) {
+        mesh.vertices.insert(mesh.vertices.end(), v.begin(), v.end());
+    };
+    sink.triangles = [&](const std::vector<std::array<int,3>>& t) {
+        // Every index must refer to a vertex that has already arrived
+        for (const auto& tri : t)
+            for (int c = 0; c < 3; ++c)
+                assert(tri[c] >= 0 && tri[c] < static_cast<int>(mesh.vertices.size()));
+        mesh.triangles.insert(mesh.triangles.end(), t.begin(), t.end());
+    };
+    streamDualContour(f, N, sink, -1.f, 1.f, numThreads);
+    return mesh;
+}
+
+// ---- Test 1: Streaming matches the in-memory path -------------------------
+static void testEquivalence(int N) {
+    std::cout << "Test 1: Streamed vs. in-memory mesh, N=" << N << "\n";
+    for (const auto& shape : g_shapes) {
+        DCGrid grid = buildGrid(shape.f, N);
+        DCMesh reference = dualContour(shape.f, grid);
+        for (int threads : {1, 4}) {
+            DCMesh mesh = streamToMesh(shape.f, N, threads);
+            const std::string label = std::string(shape.name) + (threads == 1 ? " serial" : " 4 threads");
+            check((label + " identical vertices").c_str(), mesh.vertices == reference.vertices);
+            check((label + " same triangles").c_str(),
+                  sortedTriangles(mesh.triangles) == sortedTriangles(reference.triangles));
+        }
+    }
+}
+
+// ---- Test 2: Binary PLY round trip ----------------------------------------
+static void testPLY(int N) {
+    std::cout << "Test 2: Streaming to a binary PLY, N=" << N << "\n";
+    const std::string path = "test_streaming_torus.ply";
+    {
+        PLYStreamWriter writer(path);
+        check("writer opened", writer.isOpen());
+        streamDualContour(implicitTorus, N, writer.sink());
+        check("finish succeeded", writer.finish());
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    std::string line;
+    size_t numVertices = 0, numFaces = 0;
+    while (std::getline(in, line) && line != "end_header") {
+        std::istringstream tokens(line);
+        std::string word, element;
+        size_t count = 0;
+        if (tokens >> word >> element >> count && word == "element") {
+            (element == "vertex" ? numVertices : numFaces) = count;
+        }
+    }
+
+    DCGrid grid = buildGrid(implicitTorus, N);
+    DCMesh reference = dualContour(implicitTorus, grid);
+    check("vertex count in header", numVertices == reference.vertices.size());
+    check("face count in header", numFaces == reference.triangles.size());
+
+    DCMesh mesh;
+    mesh.vertices.resize(numVertices);
+    in.read(reinterpret_cast<char*>(mesh.vertices.data()), numVertices * sizeof(mesh.vertices[0]));
+    bool wellFormed = bool(in);
+    for (size_t t = 0; t < numFaces && wellFormed; ++t) {
+        unsigned char count = 0;
+        std::array<int,3> tri;
+        in.read(reinterpret_cast<char*>(&count), 1);
+        in.read(reinterpret_cast<char*>(tri.data()), sizeof(tri));
+        wellFormed = in && count == 3;
+        mesh.triangles.push_back(tri);
+    }
+    wellFormed = wellFormed && in.peek() == std::char_traits<char>::eof();
+    check("file is well formed", wellFormed);
+    check("PLY vertices match", mesh.vertices == reference.vertices);
+    check("PLY triangles match",
+          sortedTriangles(mesh.triangles) == sortedTriangles(reference.triangles));
+    in.close();
+    std::remove(path.c_str());
+}
+
+// ---- Test 3: Working set grows as N^2 -------------------------------------
+static void testBoundedMemory() {
+    std::cout << "Test 3: Working set\n";
+    using Clock = std::chrono::steady_clock;
+    DCMeshSink counter;  // discard the output
+    size_t peak128 = 0;
+    for (int N : {128, 256}) {
+        auto t0 = Clock::now();
+        DCStreamStats stats = streamDualContour(implicitSphere, N, counter);
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        const double mb = 1024.0 * 1024.0;
+        const double denseMB = double(N+1) * (N+1) * (N+1) * sizeof(float) / mb;
+        std::cout << "  N=" << N << ": " << stats.vertices << " vertices, " << stats.triangles
+                  << " triangles in " << ms << " ms; working set " << stats.peakBytes / mb
+                  << " MB (grid values alone would be " << denseMB << " MB)\n";
+        if (N == 128) peak128 = stats.peakBytes;
+        else check("doubling N roughly quadruples the working set",
+                   stats.peakBytes < 6 * peak128);
+    }
+}
+
+int main() {
+    testEquivalence(32);
+    testEquivalence(45);
+    testEquivalence(64);
+    testPLY(48);
+    testBoundedMemory();
+
+    std::cout << "\nResults: " << g_pass << " passed, " << g_fail << " failed\n";
+    return g_fail > 0 ? 1 : 0;
+}